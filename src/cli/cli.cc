@@ -335,11 +335,20 @@ void CLInterface::LoadGraphFromFile() {
   // filename.trim();
   try {
     s21_graph new_graph;
-    new_graph.LoadFromFile(filename);
+    if (filename.ends_with(".edges")) {
+      new_graph.LoadFromEdgeList(filename);
+    } else {
+      new_graph.LoadFromFile(filename);
+    }
     graph_ = std::move(new_graph);
     is_graph_loaded_ = true;
     PrintInput("Graph loaded successfully");
-    graph_.PrintGraph();
+    const LoadStats& stats = graph_.GetLoadStats();
+    std::cout << "Parsed " << stats.bytes << " bytes in " << std::fixed
+              << std::setprecision(2) << stats.milliseconds << " ms ("
+              << stats.MegabytesPerSecond() << " MB/s)" << std::defaultfloat
+              << std::endl;
+    PrintLoadedGraph();
 
     std::string dot_filename = filename + ".dot";
     graph_.ExportToDot(dot_filename);
@@ -349,6 +358,22 @@ void CLInterface::LoadGraphFromFile() {
   }
 }
 
+void CLInterface::PrintLoadedGraph() const {
+  if (graph_.Size() <= kMaxPrintedVertices) {
+    graph_.PrintGraph();
+    return;
+  }
+  // the matrix of a large graph takes V^2 lookups and lines to print
+  GraphLayout layout = graph_.GetLayout();
+  std::string layout_name = "dense";
+  if (layout == GraphLayout::kSparse) layout_name = "sparse";
+  if (layout == GraphLayout::kBitPacked) layout_name = "bit-packed";
+  if (layout == GraphLayout::kCompressed) layout_name = "compressed";
+  std::cout << "Vertices: " << graph_.Size()
+            << ", edges: " << graph_.GetMetadata().edge_count
+            << ", layout: " << layout_name << std::endl;
+}
+
 void CLInterface::PrintMenu() const {
   PrintInformation(
       "\n<<< SIMPLE NAVIGATOR MENU: >>>\n1. Load graph from file\n2. "
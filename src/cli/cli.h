@@ -18,6 +18,9 @@ class CLInterface {
   const std::string COLOR_GREEN = "\033[32m";
   const std::string COLOR_YELLOW = "\033[33m";
 
+  /// Larger graphs are summarized instead of printed, whatever the layout.
+  static constexpr int kMaxPrintedVertices = 30;
+
   void SalesmanProblemAnalysis();
   void SalesmanProblem();
   void MinimumSpanningTree();
@@ -26,6 +29,7 @@ class CLInterface {
   void DFS();
   void BFS();
   void LoadGraphFromFile();
+  void PrintLoadedGraph() const;
   void PrintMenu() const;
   bool CheckGraph() const;
   bool ValidateVertex(int vertex) const;
@@ -1,41 +1,188 @@
 #include "graph.h"
 
-void s21_graph::LoadFromFile(std::string& filename) {
-  // loading a graph from a file in the adjacency matrix format.
-  std::ifstream file(filename);
-  if (!file.is_open()) {
-    throw std::logic_error("Failed to open the file!");
-  }
-  std::string line;
-  while (std::getline(file, line)) {
-    std::istringstream iss(line);
-    std::vector<int> row;
-    std::string cell;
-    while (std::getline(iss, cell, ' ')) {
-      if (cell.empty()) {
-        continue;
+#include <limits>
+#include <numeric>
+
+#include "../utils/parallel.h"
+
+namespace {
+
+/**
+ * @brief Scrambles the bits of x (the splitmix64 finalizer), so that sums of
+ * mixed values rarely collide.
+ */
+std::uint64_t MixBits(std::uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * @brief Splits [begin, end) into about count slices that end on line
+ * breaks.
+ * @return The slice boundaries, from begin to end.
+ */
+std::vector<const char*> SplitAtLines(const char* begin, const char* end,
+                                      std::size_t count) {
+  std::vector<const char*> bounds{begin};
+  std::size_t step = (end - begin) / count;
+  for (std::size_t i = 1; i < count; ++i) {
+    const char* cut = std::max(begin + i * step, bounds.back());
+    const void* line_end = std::memchr(cut, '\n', end - cut);
+    if (line_end == nullptr) break;
+    cut = static_cast<const char*>(line_end) + 1;
+    if (cut > bounds.back() && cut < end) bounds.push_back(cut);
+  }
+  bounds.push_back(end);
+  return bounds;
+}
+
+/**
+ * @brief Counts the pairs {i, j} of a matrix with m(i, j) != m(j, i).
+ *
+ * The upper triangle is compared with the lower one in square tiles, so the
+ * column reads of a tile stay in cache. Rows of tiles run in parallel.
+ */
+std::size_t CountAsymmetricPairs(const GraphData& matrix) {
+  constexpr int kTile = 64;
+  const int size = matrix.Size();
+  const int tiles = (size + kTile - 1) / kTile;
+  std::vector<std::size_t> counts(tiles, 0);
+  s21::ParallelFor(tiles, [&](std::size_t tile) {
+    const int row_begin = static_cast<int>(tile) * kTile;
+    const int row_end = std::min(size, row_begin + kTile);
+    std::size_t count = 0;
+    for (int col_begin = row_begin; col_begin < size; col_begin += kTile) {
+      const int col_end = std::min(size, col_begin + kTile);
+      for (int i = row_begin; i < row_end; ++i) {
+        const int* row = matrix.Row(i);
+        for (int j = std::max(col_begin, i + 1); j < col_end; ++j) {
+          count += row[j] != matrix(j, i);
+        }
       }
-      int value = std::stoi(cell);
-      if (value < 0) {
-        throw std::logic_error("Edge weight cannot be negative!");
+    }
+    counts[tile] = count;
+  });
+  return std::accumulate(counts.begin(), counts.end(), std::size_t{0});
+}
+
+/**
+ * @brief Counts the pairs {i, j} of a CSR graph with w(i, j) != w(j, i).
+ *
+ * Every row is merged with the same row of the transposed graph, which holds
+ * the reverse edges sorted by id, so the count takes O(V + E) instead of a
+ * binary search per edge.
+ */
+template <typename T>
+std::size_t CountAsymmetricPairs(const s21::CsrGraph<T>& csr) {
+  const s21::CsrGraph<T> reverse = csr.Transpose();
+  std::size_t count = 0;
+  for (int i = 0; i < csr.Size(); ++i) {
+    std::span<const int> ids = csr.Neighbors(i);
+    std::span<const T> weights = csr.Weights(i);
+    std::span<const int> reverse_ids = reverse.Neighbors(i);
+    std::span<const T> reverse_weights = reverse.Weights(i);
+    std::size_t r = 0;
+    for (std::size_t e = 0; e < ids.size(); ++e) {
+      const int j = ids[e];
+      while (r < reverse_ids.size() && reverse_ids[r] < j) ++r;
+      T back{};
+      if (r < reverse_ids.size() && reverse_ids[r] == j) {
+        back = reverse_weights[r];
       }
-      row.push_back(value);
+      // every asymmetric pair has an edge on at least one side; pairs with
+      // edges on both sides are seen twice and counted from the lower id
+      if (back != weights[e] && (back == T{} || i < j)) ++count;
     }
-    graph_.push_back(row);
   }
-  file.close();
+  return count;
+}
+
+}  // namespace
 
-  if (graph_.empty()) {
+void s21_graph::LoadFromFile(std::string& filename) {
+  // loading a graph from a file in the adjacency matrix format.
+  auto start = std::chrono::steady_clock::now();
+  s21::MappedFile file(filename, true);
+  const char* end = file.Data() + file.Size();
+  s21::MatrixTextParser header(file.Data(), end);
+
+  if (!header.NextRow()) {
     throw std::logic_error("The file is empty or contains only empty lines!");
   }
+  // the first row defines the size of the matrix
+  const int size = header.CountColumns();
 
-  if (graph_.size() != graph_[0].size()) {
+  // every slice is parsed by its own thread into rows assigned up front,
+  // which requires counting the rows of all slices first
+  std::size_t slices = std::min<std::size_t>(
+      s21::WorkerCount() * 4, file.Size() / kParseSliceBytes + 1);
+  std::vector<const char*> bounds =
+      SplitAtLines(header.Position(), end, slices);
+  slices = bounds.size() - 1;
+  std::vector<int> first_row(slices + 1, 0);
+  s21::ParallelFor(slices, [&](std::size_t i) {
+    first_row[i + 1] =
+        s21::MatrixTextParser(bounds[i], bounds[i + 1]).CountRows();
+  });
+  std::partial_sum(first_row.begin(), first_row.end(), first_row.begin());
+  if (first_row[slices] != size) {
     throw std::logic_error("The graph is not a square matrix!");
   }
+  // allocated only once the rows match, so a long first row fails the check
+  // above instead of reserving its square
+  GraphData matrix(size);
+
+  // every slice collects the metadata of its rows while they are hot
+  std::vector<s21::MetadataBuilder> metadata(slices,
+                                             s21::MetadataBuilder(size));
+  s21::ParallelFor(slices, [&](std::size_t i) {
+    s21::MatrixTextParser parser(bounds[i], bounds[i + 1], first_row[i]);
+    while (parser.NextRow()) {
+      const int row_index = parser.RowIndex();
+      int* row = matrix.Row(row_index);
+      parser.ParseRow(row, size);
+      metadata[i].AddRow(row_index, row, size);
+    }
+  });
+  for (std::size_t i = 1; i < slices; ++i) {
+    metadata[0].Merge(metadata[i]);
+  }
+  // symmetry compares rows of different slices, so it needs all of them
+  metadata[0].AddAsymmetricPairs(CountAsymmetricPairs(matrix));
 
+  graph_ = std::move(matrix);
+  metadata_ = metadata[0].Build();
+  directed_declared_ = false;
   ParseType();
+
+  GraphLayout layout = GraphLayout::kDense;
+  if (metadata_.density < kSparseDensity) {
+    layout = GraphLayout::kSparse;
+  } else if (!metadata_.IsWeighted()) {
+    layout = GraphLayout::kBitPacked;
+  }
+  SetLayout(layout);
+  FitWeights(metadata_.max_weight);
+  OrderLoadedGraph();
+
+  version_ = NextVersion();
+  load_stats_.bytes = file.Size();
+  load_stats_.milliseconds =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+}
+
+double LoadStats::MegabytesPerSecond() const {
+  if (milliseconds <= 0) return 0;
+  return bytes / (1024.0 * 1024.0) / (milliseconds / 1000.0);
 }
 
+const LoadStats& s21_graph::GetLoadStats() const { return load_stats_; }
+
+const s21::GraphMetadata& s21_graph::GetMetadata() const { return metadata_; }
+
 void s21_graph::ExportToDot(std::string& filename) {
   //  exporting a graph to a dot file (see materials)
   std::ofstream file(filename);
@@ -55,60 +202,311 @@ void s21_graph::ExportToDot(std::string& filename) {
 
   int size = Size();
   for (int i = 0; i < size; ++i) {
-    // For undirected graphs, only iterate j from i to avoid duplicate edges
-    // (like 1--2 and 2--1)
-    for (int j = (is_directed ? 0 : i); j < size; ++j) {
-      // Check if an edge exists
-      if (graph_[i][j] > 0) {
-        // Write the edge connection (e.g., "1 -> 2" or "1 -- 2")
-        file << "  " << (i + 1) << edge_connector << (j + 1);
-        // Add weight label if the graph is weighted
-        if (is_weighted) {
-          file << " [label=\"" << graph_[i][j] << "\"]";
-        }
-        file << ";" << std::endl;
+    ForEachNeighbor(i, [&](int j, int weight) {
+      // For undirected graphs, only take j >= i to avoid duplicate edges
+      // (like 1--2 and 2--1)
+      if (!is_directed && j < i) return;
+      // Write the edge connection (e.g., "1 -> 2" or "1 -- 2")
+      file << "  " << (i + 1) << edge_connector << (j + 1);
+      // Add weight label if the graph is weighted
+      if (is_weighted) {
+        file << " [label=\"" << weight << "\"]";
       }
-    }
+      file << ";" << std::endl;
+    });
   }
 
   file << "}" << std::endl;
   file.close();
 }
 
-int s21_graph::Size() const { return graph_.size(); }
+int s21_graph::Size() const {
+  return std::visit([](const auto& data) { return data.Size(); }, graph_);
+}
 
 void s21_graph::ParseType() {
-  bool is_weighted = false;
-  bool is_directed = false;
+  graph_type_ = TypeOf(metadata_, directed_declared_);
+}
 
-  for (const auto& row : graph_) {
-    for (const auto& cell : row) {
-      if (cell > 1) {
-        is_weighted = true;
-      }
-    }
+GraphType s21_graph::TypeOf(const s21::GraphMetadata& metadata,
+                            bool directed_declared) {
+  bool is_weighted = metadata.IsWeighted();
+  bool is_directed = directed_declared || !metadata.IsSymmetric();
+
+  if (is_weighted && is_directed) return GraphType::kWeigtedDirected;
+  if (is_weighted) return GraphType::kWeightedUndirected;
+  if (is_directed) return GraphType::kUnweightedDirected;
+  return GraphType::kUnweightedUndirected;
+}
+
+void s21_graph::ComputeMetadata() {
+  const int size = Size();
+  s21::MetadataBuilder builder(size);
+  for (int i = 0; i < size; ++i) {
+    ForEachStoredNeighbor(
+        i, [&](int j, int weight) { builder.AddEdge(i, j, weight); });
   }
+  std::size_t asymmetric_pairs = std::visit(
+      [this, size](const auto& data) -> std::size_t {
+        if constexpr (s21::kIsCsrGraph<std::decay_t<decltype(data)>>) {
+          return CountAsymmetricPairs(data);
+        } else {
+          // matrices look an edge up in O(1); compressed rows are decoded
+          // up to the id
+          std::size_t count = 0;
+          for (int i = 0; i < size; ++i) {
+            ForEachStoredNeighbor(i, [&](int j, int weight) {
+              int reverse = Weight(j, i);
+              if (reverse != weight && (reverse == 0 || i < j)) ++count;
+            });
+          }
+          return count;
+        }
+      },
+      graph_);
+  builder.AddAsymmetricPairs(asymmetric_pairs);
+  metadata_ = builder.Build();
+}
 
-  for (size_t i = 0; i < graph_.size(); ++i) {
-    for (size_t j = 0; j < graph_[i].size(); ++j) {
-      if (graph_[i][j] != graph_[j][i]) {
-        is_directed = true;
-      }
+GraphType s21_graph::GetType() const { return graph_type_; }
+
+void s21_graph::SetVertexOrder(VertexOrder order) {
+  vertex_order_ = order;
+  Reorder();
+  version_ = NextVersion();
+}
+
+VertexOrder s21_graph::GetVertexOrder() const { return vertex_order_; }
+
+int s21_graph::StorageId(int vertex) const {
+  return new_id_.empty() ? vertex : new_id_[vertex];
+}
+
+int s21_graph::OriginalId(int storage_id) const {
+  return old_id_.empty() ? storage_id : old_id_[storage_id];
+}
+
+void s21_graph::OrderLoadedGraph() {
+  old_id_.clear();
+  new_id_.clear();
+  if (vertex_order_ != VertexOrder::kOriginal) Reorder();
+}
+
+void s21_graph::Reorder() {
+  std::vector<int> order;  // storage id placed at every position
+  if (vertex_order_ == VertexOrder::kOriginal) {
+    if (old_id_.empty()) return;
+    order = new_id_;
+  } else {
+    SparseGraphData csr = ToCsr();
+    if (vertex_order_ == VertexOrder::kBreadthFirst) {
+      order = s21::BreadthFirstOrder(csr);
+    } else if (vertex_order_ == VertexOrder::kReverseCuthillMcKee) {
+      order = s21::ReverseCuthillMcKeeOrder(csr);
+    } else {
+      order = s21::DegreeOrder(csr);
     }
   }
+  Relabel(order);
 
-  if (is_weighted && is_directed) {
-    graph_type_ = GraphType::kWeigtedDirected;
-  } else if (is_weighted) {
-    graph_type_ = GraphType::kWeightedUndirected;
-  } else if (is_directed) {
-    graph_type_ = GraphType::kUnweightedDirected;
-  } else {
-    graph_type_ = GraphType::kUnweightedUndirected;
+  const int size = Size();
+  std::vector<int> old_id(size);
+  bool identity = true;
+  for (int k = 0; k < size; ++k) {
+    old_id[k] = OriginalId(order[k]);
+    identity &= old_id[k] == k;
+  }
+  if (identity) {
+    old_id_.clear();
+    new_id_.clear();
+    return;
   }
+  old_id_ = std::move(old_id);
+  new_id_.assign(size, 0);
+  for (int k = 0; k < size; ++k) new_id_[old_id_[k]] = k;
 }
 
-GraphType s21_graph::GetType() const { return graph_type_; }
+void s21_graph::Relabel(const std::vector<int>& order) {
+  const int size = Size();
+  std::vector<int> position(size);
+  for (int k = 0; k < size; ++k) position[order[k]] = k;
+  std::vector<SparseGraphData::Edge> edges;
+  edges.reserve(metadata_.edge_count);
+  for (int v = 0; v < size; ++v) {
+    ForEachStoredNeighbor(v, [&](int u, int weight) {
+      edges.push_back({position[v], position[u], weight});
+    });
+  }
+  GraphLayout layout = GetLayout();
+  graph_ = SparseGraphData::FromEdges(size, edges);
+  FitWeights(metadata_.max_weight);
+  SetLayout(layout);
+}
+
+GraphLayout s21_graph::GetLayout() const {
+  return std::visit(
+      [](const auto& data) {
+        using Storage = std::decay_t<decltype(data)>;
+        if constexpr (s21::kIsDenseMatrix<Storage>) {
+          return GraphLayout::kDense;
+        } else if constexpr (std::is_same_v<Storage, s21::BitMatrix>) {
+          return GraphLayout::kBitPacked;
+        } else if constexpr (std::is_same_v<Storage, s21::CompressedGraph>) {
+          return GraphLayout::kCompressed;
+        } else {
+          return GraphLayout::kSparse;
+        }
+      },
+      graph_);
+}
+
+void s21_graph::SetLayout(GraphLayout layout) {
+  if (layout == GetLayout()) return;
+  if (layout == GraphLayout::kBitPacked && metadata_.max_weight > 1) {
+    throw std::logic_error("Only unweighted graphs can be bit-packed!");
+  }
+  if (layout == GraphLayout::kCompressed) {
+    graph_ = s21::CompressedGraph::FromCsr(ToCsr());
+    return;
+  }
+  if (GetLayout() == GraphLayout::kCompressed) {
+    graph_ = std::get<s21::CompressedGraph>(graph_).ToCsr();
+    FitWeights(metadata_.max_weight);
+    if (layout == GraphLayout::kSparse) return;
+  }
+  // the weight type is kept
+  GraphStorage converted = std::visit(
+      [layout](const auto& data) -> GraphStorage {
+        using Storage = std::decay_t<decltype(data)>;
+        using Weight = typename Storage::ValueType;
+        if constexpr (std::is_same_v<Storage, s21::BitMatrix>) {
+          if (layout == GraphLayout::kSparse) return data.ToCsr();
+          return data.template Convert<Weight>();
+        } else if constexpr (std::is_same_v<Storage, s21::CompressedGraph>) {
+          return data;  // converted above
+        } else if constexpr (s21::kIsDenseMatrix<Storage>) {
+          if (layout == GraphLayout::kBitPacked) {
+            return s21::BitMatrix::FromDense(data);
+          }
+          return s21::CsrGraph<Weight>::FromDense(data);
+        } else {
+          if (layout == GraphLayout::kBitPacked) {
+            return s21::BitMatrix::FromCsr(data);
+          }
+          return data.ToDense();
+        }
+      },
+      graph_);
+  graph_ = std::move(converted);
+}
+
+SparseGraphData s21_graph::ToCsr() const {
+  return std::visit(
+      [](const auto& data) -> SparseGraphData {
+        using Storage = std::decay_t<decltype(data)>;
+        using Weight = typename Storage::ValueType;
+        if constexpr (std::is_same_v<Storage, s21::BitMatrix>) {
+          return data.ToCsr().template Convert<int>();
+        } else if constexpr (std::is_same_v<Storage, s21::CompressedGraph>) {
+          return data.ToCsr();
+        } else if constexpr (s21::kIsDenseMatrix<Storage>) {
+          auto csr = s21::CsrGraph<Weight>::FromDense(data);
+          if constexpr (std::is_same_v<Weight, int>) {
+            return csr;
+          } else {
+            return csr.template Convert<int>();
+          }
+        } else if constexpr (std::is_same_v<Weight, int>) {
+          return data;
+        } else {
+          return data.template Convert<int>();
+        }
+      },
+      graph_);
+}
+
+std::shared_ptr<const SparseGraphData> s21_graph::GetReverse() const {
+  std::lock_guard lock(reverse_.mutex);
+  if (reverse_.csr == nullptr || reverse_.version != version_) {
+    reverse_.csr = std::make_shared<const SparseGraphData>(ToCsr().Transpose());
+    reverse_.version = version_;
+  }
+  return reverse_.csr;
+}
+
+std::uint64_t s21_graph::GetFingerprint() const {
+  std::lock_guard lock(fingerprint_.mutex);
+  if (fingerprint_.valid && fingerprint_.version == version_) {
+    return fingerprint_.value;
+  }
+  // the mixed edges are summed, so the order they are visited in does not
+  // matter
+  std::uint64_t fingerprint = MixBits(static_cast<std::uint64_t>(Size()));
+  for (int i = 0; i < Size(); ++i) {
+    const std::uint64_t from = static_cast<std::uint32_t>(OriginalId(i));
+    ForEachStoredNeighbor(i, [&](int j, int weight) {
+      const std::uint64_t to = static_cast<std::uint32_t>(OriginalId(j));
+      fingerprint += MixBits(MixBits(from << 32 | to) +
+                             static_cast<std::uint32_t>(weight));
+    });
+  }
+  fingerprint_.value = fingerprint;
+  fingerprint_.version = version_;
+  fingerprint_.valid = true;
+  return fingerprint;
+}
+
+std::size_t s21_graph::GetWeightBytes() const {
+  return std::visit(
+      [](const auto& data) {
+        return sizeof(typename std::decay_t<decltype(data)>::ValueType);
+      },
+      graph_);
+}
+
+std::size_t s21_graph::GetStorageBytes() const {
+  return std::visit([](const auto& data) { return data.MemoryBytes(); },
+                    graph_);
+}
+
+void s21_graph::FitWeights(int max_weight) {
+  // varints have no fixed width
+  if (GetLayout() == GraphLayout::kCompressed) return;
+  std::size_t bytes = 4;
+  if (max_weight <= std::numeric_limits<std::uint8_t>::max()) {
+    bytes = 1;
+  } else if (max_weight <= std::numeric_limits<std::uint16_t>::max()) {
+    bytes = 2;
+  }
+  if (bytes == GetWeightBytes() && max_weight <= MaxStorableWeight()) return;
+  GraphStorage converted = std::visit(
+      [bytes](const auto& data) -> GraphStorage {
+        if (bytes == 1) return data.template Convert<std::uint8_t>();
+        if (bytes == 2) return data.template Convert<std::uint16_t>();
+        return data.template Convert<int>();
+      },
+      graph_);
+  graph_ = std::move(converted);
+}
+
+int s21_graph::MaxStorableWeight() const {
+  if (GetLayout() == GraphLayout::kBitPacked) return 1;
+  const std::size_t bytes = GetWeightBytes();
+  if (bytes >= sizeof(int)) return std::numeric_limits<int>::max();
+  return (1 << (8 * bytes)) - 1;
+}
+
+int s21_graph::Weight(int i, int j) const {
+  return std::visit(
+      [i, j](const auto& data) -> int {
+        if constexpr (s21::kIsDenseMatrix<std::decay_t<decltype(data)>>) {
+          return data(i, j);
+        } else {
+          return data.At(i, j);
+        }
+      },
+      graph_);
+}
 
 void s21_graph::PrintGraph() const {
   std::cout << "Graph type: ";
@@ -128,9 +526,9 @@ void s21_graph::PrintGraph() const {
   }
   std::cout << std::endl;
   std::cout << "Graph:" << std::endl;
-  for (const auto& row : graph_) {
-    for (const auto& cell : row) {
-      std::cout << cell << " ";
+  for (int i = 0; i < Size(); ++i) {
+    for (int j = 0; j < Size(); ++j) {
+      std::cout << (*this)(i, j) << " ";
     }
     std::cout << std::endl;
   }
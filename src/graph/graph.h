@@ -1,17 +1,57 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "graph_binary.h"
+#include "graph_bitset.h"
+#include "graph_compressed.h"
+#include "graph_csr.h"
+#include "graph_matrix.h"
+#include "graph_metadata.h"
+#include "graph_order.h"
+#include "graph_parser.h"
+#include "mapped_file.h"
+
 /**
  * @brief Represents graph data as an adjacency matrix.
+ *
+ * The matrix is a single cache-line-aligned buffer with padded rows, see
+ * s21::DenseMatrix.
  */
-using GraphData = std::vector<std::vector<int>>;
+using GraphData = s21::DenseMatrix<int>;
+
+/**
+ * @brief Represents graph data as a compressed sparse row adjacency list.
+ */
+using SparseGraphData = s21::CsrGraph<int>;
+
+/**
+ * @brief The ways s21_graph can store its adjacency.
+ *
+ * Each layout comes in several weight widths. Loaders pick the narrowest
+ * one that holds every weight of the graph, so small-weight matrices take
+ * one or two bytes per cell instead of four, and unweighted ones a bit.
+ * The compressed layout decodes its weights to int.
+ */
+using GraphStorage =
+    std::variant<s21::DenseMatrix<std::uint8_t>,
+                 s21::DenseMatrix<std::uint16_t>, GraphData,
+                 s21::CsrGraph<std::uint8_t>, s21::CsrGraph<std::uint16_t>,
+                 SparseGraphData, s21::BitMatrix, s21::CompressedGraph>;
 
 /**
  * @brief Enumerates the types of graphs.
@@ -24,6 +64,43 @@ enum class GraphType {
   kUndefined              ///< Undefined type.
 };
 
+/**
+ * @brief Enumerates the ways the adjacency of a graph can be stored.
+ */
+enum class GraphLayout {
+  kDense,  ///< Adjacency matrix, O(V^2) memory, O(1) edge lookup.
+  kSparse,     ///< Compressed sparse rows, O(V + E) memory, O(degree) scans.
+  kBitPacked,  ///< One bit per cell, V^2 / 8 bytes; unweighted graphs only.
+  kCompressed  ///< Varint-packed sparse rows, read-only (s21::CompressedGraph).
+};
+
+/**
+ * @brief Enumerates the orders in which vertices can be laid out in memory.
+ *
+ * The public interface of s21_graph always uses the original ids; the order
+ * only decides which vertices share cache lines (see s21_graph::StorageId).
+ */
+enum class VertexOrder {
+  kOriginal,             ///< As in the file.
+  kBreadthFirst,         ///< As breadth-first searches visit them.
+  kReverseCuthillMcKee,  ///< Reverse Cuthill-McKee, small bandwidth.
+  kDegree                ///< By decreasing degree.
+};
+
+/**
+ * @brief Statistics of the last graph load.
+ */
+struct LoadStats {
+  std::size_t bytes = 0;    ///< Size of the input file in bytes.
+  double milliseconds = 0;  ///< Time spent mapping, parsing and classifying.
+
+  /**
+   * @brief Gets the parsing throughput.
+   * @return Megabytes (2^20 bytes) per second, 0 if nothing was timed.
+   */
+  double MegabytesPerSecond() const;
+};
+
 /**
  * @brief A class to represent a graph.
  *
@@ -41,17 +118,48 @@ class s21_graph {
   /**
    * @brief Loads a graph from a file.
    *
-   * The file format should be:
-   * First line: number of vertices.
-   * Second line: graph type (0: unweighted undirected, 1: unweighted directed,
-   * 2: weighted undirected, 3: weighted directed). Subsequent lines: adjacency
-   * matrix.
+   * The file holds the adjacency matrix alone: N lines of N
+   * whitespace-separated non-negative integers, where 0 means no edge. The
+   * type is inferred from the values and their symmetry.
+   * The file is memory-mapped and parsed in place, straight into the final
+   * matrix. Large files are split at line breaks into slices of about
+   * kParseSliceBytes that are parsed concurrently; the metadata (see
+   * GetMetadata) is collected in the same pass. Graphs whose density is
+   * below kSparseDensity are stored in the sparse layout, the others as a
+   * matrix, bit-packed if the graph is unweighted.
    * @param filename The path to the file containing the graph data.
-   * @throw std::runtime_error if the file cannot be opened or if the file
-   * format is invalid.
+   * @throw std::logic_error if the file cannot be opened or if the file
+   * format is invalid; errors inside a row name the row.
    */
   void LoadFromFile(std::string& filename);
 
+  /**
+   * @brief Loads a sparse graph from an edge list file.
+   *
+   * Every line holds one edge "source destination [weight]" with 1-based
+   * vertex ids; the weight defaults to 1 and edges of weight 0 are skipped.
+   * The first line may declare "directed" or "undirected", optionally
+   * followed by the number of vertices; otherwise the vertex count is the
+   * largest id, which may not exceed kMaxInferredVertices (2^20) or the
+   * file size in bytes, whichever is larger. Files that name larger ids,
+   * such as "1 2" and "2 2000000", must declare their vertex count. An
+   * undirected declaration adds every edge in both directions, and of
+   * parallel edges the lightest one is kept.
+   *
+   * The mapped file is read twice, once for the row lengths and once for
+   * the rows, straight into the sparse layout, so neither an adjacency
+   * matrix nor an edge list is ever built. Without a declaration the type
+   * is inferred as in LoadFromFile. A graph declared directed stays
+   * directed through later edits even if its edges are symmetric.
+   * @param filename The path to the edge list.
+   * @throw std::logic_error if the file cannot be opened, is empty, has a
+   * line with fewer than two or more than three values, or names a vertex
+   * out of range, negative or too large; errors name the line of the file.
+   * @throw std::out_of_range if an id is above the bound on an undeclared
+   * vertex count.
+   */
+  void LoadFromEdgeList(std::string& filename);
+
   /**
    * @brief Exports the graph to a DOT format file.
    * @param filename The path to the file where the DOT representation will be
@@ -60,6 +168,54 @@ class s21_graph {
    */
   void ExportToDot(std::string& filename);
 
+  /**
+   * @brief Saves the graph in the binary format (see s21::BinaryGraphHeader).
+   *
+   * The adjacency is written in its current layout: the padded matrix for
+   * dense graphs, the CSR arrays for sparse ones. The file is written next
+   * to the target and renamed over it, so graphs mapping the old file, this
+   * one included, keep their adjacency.
+   * @param filename The path to the file to create.
+   * @throw std::runtime_error if the file cannot be written.
+   */
+  void SaveToBinary(std::string& filename) const;
+
+  /**
+   * @brief Loads a graph saved by SaveToBinary.
+   *
+   * The file is memory-mapped read-only and the graph reads its matrix or
+   * CSR arrays directly from the mapping, so nothing is parsed or copied.
+   * The payload checksum is verified, which pages the file in once; the
+   * sections are checked in the same pass, so that no field of the file
+   * can make the graph read outside the mapping. The metadata is restored
+   * from the header rather than recomputed.
+   * @param filename The path to the binary file.
+   * @throw std::logic_error if the file cannot be opened, is truncated, has
+   * a different version, byte order or weight width, fails the checksum, or
+   * has sizes, offsets, neighbours, weights or metadata that do not fit the
+   * graph.
+   */
+  void LoadFromBinary(std::string& filename);
+
+  /**
+   * @brief Checks whether the adjacency is read from a memory-mapped file.
+   * @return True after LoadFromBinary until the data is converted.
+   */
+  bool IsMemoryMapped() const;
+
+  /**
+   * @brief Gets the size and timing of the last successful load.
+   * @return The load statistics (zero before the first load).
+   */
+  const LoadStats& GetLoadStats() const;
+
+  /**
+   * @brief Gets the edge statistics collected when the graph was loaded.
+   * @return Edge count, density, weight range, symmetry, self-loops and
+   * connected components of the graph.
+   */
+  const s21::GraphMetadata& GetMetadata() const;
+
   /**
    * @brief Prints the graph's adjacency matrix to the console.
    */
@@ -78,30 +234,509 @@ class s21_graph {
   GraphType GetType() const;
 
   /**
-   * @brief Gets the adjacency matrix of the graph.
-   * @return A constant reference to the graph data.
+   * @brief Gets the layout the adjacency is currently stored in.
+   * @return The graph layout.
+   */
+  GraphLayout GetLayout() const;
+
+  /**
+   * @brief Converts the adjacency to the requested layout.
+   *
+   * Leaving the bit-packed layout stores the 0/1 weights in one byte, and
+   * leaving the compressed one picks the narrowest weight type again.
+   * @param layout The layout to store the graph in.
+   * @throw std::logic_error if a weighted graph is to be bit-packed.
    */
-  GraphData Get() const;
+  void SetLayout(GraphLayout layout);
 
   /**
-   * @brief Accesses the weight of the edge between two vertices.
+   * @brief Lays the vertices out in memory in the given order.
+   *
+   * Ids in files often come from elsewhere and have no locality, so a
+   * search over them touches memory at random. Reordering stores vertices
+   * that are reached together next to each other. It applies to the loaded
+   * graph and to every later load; the public interface keeps accepting and
+   * returning the original ids, so only the storage ids change. Costs one
+   * rebuild of the adjacency, O(E log E), and increments the version.
+   * @param order The order to use; kOriginal undoes reordering.
+   */
+  void SetVertexOrder(VertexOrder order);
+
+  /**
+   * @brief Gets the order the vertices are laid out in.
+   */
+  VertexOrder GetVertexOrder() const;
+
+  /**
+   * @brief Gets the id a vertex has in the storage.
+   *
+   * Equal to the original id unless a vertex order is set. Algorithms that
+   * keep per-vertex arrays use storage ids (see ForEachStoredNeighbor and
+   * VisitStorage) and translate only their input and output.
+   * @param vertex The original id.
+   */
+  int StorageId(int vertex) const;
+
+  /**
+   * @brief Gets the original id of a vertex from its storage id.
+   */
+  int OriginalId(int storage_id) const;
+
+  /**
+   * @brief Adds the edge (from, to).
+   *
+   * Edges are directed cells of the adjacency, so an undirected edge is
+   * added by adding both directions. Like all mutators this updates the
+   * type and metadata in place instead of rescanning the graph, and
+   * increments the version. A compressed graph is converted to the sparse
+   * layout first.
+   * @param from The source vertex (0-based).
+   * @param to The destination vertex (0-based).
+   * @param weight The edge weight.
+   * @throw std::out_of_range for an unknown vertex, std::invalid_argument for
+   * a weight below 1, std::logic_error if the edge already exists.
+   */
+  void AddEdge(int from, int to, int weight = 1);
+
+  /**
+   * @brief Removes the edge (from, to).
+   *
+   * Removing the last edge between two vertices recounts the connected
+   * components, and removing the last edge of the smallest or largest
+   * weight rescans the weight range; each costs O(V + E) sparse or O(V^2)
+   * dense, since the dense and bit-packed layouts scan full rows.
+   * @throw std::out_of_range for an unknown vertex, std::logic_error if
+   * there is no such edge.
+   */
+  void RemoveEdge(int from, int to);
+
+  /**
+   * @brief Changes the weight of the existing edge (from, to).
+   *
+   * Moving the last edge of the smallest or largest weight away from it
+   * rescans the weight range, O(V + E) sparse or O(V^2) dense.
+   * @throw std::out_of_range for an unknown vertex, std::invalid_argument for
+   * a weight below 1, std::logic_error if there is no such edge.
+   */
+  void SetWeight(int from, int to, int weight);
+
+  /**
+   * @brief Adds a vertex without edges.
+   *
+   * Costs O(V^2) in the dense layout, which copies the matrix, and O(1)
+   * amortized in the sparse one.
+   * @return The id of the new vertex, the old Size().
+   */
+  int AddVertex();
+
+  /**
+   * @brief Removes a vertex and all its edges; later vertices move down by
+   * one id.
+   *
+   * Rebuilds the adjacency and the metadata, O(V^2) dense or O(V + E)
+   * sparse.
+   * @throw std::out_of_range for an unknown vertex.
+   */
+  void RemoveVertex(int vertex);
+
+  /**
+   * @brief Gets the version of the adjacency.
+   *
+   * Every load and every mutation takes the next value of a counter shared
+   * by all graphs, so results derived from the graph (traversals, distance
+   * tables) can be stored with the version they were computed for and
+   * discarded when it changes. Two graphs have the same version only if one
+   * was copied from the other, also by assignment, since their last change.
+   * @return The current version, 0 for a graph that was never loaded.
+   */
+  std::uint64_t GetVersion() const;
+
+  /**
+   * @brief Gets a fingerprint of the vertices and weighted edges.
+   *
+   * Indexes built for the graph store it to tell whether the graph they are
+   * used with has the same edges. It does not depend on the layout, weight
+   * width or vertex order. It is computed on the first call after a change,
+   * O(V + E), and kept until the next change. Concurrent calls are safe.
+   */
+  std::uint64_t GetFingerprint() const;
+
+  /**
+   * @brief Gets the size of one stored weight.
+   * @return 1, 2 or 4 bytes; the narrowest width that holds all weights
+   * (widened by mutators when a larger weight arrives). Bit-packed graphs
+   * report 1, compressed ones the 4 bytes of the decoded int.
+   */
+  std::size_t GetWeightBytes() const;
+
+  /**
+   * @brief Gets the memory taken by the adjacency.
+   * @return The size of the matrix, bits or arrays in bytes, including
+   * padding; for a memory-mapped graph the part of the file they occupy.
+   */
+  std::size_t GetStorageBytes() const;
+
+  /**
+   * @brief Calls visit with the adjacency storage in its concrete type.
+   *
+   * This is the zero-copy way to read a graph in any layout, weight width
+   * and vertex order: visit gets a const reference to the stored matrix,
+   * bits or arrays, so algorithms instantiate their kernels for the actual
+   * storage instead of going through Weight() or ForEachNeighbor. The
+   * storage is indexed by storage ids (see StorageId).
+   * @param visit Callable taking any of the GraphStorage alternatives.
+   * @return What visit returns.
+   */
+  template <typename Visitor>
+  decltype(auto) VisitStorage(Visitor&& visit) const {
+    return std::visit(std::forward<Visitor>(visit), graph_);
+  }
+
+  /**
+   * @brief Builds the compressed sparse row view of the graph.
+   * @return Offsets, neighbour ids and weights of all edges. If the graph is
+   * stored sparse this is a copy of the stored data.
+   */
+  SparseGraphData ToCsr() const;
+
+  /**
+   * @brief Gets the graph with every edge reversed, in storage ids.
+   *
+   * Backward searches on directed graphs read it. It is built on the first
+   * call after a change, O(V + E), and shared by later calls until the next
+   * change. Concurrent calls are safe.
+   * @return The reversed adjacency in compressed sparse rows.
+   */
+  std::shared_ptr<const SparseGraphData> GetReverse() const;
+
+  /**
+   * @brief Gets a read-only view of a dense adjacency matrix.
+   *
+   * Only for graphs known to be dense, with T cells, in the original
+   * vertex order. Loading picks the narrowest weight width and may pick
+   * the sparse or bit-packed layout, so most loaded graphs do not qualify;
+   * read those with VisitRow, VisitStorage or ForEachNeighbor. T has no
+   * default, so callers name the width they expect. The view refers to
+   * the graph's own cells, nothing is copied. It stays valid until the
+   * graph is modified, reloaded or converted to another layout.
+   * @tparam T The stored weight type (see GetWeightBytes).
+   * @return A view with (i, j) access and row spans.
+   * @throw std::logic_error if the graph is not stored as a matrix of T or
+   * the vertices are reordered.
+   */
+  template <typename T>
+  s21::MatrixView<const T> View() const {
+    return Dense<T>().View();
+  }
+
+  /**
+   * @brief Gets the weight of the edge between two vertices.
    * @param i The row index (source vertex).
    * @param j The column index (destination vertex).
-   * @return The weight of the edge (i, j). Returns 0 if no edge exists in
-   * unweighted graphs.
+   * @return The weight of the edge (i, j), or 0 if no edge exists. Works in
+   * every layout: one cell read in the dense one, a binary search in row i
+   * in the sparse one, one bit read in the bit-packed one, and in the
+   * compressed one a decode of row i from its start up to j.
+   */
+  int operator()(const int i, const int j) const {
+    return Weight(StorageId(i), StorageId(j));
+  }
+
+  /**
+   * @brief Gets the contiguous row of a dense adjacency matrix of T.
+   *
+   * Has the limits of View(); VisitRow reads a dense row of any weight
+   * width and ForEachNeighbor a row in any layout.
+   * @tparam T The stored weight type (see GetWeightBytes).
+   * @param i The row index (source vertex).
+   * @return The Size() weights of the edges leaving vertex i, without
+   * copying them.
+   * @throw std::logic_error if the graph is not stored as a matrix of T or
+   * the vertices are reordered.
+   */
+  template <typename T>
+  std::span<const T> Row(const int i) const {
+    return View<T>().Row(i);
+  }
+
+  /**
+   * @brief Calls visit with the contiguous matrix row of a vertex in its
+   * stored weight type.
+   *
+   * Works for every weight width and vertex order of the dense layout, so
+   * const code can scan rows without naming the width: visit is called
+   * once with a std::span<const T> of the Size() cells, T being uint8_t,
+   * uint16_t or int. The cells are indexed by storage ids (see StorageId).
+   * Nothing is copied.
+   * @param i The source vertex.
+   * @param visit Callable taking a std::span<const T> for each T.
+   * @throw std::logic_error if the graph is not stored as a matrix.
+   */
+  template <typename Visitor>
+  void VisitRow(const int i, Visitor&& visit) const {
+    const int row = StorageId(i);
+    std::visit(
+        [&](const auto& data) {
+          using Storage = std::decay_t<decltype(data)>;
+          if constexpr (s21::kIsDenseMatrix<Storage>) {
+            using T = typename Storage::ValueType;
+            visit(std::span<const T>(data.Row(row), data.Size()));
+          } else {
+            throw std::logic_error(
+                "Matrix rows are only available in dense layout!");
+          }
+        },
+        graph_);
+  }
+
+  /**
+   * @brief Calls visit(neighbor, weight) for every edge leaving a vertex.
+   *
+   * Works in every layout, weight width and vertex order without copying
+   * the adjacency. Neighbours are reported in ascending order of their
+   * storage ids, which is ascending order unless a vertex order is set. In
+   * the sparse layout this costs O(degree), in the dense layout one scan of
+   * the matrix row.
+   * @param v The source vertex.
+   * @param visit Callable taking (int neighbor, int weight).
+   */
+  template <typename Visitor>
+  void ForEachNeighbor(const int v, Visitor&& visit) const {
+    if (old_id_.empty()) {
+      ForEachStoredNeighbor(v, visit);
+      return;
+    }
+    ForEachStoredNeighbor(new_id_[v], [&](int u, int weight) {
+      visit(old_id_[u], weight);
+    });
+  }
+
+  /**
+   * @brief Calls visit(neighbor, weight) for every edge leaving a vertex,
+   * in storage ids (see StorageId).
+   * @param v The storage id of the source vertex.
+   * @param visit Callable taking (int neighbor, int weight), the neighbour
+   * by storage id, in ascending order.
+   */
+  template <typename Visitor>
+  void ForEachStoredNeighbor(const int v, Visitor&& visit) const {
+    std::visit(
+        [&](const auto& data) {
+          using Storage = std::decay_t<decltype(data)>;
+          if constexpr (s21::kIsDenseMatrix<Storage>) {
+            const auto* row = data.Row(v);
+            const int size = data.Size();
+            for (int u = 0; u < size; ++u) {
+              if (row[u] > 0) visit(u, static_cast<int>(row[u]));
+            }
+          } else {
+            data.ForEachNeighbor(v, [&](int u, auto weight) {
+              visit(u, static_cast<int>(weight));
+            });
+          }
+        },
+        graph_);
+  }
+
+  /**
+   * @brief Graphs with fewer than this share of possible edges are stored
+   * in the sparse layout on load.
+   */
+  static constexpr double kSparseDensity = 0.05;
+
+  /**
+   * @brief Approximate size of the slices LoadFromFile parses in parallel.
+   */
+  static constexpr std::size_t kParseSliceBytes = 1 << 20;
+
+  /**
+   * @brief Without a declared vertex count, edge list ids may go up to this
+   * or the file size in bytes, so that a stray id cannot make the row
+   * offsets far larger than the file.
    */
-  const int operator()(const int i, const int j) { return graph_[i][j]; }
+  static constexpr std::size_t kMaxInferredVertices = 1 << 20;
 
  private:
-  GraphData graph_;  ///< The adjacency matrix representation of the graph.
+  GraphStorage graph_;  ///< The adjacency in its current layout and width.
   GraphType graph_type_ = GraphType::kUndefined;  ///< The type of the graph.
+  bool directed_declared_ = false;  ///< The file declared it directed.
+  LoadStats load_stats_;         ///< Size and timing of the last load.
+  s21::GraphMetadata metadata_;  ///< Edge statistics of the graph.
+  std::uint64_t version_ = 0;    ///< Drawn from NextVersion on every change.
+  VertexOrder vertex_order_ = VertexOrder::kOriginal;  ///< Storage order.
+  std::vector<int> old_id_;  ///< Original id by storage id; empty if equal.
+  std::vector<int> new_id_;  ///< Storage id by original id; empty if equal.
 
   /**
-   * @brief Parses the graph type from the loaded data.
+   * @brief State that lets mutators patch metadata_ instead of recomputing
+   * it. Built on the first mutation after a load.
+   */
+  struct PatchState {
+    std::uint64_t version = 0;         ///< Version the state is valid for.
+    s21::DisjointSets components;      ///< Vertices joined by edges.
+    std::size_t min_weight_edges = 0;  ///< Edges of metadata_.min_weight.
+    std::size_t max_weight_edges = 0;  ///< Edges of metadata_.max_weight.
+  };
+  PatchState patch_;  ///< Incremental metadata state.
+
+  /**
+   * @brief The reversed adjacency built by GetReverse. Copies of the graph
+   * start without it.
+   */
+  struct ReverseCache {
+    std::uint64_t version = 0;  ///< Version the adjacency was built for.
+    std::shared_ptr<const SparseGraphData> csr;  ///< Reversed adjacency.
+    std::mutex mutex;                            ///< Guards the members.
+
+    ReverseCache() = default;
+    ReverseCache(const ReverseCache&) {}
+    ReverseCache& operator=(const ReverseCache&) {
+      std::lock_guard lock(mutex);
+      csr.reset();
+      return *this;
+    }
+  };
+  mutable ReverseCache reverse_;  ///< Lazily built reversed adjacency.
+
+  /**
+   * @brief The fingerprint computed by GetFingerprint. Copies of the graph
+   * start without it.
+   */
+  struct FingerprintCache {
+    std::uint64_t version = 0;  ///< Version the fingerprint was taken of.
+    std::uint64_t value = 0;    ///< The fingerprint.
+    bool valid = false;         ///< Whether value was computed.
+    std::mutex mutex;           ///< Guards the members.
+
+    FingerprintCache() = default;
+    FingerprintCache(const FingerprintCache&) {}
+    FingerprintCache& operator=(const FingerprintCache&) {
+      std::lock_guard lock(mutex);
+      valid = false;
+      return *this;
+    }
+  };
+  mutable FingerprintCache fingerprint_;  ///< Lazily computed fingerprint.
+
+  /**
+   * @brief Derives the graph type from the metadata.
    * This function is typically called internally by LoadFromFile.
-   * @deprecated This method seems to be intended for internal use within
-   * LoadFromFile or a similar setup phase. It's not clear how it's used based
-   * on the header alone.
+   * A graph declared directed stays directed; otherwise the direction
+   * follows the symmetry of the edges.
    */
   void ParseType();
+
+  /**
+   * @brief Gets the type ParseType derives from metadata and a declared
+   * direction.
+   */
+  static GraphType TypeOf(const s21::GraphMetadata& metadata,
+                          bool directed_declared);
+
+  /**
+   * @brief Lays out a graph that was just loaded in vertex_order_.
+   * The storage must hold the vertices in their original order.
+   */
+  void OrderLoadedGraph();
+
+  /**
+   * @brief Moves the vertices to the positions vertex_order_ gives them and
+   * updates the id maps.
+   */
+  void Reorder();
+
+  /**
+   * @brief Rebuilds the storage with storage id order[k] moved to k,
+   * keeping the layout and weight width.
+   */
+  void Relabel(const std::vector<int>& order);
+
+  /**
+   * @brief Collects the metadata by scanning the stored adjacency once.
+   * Used by loaders that do not see every edge while parsing.
+   */
+  void ComputeMetadata();
+
+  /**
+   * @brief Throws std::out_of_range unless 0 <= vertex < Size().
+   */
+  void CheckVertex(int vertex) const;
+
+  /**
+   * @brief Builds patch_ for the current version if it is stale.
+   */
+  void PreparePatch();
+
+  /**
+   * @brief Recounts the weight range and the edges at its ends.
+   */
+  void CountWeightRange();
+
+  /**
+   * @brief Recomputes the connected components from scratch.
+   */
+  void CountComponents();
+
+  /**
+   * @brief Converts read-only storage (the compressed layout) to the sparse
+   * layout before a change.
+   */
+  void MakeWritable();
+
+  /**
+   * @brief Writes one adjacency cell and patches the metadata.
+   * @param weight The new weight; 0 removes the edge.
+   * @return The previous weight.
+   */
+  int WriteEdge(int from, int to, int weight);
+
+  /**
+   * @brief Finishes a mutation: bumps the version and re-derives the type.
+   */
+  void CommitChange();
+
+  /**
+   * @brief Draws a version no graph has had before.
+   */
+  static std::uint64_t NextVersion();
+
+  /**
+   * @brief Gets the adjacency matrix of a dense graph.
+   * @tparam T The expected weight type.
+   * @throw std::logic_error if the graph is stored sparse or with another
+   * weight type.
+   */
+  template <typename T>
+  const s21::DenseMatrix<T>& Dense() const {
+    if (GetLayout() != GraphLayout::kDense) {
+      throw std::logic_error("Matrix rows are only available in dense layout!");
+    }
+    if (!old_id_.empty()) {
+      throw std::logic_error(
+          "Matrix rows are only available in the original vertex order!");
+    }
+    const auto* dense = std::get_if<s21::DenseMatrix<T>>(&graph_);
+    if (dense == nullptr) {
+      throw std::logic_error("The matrix is stored with another weight type!");
+    }
+    return *dense;
+  }
+
+  /**
+   * @brief Converts the storage to the narrowest weight type that holds
+   * max_weight, keeping the layout. Bit-packed storage becomes a matrix if
+   * max_weight is above 1.
+   */
+  void FitWeights(int max_weight);
+
+  /**
+   * @brief Gets the heaviest weight the current storage can hold.
+   */
+  int MaxStorableWeight() const;
+
+  /**
+   * @brief Gets the weight of edge (i, j) in the current layout.
+   * @return The weight, or 0 if there is no edge.
+   */
+  int Weight(int i, int j) const;
 };
\ No newline at end of file
@@ -0,0 +1,376 @@
+#include "graph_binary.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <random>
+
+#include "graph.h"
+
+namespace {
+
+const std::string kFormat = "binary graph";
+
+/**
+ * @brief Checks a weight read from a file against the range in the header.
+ */
+template <typename T>
+void CheckWeight(const s21::BinaryGraphHeader& header,
+                 const s21::BinarySectionReader& reader, T weight) {
+  if (static_cast<std::int64_t>(weight) < header.min_weight ||
+      static_cast<std::int64_t>(weight) > header.max_weight) {
+    reader.Fail("weight outside the recorded range");
+  }
+}
+
+/**
+ * @brief Checks the edges counted in the payload against the header.
+ */
+void CheckCounts(const s21::BinaryGraphHeader& header,
+                 const s21::BinarySectionReader& reader, std::size_t edges,
+                 std::size_t self_loops) {
+  if (edges != header.edge_count || self_loops != header.self_loops) {
+    reader.Fail("inconsistent edge count");
+  }
+}
+
+/**
+ * @brief Checks that the metadata in the header could describe a graph
+ * stored with its layout and weight width.
+ *
+ * The fields the payload cannot confirm cheaply (asymmetric pairs,
+ * components) are only bounded here; the checksum, which covers the
+ * header, catches edits of them.
+ */
+void CheckMetadata(const s21::BinaryGraphHeader& header) {
+  std::uint64_t weight_limit = std::numeric_limits<int>::max();
+  if (header.weight_bytes == 0 ||
+      header.layout == static_cast<std::uint32_t>(GraphLayout::kBitPacked)) {
+    weight_limit = 1;
+  } else if (header.weight_bytes < 4) {
+    weight_limit = (1ULL << (8 * header.weight_bytes)) - 1;
+  }
+  bool valid = header.components <= header.vertex_count &&
+               header.self_loops <= header.edge_count &&
+               header.asymmetric_pairs <= header.edge_count &&
+               header.directed_declared <= 1;
+  if (header.edge_count == 0) {
+    valid &= header.min_weight == 0 && header.max_weight == 0 &&
+             header.components == header.vertex_count;
+  } else {
+    valid &= header.min_weight >= 1 && header.min_weight <= header.max_weight &&
+             header.max_weight <= weight_limit && header.components >= 1;
+  }
+  if (!valid) s21::InvalidBinaryFile(kFormat, "inconsistent metadata");
+}
+
+/**
+ * @brief Gets the metadata recorded in a checked header.
+ */
+s21::GraphMetadata RestoreMetadata(const s21::BinaryGraphHeader& header) {
+  s21::GraphMetadata metadata;
+  metadata.vertex_count = static_cast<int>(header.vertex_count);
+  metadata.edge_count = header.edge_count;
+  metadata.density = metadata.vertex_count > 0
+                         ? static_cast<double>(metadata.edge_count) /
+                               metadata.vertex_count / metadata.vertex_count
+                         : 0;
+  metadata.min_weight = static_cast<int>(header.min_weight);
+  metadata.max_weight = static_cast<int>(header.max_weight);
+  metadata.self_loops = header.self_loops;
+  metadata.asymmetric_pairs = header.asymmetric_pairs;
+  metadata.components = static_cast<int>(header.components);
+  return metadata;
+}
+
+/**
+ * @brief Creates the storage of weight type T over a mapped payload,
+ * checking the sections while the reader hashes them: row offsets ascend
+ * within the edges, neighbours are vertices, padding bits of bit rows are
+ * clear, and the weights, edges and self-loops agree with the header.
+ */
+template <typename T>
+GraphStorage BorrowStorage(const s21::BinaryGraphHeader& header,
+                           s21::BinarySectionReader& reader,
+                           std::shared_ptr<const s21::MappedFile> file) {
+  const int size = static_cast<int>(header.vertex_count);
+  const std::size_t rows = header.vertex_count + 1;
+  std::size_t edges = 0;
+  std::size_t self_loops = 0;
+  if (header.layout == static_cast<std::uint32_t>(GraphLayout::kCompressed)) {
+    constexpr int kBlockRows = s21::CompressedGraph::kBlockRows;
+    const std::size_t bytes_limit = reader.Remaining();
+    auto blocks = reader.Next<std::uint64_t>(
+        header.vertex_count / kBlockRows + 1, [&](std::uint64_t offset) {
+          if (offset > bytes_limit) reader.Fail("inconsistent row offsets");
+        });
+    if (blocks[0] != 0) reader.Fail("inconsistent row offsets");
+    std::size_t v = 0;
+    std::uint64_t previous = 0;
+    auto row_offsets = reader.Next<std::uint32_t>(rows, [&](std::uint32_t row) {
+      std::uint64_t start = blocks[v++ / kBlockRows] + row;
+      if (start < previous || start > bytes_limit) {
+        reader.Fail("inconsistent row offsets");
+      }
+      previous = start;
+    });
+    auto bytes = reader.Next<std::uint8_t>(previous);
+    auto graph = s21::CompressedGraph::Borrow(
+        blocks, row_offsets, bytes, header.edge_count,
+        header.weight_bytes == 0, std::move(file));
+    // each block of rows is decoded right after its bytes are hashed
+    for (int first = 0; first < size; first += kBlockRows) {
+      const int last = std::min(size, first + kBlockRows);
+      reader.VerifyUpTo(bytes.data() + blocks[last / kBlockRows] +
+                        row_offsets[last]);
+      if (!graph.CheckRows(first, last, static_cast<int>(header.min_weight),
+                           static_cast<int>(header.max_weight), edges,
+                           self_loops)) {
+        reader.Fail("malformed encoded row");
+      }
+    }
+    CheckCounts(header, reader, edges, self_loops);
+    return graph;
+  }
+  if (header.layout == static_cast<std::uint32_t>(GraphLayout::kBitPacked)) {
+    using Word = s21::BitMatrix::Word;
+    constexpr std::size_t kWordBits = sizeof(Word) * 8;
+    const std::size_t stride = header.stride;
+    if (stride < s21::BitMatrix::RowStride(size)) {
+      reader.Fail("bit matrix does not fit the payload");
+    }
+    // bits past the last column would read as neighbours
+    std::size_t row = 0;
+    std::size_t column = 0;
+    auto words = reader.Next<Word>(
+        reader.Multiply(header.vertex_count, stride), [&](Word bits) {
+          if (bits != 0) {
+            if (column + kWordBits > header.vertex_count &&
+                (column >= header.vertex_count ||
+                 bits >> (header.vertex_count - column) != 0)) {
+              reader.Fail("bits outside the matrix");
+            }
+            edges += std::popcount(bits);
+            if (row >= column && row < column + kWordBits) {
+              self_loops += bits >> (row - column) & 1;
+            }
+          }
+          column += kWordBits;
+          if (column == stride * kWordBits) {
+            column = 0;
+            ++row;
+          }
+        });
+    CheckCounts(header, reader, edges, self_loops);
+    return s21::BitMatrix::Borrow(words.data(), size, stride, std::move(file));
+  }
+  if (header.layout == static_cast<std::uint32_t>(GraphLayout::kDense)) {
+    if (header.stride < header.vertex_count) {
+      reader.Fail("matrix does not fit the payload");
+    }
+    std::size_t row = 0;
+    std::size_t column = 0;
+    auto cells = reader.Next<T>(
+        reader.Multiply(header.vertex_count, header.stride), [&](T cell) {
+          if (cell != 0) {
+            // cells past the last column are counted, so they fail the count
+            CheckWeight(header, reader, cell);
+            ++edges;
+            self_loops += row == column;
+          }
+          if (++column == header.stride) {
+            column = 0;
+            ++row;
+          }
+        });
+    CheckCounts(header, reader, edges, self_loops);
+    return s21::DenseMatrix<T>::Borrow(cells.data(), size, header.stride,
+                                       std::move(file));
+  }
+  std::size_t previous = 0;
+  bool first = true;
+  auto offsets = reader.Next<std::size_t>(rows, [&](std::size_t offset) {
+    if ((first && offset != 0) || offset < previous ||
+        offset > header.edge_count) {
+      reader.Fail("inconsistent row offsets");
+    }
+    previous = offset;
+    first = false;
+  });
+  if (offsets.back() != header.edge_count) {
+    reader.Fail("inconsistent row offsets");
+  }
+  std::size_t row = 0;
+  int last = -1;
+  auto neighbors = reader.Next<int>(header.edge_count, [&](int u) {
+    if (u < 0 || u >= size) reader.Fail("neighbour out of range");
+    while (offsets[row + 1] <= edges) ++row;
+    // lookups and edits binary search the rows, so ids must strictly rise
+    if (edges > offsets[row] && u <= last) reader.Fail("unsorted row");
+    last = u;
+    self_loops += static_cast<std::size_t>(u) == row;
+    ++edges;
+  });
+  auto weights = reader.Next<T>(header.edge_count, [&](T weight) {
+    CheckWeight(header, reader, weight);
+  });
+  CheckCounts(header, reader, edges, self_loops);
+  return s21::CsrGraph<T>::Borrow(offsets, neighbors, weights,
+                                  std::move(file));
+}
+
+}  // namespace
+
+s21::ReplacingFile::ReplacingFile(const std::string& filename)
+    : filename_(filename) {
+  // the counter keeps the names of one process apart, the seed those of
+  // processes saving the same target
+  static std::atomic<std::uint64_t> counter{0};
+  static const std::uint64_t seed = [] {
+    std::random_device device;
+    return (static_cast<std::uint64_t>(device()) << 32) | device();
+  }();
+  const int kAttempts = 100;
+  for (int attempt = 0; attempt < kAttempts; ++attempt) {
+    std::uint64_t suffix = seed + counter.fetch_add(1);
+    temporary_ = filename + ".tmp." + std::to_string(suffix);
+    // "x" fails instead of opening a file that already exists
+    std::FILE* created = std::fopen(temporary_.c_str(), "wbx");
+    if (created == nullptr) {
+      if (std::filesystem::exists(temporary_)) continue;
+      break;
+    }
+    std::fclose(created);
+    stream_.open(temporary_, std::ios::binary);
+    if (stream_.is_open()) return;
+    std::error_code error;
+    std::filesystem::remove(temporary_, error);
+    break;
+  }
+  throw std::runtime_error("Unable to open file for writing: " + filename);
+}
+
+void s21_graph::SaveToBinary(std::string& filename) const {
+  static_assert(sizeof(std::size_t) == sizeof(std::uint64_t),
+                "row offsets are stored as 64-bit integers");
+  if (!old_id_.empty()) {
+    // files keep the original ids
+    s21_graph original = *this;
+    original.SetVertexOrder(VertexOrder::kOriginal);
+    original.SaveToBinary(filename);
+    return;
+  }
+  // a graph loaded from this file may still read from its mapping
+  s21::ReplacingFile output(filename);
+  std::ofstream& file = output.Stream();
+
+  s21::BinaryGraphHeader header;
+  header.graph_type = static_cast<std::uint32_t>(graph_type_);
+  header.layout = static_cast<std::uint32_t>(GetLayout());
+  header.weight_bytes = static_cast<std::uint32_t>(GetWeightBytes());
+  header.vertex_count = Size();
+  header.min_weight = static_cast<std::uint32_t>(metadata_.min_weight);
+  header.max_weight = static_cast<std::uint32_t>(metadata_.max_weight);
+  header.self_loops = metadata_.self_loops;
+  header.asymmetric_pairs = metadata_.asymmetric_pairs;
+  header.components = static_cast<std::uint64_t>(metadata_.components);
+  header.directed_declared = directed_declared_;
+  // the header is rewritten once the checksum is known
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  s21::BinarySectionWriter writer(file);
+  std::visit(
+      [&](const auto& data) {
+        using Storage = std::decay_t<decltype(data)>;
+        if constexpr (std::is_same_v<Storage, s21::CompressedGraph>) {
+          header.edge_count = data.EdgeCount();
+          if (data.HasUnitWeights()) header.weight_bytes = 0;
+          writer.Write(data.Blocks().data(), data.Blocks().size_bytes());
+          writer.Write(data.Rows().data(), data.Rows().size_bytes());
+          writer.Write(data.Bytes().data(), data.Bytes().size_bytes());
+        } else if constexpr (std::is_same_v<Storage, s21::BitMatrix>) {
+          header.stride = data.Stride();
+          header.edge_count = metadata_.edge_count;
+          writer.Write(data.Data(), data.Size() * data.Stride() *
+                                        sizeof(s21::BitMatrix::Word));
+        } else if constexpr (s21::kIsDenseMatrix<Storage>) {
+          header.stride = data.Stride();
+          header.edge_count = metadata_.edge_count;
+          writer.Write(data.Data(), data.Size() * data.Stride() *
+                                        sizeof(typename Storage::ValueType));
+        } else {
+          header.edge_count = data.EdgeCount();
+          writer.Write(data.Offsets().data(), data.Offsets().size_bytes());
+          writer.Write(data.AllNeighbors().data(),
+                       data.AllNeighbors().size_bytes());
+          writer.Write(data.AllWeights().data(),
+                       data.AllWeights().size_bytes());
+        }
+      },
+      graph_);
+  writer.Finish(header, filename);
+  output.Commit();
+}
+
+void s21_graph::LoadFromBinary(std::string& filename) {
+  auto start = std::chrono::steady_clock::now();
+  auto file = std::make_shared<const s21::MappedFile>(filename);
+
+  auto header = s21::ReadBinaryHeader<s21::BinaryGraphHeader>(*file, kFormat);
+  if (header.graph_type > static_cast<std::uint32_t>(GraphType::kUndefined) ||
+      header.layout > static_cast<std::uint32_t>(GraphLayout::kCompressed)) {
+    s21::InvalidBinaryFile(kFormat, "unknown graph type or layout");
+  }
+  bool compressed =
+      header.layout == static_cast<std::uint32_t>(GraphLayout::kCompressed);
+  if (header.weight_bytes != 1 && header.weight_bytes != 2 &&
+      header.weight_bytes != 4 && !(compressed && header.weight_bytes == 0)) {
+    s21::InvalidBinaryFile(kFormat, "unsupported weight width");
+  }
+  // vertex ids are ints, and the CSR offsets take one more
+  if (header.vertex_count >=
+      static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+    s21::InvalidBinaryFile(kFormat, "too many vertices");
+  }
+  CheckMetadata(header);
+  // only a graph that was never loaded is saved without a type
+  s21::GraphMetadata metadata = RestoreMetadata(header);
+  const bool directed = header.directed_declared != 0;
+  if (header.graph_type !=
+          static_cast<std::uint32_t>(TypeOf(metadata, directed)) &&
+      !(header.vertex_count == 0 &&
+        header.graph_type ==
+            static_cast<std::uint32_t>(GraphType::kUndefined))) {
+    s21::InvalidBinaryFile(kFormat, "graph type does not match the edges");
+  }
+
+  s21::BinarySectionReader reader(file->Data() + sizeof(header),
+                                  header.payload_bytes, kFormat);
+  GraphStorage storage;
+  if (header.weight_bytes == 1) {
+    storage = BorrowStorage<std::uint8_t>(header, reader, file);
+  } else if (header.weight_bytes == 2) {
+    storage = BorrowStorage<std::uint16_t>(header, reader, file);
+  } else {
+    storage = BorrowStorage<int>(header, reader, file);
+  }
+  reader.Finish(header);
+
+  graph_ = std::move(storage);
+  graph_type_ = static_cast<GraphType>(header.graph_type);
+  directed_declared_ = directed;
+  metadata_ = metadata;
+  OrderLoadedGraph();
+
+  version_ = NextVersion();
+  load_stats_.bytes = file->Size();
+  load_stats_.milliseconds =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+}
+
+bool s21_graph::IsMemoryMapped() const {
+  return std::visit([](const auto& data) { return data.IsBorrowed(); },
+                    graph_);
+}
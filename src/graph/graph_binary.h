@@ -0,0 +1,420 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "mapped_file.h"
+
+namespace s21 {
+
+/**
+ * @brief Current version of the binary graph format.
+ */
+inline constexpr std::uint32_t kBinaryFormatVersion = 3;
+
+/**
+ * @brief Sections of a binary graph file start on multiples of this many
+ * bytes, so mapped matrices keep their cache-line-aligned rows.
+ */
+inline constexpr std::size_t kBinaryAlignment = 64;
+
+/**
+ * @brief Marker written in host byte order to detect foreign files.
+ */
+inline constexpr std::uint32_t kBinaryByteOrderMark = 0x01020304;
+
+/**
+ * @brief Fixed-size header at the start of a binary graph file.
+ *
+ * The header is followed by the payload. For the dense layout it is the
+ * matrix, vertex_count rows of stride cells. For the bit-packed layout it is
+ * vertex_count rows of stride 64-bit words (see s21::BitMatrix); its
+ * weight_bytes is 1. The compressed layout stores the block offsets
+ * (uint64), vertex_count + 1 row offsets (uint32) and the encoded rows of
+ * s21::CompressedGraph; its weight_bytes is 0 if the weights are left out,
+ * 4 otherwise. For the sparse layout it holds
+ * three sections: vertex_count + 1 row offsets (uint64), edge_count
+ * neighbour ids (int32), then edge_count weights. Cells and weights are
+ * unsigned integers of weight_bytes bytes (int32 for 4). Each section is
+ * zero-padded to kBinaryAlignment bytes.
+ *
+ * The header also records the s21::GraphMetadata of the graph, so a load
+ * restores it instead of scanning the edges again; the counts the payload
+ * can confirm cheaply (edges, self-loops, weight range) are checked while
+ * it is hashed, the others are covered by the checksum.
+ */
+struct BinaryGraphHeader {
+  char magic[4] = {'S', '2', '1', 'G'};  ///< File signature.
+  std::uint32_t version = kBinaryFormatVersion;      ///< Format version.
+  std::uint32_t byte_order = kBinaryByteOrderMark;   ///< Byte order mark.
+  std::uint32_t graph_type = 0;     ///< GraphType of the stored graph.
+  std::uint32_t layout = 0;         ///< GraphLayout of the payload.
+  std::uint32_t weight_bytes = 0;   ///< Size of one weight in bytes.
+  std::uint64_t vertex_count = 0;   ///< Number of vertices.
+  std::uint64_t edge_count = 0;     ///< Number of stored (directed) edges.
+  std::uint64_t stride = 0;         ///< Matrix layouts: cells (words) per row.
+  std::uint64_t payload_bytes = 0;  ///< Bytes following the header.
+  std::uint64_t checksum = 0;       ///< See BinaryFileChecksum.
+  std::uint32_t min_weight = 0;     ///< Lightest edge, 0 without edges.
+  std::uint32_t max_weight = 0;     ///< Heaviest edge, 0 without edges.
+  std::uint64_t self_loops = 0;     ///< Edges (v, v).
+  std::uint64_t asymmetric_pairs = 0;  ///< Pairs with w(i, j) != w(j, i).
+  std::uint64_t components = 0;     ///< Weakly connected components.
+  std::uint32_t directed_declared = 0;  ///< 1 if declared directed.
+  std::uint32_t padding = 0;        ///< Zero.
+  std::uint64_t reserved[3] = {};   ///< Zero.
+};
+
+static_assert(sizeof(BinaryGraphHeader) % kBinaryAlignment == 0,
+              "the payload must start on an aligned offset");
+
+/**
+ * @brief Rounds a byte count up to a multiple of kBinaryAlignment.
+ */
+inline constexpr std::size_t AlignBinary(std::size_t bytes) {
+  return (bytes + kBinaryAlignment - 1) / kBinaryAlignment * kBinaryAlignment;
+}
+
+/**
+ * @brief Incremental FNV-1a checksum over 64-bit words.
+ *
+ * Hashing words instead of single bytes keeps verification close to memory
+ * bandwidth. The data may be fed in pieces of any size; a trailing partial
+ * word is hashed zero-padded.
+ */
+class BinaryChecksum {
+ public:
+  /**
+   * @brief Adds bytes to the checksum.
+   */
+  void Update(const void* data, std::size_t bytes) {
+    const auto* ptr = static_cast<const unsigned char*>(data);
+    while (bytes > 0 && pending_size_ > 0) {
+      AddPending(*ptr++);
+      --bytes;
+    }
+    for (; bytes >= sizeof(std::uint64_t); bytes -= sizeof(std::uint64_t)) {
+      std::uint64_t word;
+      std::memcpy(&word, ptr, sizeof(word));
+      Mix(word);
+      ptr += sizeof(word);
+    }
+    while (bytes-- > 0) AddPending(*ptr++);
+  }
+
+  /**
+   * @brief Gets the checksum of all bytes added so far.
+   */
+  std::uint64_t Value() const {
+    if (pending_size_ == 0) return hash_;
+    std::uint64_t word = 0;
+    std::memcpy(&word, pending_, pending_size_);
+    return (hash_ ^ word) * kPrime;
+  }
+
+ private:
+  static constexpr std::uint64_t kPrime = 0x100000001b3ULL;
+
+  std::uint64_t hash_ = 0xcbf29ce484222325ULL;  ///< FNV offset basis.
+  unsigned char pending_[sizeof(std::uint64_t)] = {};  ///< Partial word.
+  std::size_t pending_size_ = 0;  ///< Bytes in pending_.
+
+  void Mix(std::uint64_t word) { hash_ = (hash_ ^ word) * kPrime; }
+
+  void AddPending(unsigned char byte) {
+    pending_[pending_size_++] = byte;
+    if (pending_size_ == sizeof(std::uint64_t)) {
+      std::uint64_t word;
+      std::memcpy(&word, pending_, sizeof(word));
+      Mix(word);
+      pending_size_ = 0;
+    }
+  }
+};
+
+/**
+ * @brief Gets the checksum a binary file stores in its header: the payload
+ * followed by the header itself with its checksum field zeroed.
+ *
+ * Covering the header keeps edited counts and flags, which the loaders
+ * trust without rescanning the payload, from passing as a valid file.
+ * @param payload The checksum of the payload.
+ * @param header The header; its checksum field is ignored.
+ */
+template <typename Header>
+std::uint64_t BinaryFileChecksum(BinaryChecksum payload, Header header) {
+  header.checksum = 0;
+  payload.Update(&header, sizeof(header));
+  return payload.Value();
+}
+
+/**
+ * @brief Throws the error of a malformed binary file.
+ * @param format The kind of file, e.g. "binary graph".
+ * @throw std::logic_error "Invalid <format> file: <reason>!".
+ */
+[[noreturn]] inline void InvalidBinaryFile(const std::string& format,
+                                           const std::string& reason) {
+  throw std::logic_error("Invalid " + format + " file: " + reason + "!");
+}
+
+/**
+ * @brief Reads the header of a mapped binary file and checks the fields
+ * every format shares: signature, version, byte order and payload size.
+ * @tparam Header The fixed-size header of the format. It must have magic,
+ * version, byte_order and payload_bytes members, with the signature and
+ * current version as defaults.
+ * @throw std::logic_error if a check fails.
+ */
+template <typename Header>
+Header ReadBinaryHeader(const MappedFile& file, const std::string& format) {
+  Header header;
+  if (file.Size() < sizeof(header)) {
+    InvalidBinaryFile(format, "truncated header");
+  }
+  std::memcpy(&header, file.Data(), sizeof(header));
+  const Header current;
+  if (std::memcmp(header.magic, current.magic, sizeof(header.magic)) != 0) {
+    InvalidBinaryFile(format, "bad signature");
+  }
+  if (header.version != current.version) {
+    InvalidBinaryFile(format, "unsupported version");
+  }
+  if (header.byte_order != kBinaryByteOrderMark) {
+    InvalidBinaryFile(format, "foreign byte order");
+  }
+  if (header.payload_bytes != file.Size() - sizeof(header)) {
+    InvalidBinaryFile(format, "truncated payload");
+  }
+  return header;
+}
+
+/**
+ * @brief An output file that replaces its target only once it is complete.
+ *
+ * The bytes go to a temporary file next to the target, which Commit renames
+ * over it. Mappings of the old file, including the one the data being saved
+ * may be borrowed from, keep reading the old contents; truncating the file
+ * in place would make them fault. Each instance creates its own temporary
+ * file, so concurrent saves to one target never share it and the last
+ * Commit wins with a complete file. The temporary file is removed if Commit
+ * is not reached.
+ */
+class ReplacingFile {
+ public:
+  /**
+   * @throw std::runtime_error if the temporary file cannot be created.
+   */
+  explicit ReplacingFile(const std::string& filename);
+
+  ReplacingFile(const ReplacingFile&) = delete;
+  ReplacingFile& operator=(const ReplacingFile&) = delete;
+
+  ~ReplacingFile() {
+    if (committed_) return;
+    stream_.close();
+    std::error_code error;
+    std::filesystem::remove(temporary_, error);
+  }
+
+  /**
+   * @brief Gets the stream to the temporary file.
+   */
+  std::ofstream& Stream() { return stream_; }
+
+  /**
+   * @brief Closes the temporary file and renames it over the target.
+   * @throw std::runtime_error if the file could not be written or renamed.
+   */
+  void Commit() {
+    stream_.close();
+    std::error_code error;
+    if (stream_) std::filesystem::rename(temporary_, filename_, error);
+    if (!stream_ || error) {
+      throw std::runtime_error("Failed to write the file: " + filename_);
+    }
+    committed_ = true;
+  }
+
+ private:
+  std::string filename_;    ///< The file to replace.
+  std::string temporary_;   ///< The file being written.
+  std::ofstream stream_;    ///< Stream to temporary_.
+  bool committed_ = false;  ///< Whether temporary_ was renamed.
+};
+
+/**
+ * @brief Writes the payload of a binary file section by section, keeping
+ * the running checksum, and completes the header at the end.
+ *
+ * The file must start with a placeholder header, rewritten by Finish.
+ */
+class BinarySectionWriter {
+ public:
+  explicit BinarySectionWriter(std::ofstream& file) : file_(file) {}
+
+  /**
+   * @brief Writes bytes followed by zero padding up to kBinaryAlignment.
+   */
+  void Write(const void* data, std::size_t bytes) {
+    static const char kZeros[kBinaryAlignment] = {};
+    file_.write(static_cast<const char*>(data),
+                static_cast<std::streamsize>(bytes));
+    checksum_.Update(data, bytes);
+    std::size_t padding = AlignBinary(bytes) - bytes;
+    file_.write(kZeros, static_cast<std::streamsize>(padding));
+    checksum_.Update(kZeros, padding);
+  }
+
+  /**
+   * @brief Writes the elements of a span as one section.
+   */
+  template <typename T>
+  void Write(std::span<const T> section) {
+    Write(section.data(), section.size_bytes());
+  }
+
+  /**
+   * @brief Sets the payload size and checksum of header (see
+   * BinaryFileChecksum) and rewrites it at the start of the file.
+   * @throw std::runtime_error if the file could not be written.
+   */
+  template <typename Header>
+  void Finish(Header& header, const std::string& filename) {
+    header.payload_bytes =
+        static_cast<std::uint64_t>(file_.tellp()) - sizeof(header);
+    header.checksum = BinaryFileChecksum(checksum_, header);
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!file_) {
+      throw std::runtime_error("Failed to write the file: " + filename);
+    }
+  }
+
+ private:
+  std::ofstream& file_;     ///< The file being written.
+  BinaryChecksum checksum_;  ///< Checksum of the payload so far.
+};
+
+/**
+ * @brief Hands out the aligned sections of a mapped payload in order and
+ * verifies the payload checksum.
+ *
+ * Section sizes come from the file, so they are checked against the
+ * payload without overflowing. A section read with a check is hashed and
+ * checked in chunks that stay in cache, so validating the contents costs
+ * no pass over the file beyond the checksum; other bytes are hashed by
+ * Finish. Sections must not be used before Finish succeeds.
+ */
+class BinarySectionReader {
+ public:
+  /**
+   * @brief Reads the payload of bytes bytes at payload.
+   * @param format The kind of file, for error messages.
+   */
+  BinarySectionReader(const char* payload, std::size_t bytes,
+                      std::string format)
+      : data_(payload), size_(bytes), format_(std::move(format)) {}
+
+  /**
+   * @brief Throws the error of a malformed file of this format.
+   */
+  [[noreturn]] void Fail(const std::string& reason) const {
+    InvalidBinaryFile(format_, reason);
+  }
+
+  /**
+   * @brief Multiplies counts read from the file.
+   * @throw std::logic_error if the product does not fit std::size_t.
+   */
+  std::size_t Multiply(std::uint64_t a, std::uint64_t b) const {
+    if (b != 0 && a > std::numeric_limits<std::size_t>::max() / b) {
+      Fail("section sizes overflow");
+    }
+    return static_cast<std::size_t>(a * b);
+  }
+
+  /**
+   * @brief Gets the bytes after the sections handed out so far.
+   */
+  std::size_t Remaining() const { return size_ - offset_; }
+
+  /**
+   * @brief Takes the next section, count elements of T.
+   * @throw std::logic_error if the section does not fit the payload.
+   */
+  template <typename T>
+  std::span<const T> Next(std::uint64_t count) {
+    if (count > Remaining() / sizeof(T)) {
+      Fail("sections do not fit the payload");
+    }
+    std::span<const T> section{reinterpret_cast<const T*>(data_ + offset_),
+                               static_cast<std::size_t>(count)};
+    offset_ = std::min(offset_ + AlignBinary(section.size_bytes()), size_);
+    return section;
+  }
+
+  /**
+   * @brief Takes the next section and calls check(element) on every
+   * element right after hashing it.
+   * @param check Throws (see Fail) if an element is invalid.
+   */
+  template <typename T, typename Check>
+  std::span<const T> Next(std::uint64_t count, Check&& check) {
+    std::span<const T> section = Next<T>(count);
+    constexpr std::size_t kChunk = kVerifyChunkBytes / sizeof(T);
+    for (std::size_t begin = 0; begin < section.size(); begin += kChunk) {
+      std::span<const T> chunk =
+          section.subspan(begin, std::min(kChunk, section.size() - begin));
+      VerifyUpTo(chunk.data() + chunk.size());
+      for (const T& element : chunk) check(element);
+    }
+    return section;
+  }
+
+  /**
+   * @brief Adds the payload up to position to the checksum, for callers
+   * that check a section piece by piece.
+   * @param position Inside the payload, at or after the last one given.
+   */
+  void VerifyUpTo(const void* position) {
+    const char* end = static_cast<const char*>(position);
+    checksum_.Update(data_ + verified_, end - (data_ + verified_));
+    verified_ = end - data_;
+  }
+
+  /**
+   * @brief Hashes the rest of the payload and the header and compares the
+   * checksum stored in the header (see BinaryFileChecksum).
+   * @throw std::logic_error if they differ.
+   */
+  template <typename Header>
+  void Finish(const Header& header) {
+    VerifyUpTo(data_ + size_);
+    if (BinaryFileChecksum(checksum_, header) != header.checksum) {
+      Fail("checksum mismatch");
+    }
+  }
+
+ private:
+  /// Bytes hashed and checked at a time, well within L2.
+  static constexpr std::size_t kVerifyChunkBytes = 64 * 1024;
+
+  const char* data_;          ///< Start of the payload.
+  std::size_t size_;          ///< Bytes of the payload.
+  std::string format_;        ///< Kind of file, for errors.
+  std::size_t offset_ = 0;    ///< Start of the next section.
+  std::size_t verified_ = 0;  ///< Bytes added to checksum_.
+  BinaryChecksum checksum_;   ///< Checksum of the bytes verified so far.
+};
+
+}  // namespace s21
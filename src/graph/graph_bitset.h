@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "graph_csr.h"
+#include "graph_matrix.h"
+
+namespace s21 {
+
+/**
+ * @brief Adjacency of an unweighted graph with one bit per cell.
+ *
+ * Row i is Stride() 64-bit words, and bit j % 64 of word j / 64 is set if
+ * the edge (i, j) exists. Bits past Size() stay clear, so rows can be
+ * combined word by word with other bitsets over the vertices (see
+ * TakeUnvisited). A cell takes 1/8 of the memory of a uint8 matrix and 1/32
+ * of an int one.
+ *
+ * The words are shared between copies. They are either owned or borrowed
+ * from elsewhere, e.g. from a memory-mapped file (see Borrow), and are copied
+ * before the first change.
+ */
+class BitMatrix {
+ public:
+  using ValueType = std::uint8_t;  ///< Type cells are reported in (0 or 1).
+  using Word = std::uint64_t;      ///< Unit the rows are packed in.
+
+  static constexpr int kWordBits = 64;  ///< Bits (cells) per word.
+
+  /**
+   * @brief Creates an empty matrix.
+   */
+  BitMatrix() = default;
+
+  /**
+   * @brief Creates a size x size matrix without edges.
+   */
+  explicit BitMatrix(int size)
+      : words_(std::make_shared<std::vector<Word>>(
+            static_cast<std::size_t>(std::max(size, 0)) * RowStride(size))),
+        data_(words_->data()),
+        size_(std::max(size, 0)),
+        stride_(RowStride(size)) {}
+
+  /**
+   * @brief Creates a matrix over words owned by someone else.
+   * @param words The first word of row 0; rows are stride words apart.
+   * @param size The number of rows and columns.
+   * @param stride The distance between rows in words (>= RowStride(size)).
+   * @param owner Keeps the words alive for as long as the matrix or any of
+   * its copies refers to them.
+   * @return A matrix that reads the borrowed words without copying them.
+   */
+  static BitMatrix Borrow(const Word* words, int size, std::size_t stride,
+                          std::shared_ptr<const void> owner) {
+    BitMatrix matrix;
+    matrix.data_ = words;
+    matrix.size_ = size;
+    matrix.stride_ = stride;
+    matrix.owner_ = std::move(owner);
+    return matrix;
+  }
+
+  /**
+   * @brief Packs an adjacency matrix; every positive cell becomes a set bit.
+   */
+  template <typename T>
+  static BitMatrix FromDense(const DenseMatrix<T>& matrix) {
+    BitMatrix bits(matrix.Size());
+    for (int i = 0; i < matrix.Size(); ++i) {
+      const T* row = matrix.Row(i);
+      Word* target = bits.MutableRow(i);
+      for (int j = 0; j < matrix.Size(); ++j) {
+        target[j / kWordBits] |= Word{row[j] > 0} << (j % kWordBits);
+      }
+    }
+    return bits;
+  }
+
+  /**
+   * @brief Packs a CSR adjacency; every stored edge becomes a set bit.
+   */
+  template <typename T>
+  static BitMatrix FromCsr(const CsrGraph<T>& csr) {
+    BitMatrix bits(csr.Size());
+    for (int i = 0; i < csr.Size(); ++i) {
+      Word* target = bits.MutableRow(i);
+      for (int j : csr.Neighbors(i)) {
+        target[j / kWordBits] |= Word{1} << (j % kWordBits);
+      }
+    }
+    return bits;
+  }
+
+  /**
+   * @brief Expands the bits into an adjacency matrix of 0/1 cells.
+   * @tparam T The cell type of the matrix.
+   */
+  template <typename T>
+  DenseMatrix<T> Convert() const {
+    DenseMatrix<T> matrix(size_);
+    for (int i = 0; i < size_; ++i) {
+      T* row = matrix.Row(i);
+      ForEachNeighbor(i, [row](int j, ValueType) { row[j] = 1; });
+    }
+    return matrix;
+  }
+
+  /**
+   * @brief Builds the CSR form of the matrix with weight 1 on every edge.
+   */
+  CsrGraph<ValueType> ToCsr() const {
+    typename CsrGraph<ValueType>::Arrays arrays;
+    arrays.offsets.assign(size_ + 1, 0);
+    for (int i = 0; i < size_; ++i) {
+      arrays.offsets[i + 1] = arrays.offsets[i] + Degree(i);
+    }
+    arrays.neighbors.reserve(arrays.offsets[size_]);
+    for (int i = 0; i < size_; ++i) {
+      ForEachNeighbor(
+          i, [&arrays](int j, ValueType) { arrays.neighbors.push_back(j); });
+    }
+    arrays.weights.assign(arrays.offsets[size_], 1);
+    return CsrGraph<ValueType>(std::move(arrays));
+  }
+
+  /**
+   * @brief Gets the number of rows (and columns).
+   */
+  int Size() const { return size_; }
+
+  /**
+   * @brief Gets the distance in words between the starts of two rows.
+   */
+  std::size_t Stride() const { return stride_; }
+
+  /**
+   * @brief Checks whether the words are borrowed rather than owned.
+   */
+  bool IsBorrowed() const { return owner_ != nullptr; }
+
+  /**
+   * @brief Gets the memory taken by the words in bytes.
+   */
+  std::size_t MemoryBytes() const {
+    return static_cast<std::size_t>(size_) * stride_ * sizeof(Word);
+  }
+
+  /**
+   * @brief Gets the first word of row 0.
+   */
+  const Word* Data() const { return data_; }
+
+  /**
+   * @brief Gets the Stride() words of row i.
+   */
+  const Word* Row(int i) const {
+    return data_ + static_cast<std::size_t>(i) * stride_;
+  }
+
+  /**
+   * @brief Gets the number of edges leaving vertex v.
+   */
+  int Degree(int v) const {
+    const Word* row = Row(v);
+    int degree = 0;
+    for (std::size_t w = 0; w < stride_; ++w) {
+      degree += std::popcount(row[w]);
+    }
+    return degree;
+  }
+
+  /**
+   * @brief Gets the number of stored (directed) edges.
+   */
+  std::size_t EdgeCount() const {
+    std::size_t count = 0;
+    for (int i = 0; i < size_; ++i) count += Degree(i);
+    return count;
+  }
+
+  /**
+   * @brief Gets cell (i, j).
+   * @return 1 if the edge exists, 0 otherwise.
+   */
+  ValueType At(int i, int j) const {
+    return (Row(i)[j / kWordBits] >> (j % kWordBits)) & 1;
+  }
+
+  /**
+   * @brief Calls visit(neighbor, 1) for every edge leaving vertex v in
+   * ascending neighbour order.
+   */
+  template <typename Visitor>
+  void ForEachNeighbor(int v, Visitor&& visit) const {
+    const Word* row = Row(v);
+    for (std::size_t w = 0; w < stride_; ++w) {
+      for (Word bits = row[w]; bits != 0; bits &= bits - 1) {
+        visit(static_cast<int>(w * kWordBits + std::countr_zero(bits)),
+              ValueType{1});
+      }
+    }
+  }
+
+  /**
+   * @brief Sets or clears cell (i, j).
+   * @param weight 0 removes the edge, any other value adds it.
+   * @return The previous cell, 0 or 1.
+   */
+  ValueType Set(int i, int j, ValueType weight) {
+    Word& word = MutableRow(i)[j / kWordBits];
+    const Word bit = Word{1} << (j % kWordBits);
+    ValueType previous = (word & bit) != 0;
+    word = weight != 0 ? word | bit : word & ~bit;
+    return previous;
+  }
+
+  /**
+   * @brief Appends a vertex without edges; its id is the old Size().
+   */
+  void AddVertex() {
+    BitMatrix grown(size_ + 1);
+    for (int i = 0; i < size_; ++i) {
+      std::copy(Row(i), Row(i) + RowStride(size_), grown.MutableRow(i));
+    }
+    *this = std::move(grown);
+  }
+
+  /**
+   * @brief Removes vertex v with all its edges. Vertices after v move down
+   * by one id.
+   */
+  void RemoveVertex(int v) {
+    BitMatrix shrunk(size_ - 1);
+    for (int i = 0; i < size_; ++i) {
+      if (i == v) continue;
+      Word* target = shrunk.MutableRow(i < v ? i : i - 1);
+      ForEachNeighbor(i, [target, v](int j, ValueType) {
+        if (j == v) return;
+        if (j > v) --j;
+        target[j / kWordBits] |= Word{1} << (j % kWordBits);
+      });
+    }
+    *this = std::move(shrunk);
+  }
+
+  /**
+   * @brief Gets the number of words that hold a row of size bits.
+   */
+  static std::size_t RowStride(int size) {
+    return size > 0 ? (static_cast<std::size_t>(size) + kWordBits - 1) /
+                          kWordBits
+                    : 0;
+  }
+
+ private:
+  std::shared_ptr<std::vector<Word>> words_;  ///< Owned words, if any.
+  const Word* data_ = nullptr;                ///< Row-major words.
+  std::shared_ptr<const void> owner_;  ///< Keeps borrowed words alive.
+  int size_ = 0;                       ///< Number of rows and columns.
+  std::size_t stride_ = 0;             ///< Words per row.
+
+  /**
+   * @brief Gets row i for writing, copying shared or borrowed words first.
+   */
+  Word* MutableRow(int i) {
+    if (words_ == nullptr || words_.use_count() > 1) {
+      std::size_t stride = RowStride(size_);
+      auto words = std::make_shared<std::vector<Word>>(
+          static_cast<std::size_t>(size_) * stride);
+      for (int r = 0; r < size_; ++r) {
+        std::copy(Row(r), Row(r) + stride, words->data() + r * stride);
+      }
+      words_ = std::move(words);
+      data_ = words_->data();
+      stride_ = stride;
+      owner_.reset();
+    }
+    return words_->data() + static_cast<std::size_t>(i) * stride_;
+  }
+};
+
+/**
+ * @brief Moves the vertices of a row that are still unvisited into found.
+ *
+ * Computes found = row & unvisited and unvisited &= ~row (AND / AND NOT) for
+ * words [begin, end), two words per instruction with SSE2 where available.
+ * @param row An adjacency row (see BitMatrix::Row).
+ * @param unvisited The bitset of unvisited vertices, updated in place.
+ * @param found Receives the newly reached vertices.
+ */
+inline void TakeUnvisited(const BitMatrix::Word* row,
+                          BitMatrix::Word* unvisited, BitMatrix::Word* found,
+                          std::size_t begin, std::size_t end) {
+  std::size_t w = begin;
+#if defined(__SSE2__)
+  for (; w + 2 <= end; w += 2) {
+    __m128i adjacent =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + w));
+    __m128i open =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(unvisited + w));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(found + w),
+                     _mm_and_si128(adjacent, open));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(unvisited + w),
+                     _mm_andnot_si128(adjacent, open));
+  }
+#endif
+  for (; w < end; ++w) {
+    found[w] = row[w] & unvisited[w];
+    unvisited[w] &= ~row[w];
+  }
+}
+
+}  // namespace s21
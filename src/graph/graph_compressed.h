@@ -0,0 +1,372 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "graph_csr.h"
+
+namespace s21 {
+
+/**
+ * @brief Read-only adjacency with delta-encoded, varint-packed rows.
+ *
+ * A row lists the neighbours of a vertex in ascending order as gaps: the
+ * first one relative to the vertex itself (zigzag-encoded, as it may be
+ * smaller), every other one as the distance to the previous neighbour minus
+ * one. Gaps are LEB128 varints, 7 bits per byte, so neighbours with nearby
+ * ids cost one byte instead of four. Each gap is followed by the weight of
+ * its edge, also a varint; if every edge weighs 1 the weights are left out.
+ *
+ * Row i starts at Blocks()[i / kBlockRows] + Rows()[i], a 64-bit base per
+ * kBlockRows rows plus a 32-bit offset per row, which halves the 8 bytes per
+ * vertex of CSR offsets.
+ *
+ * Rows are decoded sequentially while they are iterated (ForEachNeighbor),
+ * which is how traversals read them; At() scans its row. Like CsrGraph the
+ * arrays are shared between copies and can be borrowed from a memory-mapped
+ * file. There are no mutators: convert to CsrGraph to change the graph.
+ */
+class CompressedGraph {
+ public:
+  using ValueType = int;  ///< Type the weights are decoded to.
+
+  static constexpr int kBlockRows = 64;  ///< Rows per 64-bit base offset.
+
+  /**
+   * @brief Owned arrays a graph can be built from.
+   */
+  struct Arrays {
+    std::vector<std::uint64_t> blocks;  ///< Start of every block of rows.
+    std::vector<std::uint32_t> rows;    ///< Row starts within their block.
+    std::vector<std::uint8_t> bytes;    ///< Encoded rows.
+    std::size_t edge_count = 0;         ///< Number of encoded edges.
+    bool unit_weights = true;           ///< Weights are left out.
+  };
+
+  /**
+   * @brief Creates an empty graph.
+   */
+  CompressedGraph() = default;
+
+  /**
+   * @brief Takes ownership of already encoded arrays.
+   */
+  explicit CompressedGraph(Arrays&& arrays)
+      : arrays_(std::make_shared<const Arrays>(std::move(arrays))) {
+    blocks_ = arrays_->blocks;
+    rows_ = arrays_->rows;
+    bytes_ = arrays_->bytes;
+    edge_count_ = arrays_->edge_count;
+    unit_weights_ = arrays_->unit_weights;
+  }
+
+  /**
+   * @brief Creates a graph over encoded arrays owned by someone else.
+   * @param blocks Base offsets, one per kBlockRows rows of Size() + 1.
+   * @param rows Row offsets within the blocks; size V + 1.
+   * @param bytes The encoded rows.
+   * @param edge_count The number of encoded edges.
+   * @param unit_weights True if the weights are left out.
+   * @param owner Keeps the arrays alive for as long as the graph or any of
+   * its copies refers to them.
+   * @return A graph that reads the borrowed arrays without copying them.
+   */
+  static CompressedGraph Borrow(std::span<const std::uint64_t> blocks,
+                                std::span<const std::uint32_t> rows,
+                                std::span<const std::uint8_t> bytes,
+                                std::size_t edge_count, bool unit_weights,
+                                std::shared_ptr<const void> owner) {
+    CompressedGraph graph;
+    graph.blocks_ = blocks;
+    graph.rows_ = rows;
+    graph.bytes_ = bytes;
+    graph.edge_count_ = edge_count;
+    graph.unit_weights_ = unit_weights;
+    graph.owner_ = std::move(owner);
+    return graph;
+  }
+
+  /**
+   * @brief Encodes a CSR adjacency.
+   * @throw std::length_error if kBlockRows rows take more than 4 GiB.
+   */
+  template <typename T>
+  static CompressedGraph FromCsr(const CsrGraph<T>& csr) {
+    Arrays arrays;
+    const int size = csr.Size();
+    arrays.edge_count = csr.EdgeCount();
+    for (T weight : csr.AllWeights()) {
+      if (weight != 1) arrays.unit_weights = false;
+    }
+    arrays.rows.resize(size + 1);
+    arrays.blocks.reserve(size / kBlockRows + 1);
+    for (int v = 0; v <= size; ++v) {
+      if (v % kBlockRows == 0) arrays.blocks.push_back(arrays.bytes.size());
+      std::uint64_t offset = arrays.bytes.size() - arrays.blocks.back();
+      if (offset > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("A block of compressed rows is too large!");
+      }
+      arrays.rows[v] = static_cast<std::uint32_t>(offset);
+      if (v == size) break;
+
+      auto neighbors = csr.Neighbors(v);
+      auto weights = csr.Weights(v);
+      for (std::size_t e = 0; e < neighbors.size(); ++e) {
+        if (e == 0) {
+          std::int64_t gap = std::int64_t{neighbors[0]} - v;
+          WriteVarint(arrays.bytes,
+                      static_cast<std::uint64_t>(gap < 0 ? ~(2 * gap)
+                                                         : 2 * gap));
+        } else {
+          WriteVarint(arrays.bytes, neighbors[e] - neighbors[e - 1] - 1);
+        }
+        if (!arrays.unit_weights) WriteVarint(arrays.bytes, weights[e]);
+      }
+    }
+    arrays.bytes.shrink_to_fit();
+    return CompressedGraph(std::move(arrays));
+  }
+
+  /**
+   * @brief Decodes the graph into CSR form.
+   * @tparam U The weight type; every weight must fit it.
+   */
+  template <typename U>
+  CsrGraph<U> Convert() const {
+    typename CsrGraph<U>::Arrays arrays;
+    arrays.offsets.reserve(Size() + 1);
+    arrays.offsets.push_back(0);
+    arrays.neighbors.reserve(edge_count_);
+    arrays.weights.reserve(edge_count_);
+    for (int v = 0; v < Size(); ++v) {
+      ForEachNeighbor(v, [&arrays](int u, int weight) {
+        arrays.neighbors.push_back(u);
+        arrays.weights.push_back(static_cast<U>(weight));
+      });
+      arrays.offsets.push_back(arrays.neighbors.size());
+    }
+    return CsrGraph<U>(std::move(arrays));
+  }
+
+  /**
+   * @brief Decodes the graph into CSR form with int weights.
+   */
+  CsrGraph<int> ToCsr() const { return Convert<int>(); }
+
+  /**
+   * @brief Checks whether the arrays are borrowed rather than owned.
+   */
+  bool IsBorrowed() const { return owner_ != nullptr; }
+
+  /**
+   * @brief Gets the number of vertices.
+   */
+  int Size() const {
+    return rows_.empty() ? 0 : static_cast<int>(rows_.size() - 1);
+  }
+
+  /**
+   * @brief Gets the number of stored (directed) edges.
+   */
+  std::size_t EdgeCount() const { return edge_count_; }
+
+  /**
+   * @brief Checks whether the weights are left out because all are 1.
+   */
+  bool HasUnitWeights() const { return unit_weights_; }
+
+  /**
+   * @brief Gets the base offsets of the blocks of rows.
+   */
+  std::span<const std::uint64_t> Blocks() const { return blocks_; }
+
+  /**
+   * @brief Gets the row offsets within their blocks (Size() + 1 entries).
+   */
+  std::span<const std::uint32_t> Rows() const { return rows_; }
+
+  /**
+   * @brief Gets the encoded rows.
+   */
+  std::span<const std::uint8_t> Bytes() const { return bytes_; }
+
+  /**
+   * @brief Gets the memory taken by the encoded adjacency in bytes.
+   */
+  std::size_t MemoryBytes() const {
+    return blocks_.size_bytes() + rows_.size_bytes() + bytes_.size_bytes();
+  }
+
+  /**
+   * @brief Gets the weight of edge (i, j) by decoding row i up to j.
+   * @return The weight, or 0 if there is no such edge.
+   */
+  int At(int i, int j) const {
+    int weight = 0;
+    ForEachNeighbor(i, [&weight, j](int u, int w) {
+      if (u == j) weight = w;
+      return u < j;
+    });
+    return weight;
+  }
+
+  /**
+   * @brief Calls visit(neighbor, weight) for every edge leaving vertex v in
+   * ascending neighbour order.
+   *
+   * If visit returns bool, returning false stops the row early.
+   */
+  template <typename Visitor>
+  void ForEachNeighbor(int v, Visitor&& visit) const {
+    const std::uint8_t* pos = bytes_.data() + RowStart(v);
+    const std::uint8_t* end = bytes_.data() + RowStart(v + 1);
+    if (pos == end) return;
+    std::uint64_t first = ReadVarint(pos);
+    // undo the zigzag encoding of the first gap
+    std::int64_t gap = static_cast<std::int64_t>(first >> 1) ^
+                       -static_cast<std::int64_t>(first & 1);
+    int u = static_cast<int>(v + gap);
+    while (true) {
+      int weight = unit_weights_ ? 1 : static_cast<int>(ReadVarint(pos));
+      if constexpr (std::is_same_v<decltype(visit(u, weight)), bool>) {
+        if (!visit(u, weight)) return;
+      } else {
+        visit(u, weight);
+      }
+      if (pos == end) return;
+      u += static_cast<int>(ReadVarint(pos)) + 1;
+    }
+  }
+
+  /**
+   * @brief Checks that rows [first, last) decode safely: every varint ends
+   * inside its row, neighbours are vertices of the graph and weights are in
+   * [min_weight, max_weight] (unit weights are not checked). Used on arrays
+   * read from a file, whose row starts must already be known to ascend
+   * within Bytes().
+   * @param edges Incremented by the number of edges of the rows.
+   * @param self_loops Incremented by the number of edges (v, v).
+   * @return False if a row is malformed.
+   */
+  bool CheckRows(int first, int last, int min_weight, int max_weight,
+                 std::size_t& edges, std::size_t& self_loops) const {
+    const std::int64_t size = Size();
+    for (int v = first; v < last; ++v) {
+      const std::uint8_t* pos = bytes_.data() + RowStart(v);
+      const std::uint8_t* end = bytes_.data() + RowStart(v + 1);
+      std::int64_t u = v;
+      for (bool first_edge = true; pos != end; first_edge = false) {
+        std::uint64_t value = 0;
+        if (!ReadCheckedVarint(pos, end, value)) return false;
+        if (first_edge) {
+          std::int64_t gap = static_cast<std::int64_t>(value >> 1) ^
+                             -static_cast<std::int64_t>(value & 1);
+          if (gap < -u || gap >= size - u) return false;
+          u += gap;
+        } else {
+          if (value >= static_cast<std::uint64_t>(size - u - 1)) return false;
+          u += static_cast<std::int64_t>(value) + 1;
+        }
+        if (!unit_weights_) {
+          if (!ReadCheckedVarint(pos, end, value) ||
+              value < static_cast<std::uint64_t>(min_weight) ||
+              value > static_cast<std::uint64_t>(max_weight)) {
+            return false;
+          }
+        }
+        ++edges;
+        self_loops += u == v;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Not supported; compressed graphs are read-only.
+   * @throw std::logic_error always.
+   */
+  int Set(int, int, int) { ReadOnly(); }
+
+  /**
+   * @brief Not supported; compressed graphs are read-only.
+   * @throw std::logic_error always.
+   */
+  void AddVertex() { ReadOnly(); }
+
+  /**
+   * @brief Not supported; compressed graphs are read-only.
+   * @throw std::logic_error always.
+   */
+  void RemoveVertex(int) { ReadOnly(); }
+
+ private:
+  std::span<const std::uint64_t> blocks_;  ///< Start of every row block.
+  std::span<const std::uint32_t> rows_;    ///< Row starts in their block.
+  std::span<const std::uint8_t> bytes_;    ///< Encoded rows.
+  std::size_t edge_count_ = 0;             ///< Number of encoded edges.
+  bool unit_weights_ = true;               ///< Weights are left out.
+  std::shared_ptr<const Arrays> arrays_;   ///< Owned arrays, if any.
+  std::shared_ptr<const void> owner_;      ///< Keeps borrowed arrays alive.
+
+  /**
+   * @brief Gets the byte offset at which row v starts.
+   */
+  std::size_t RowStart(int v) const {
+    return blocks_[v / kBlockRows] + rows_[v];
+  }
+
+  /**
+   * @brief Appends value as an LEB128 varint.
+   */
+  static void WriteVarint(std::vector<std::uint8_t>& bytes,
+                          std::uint64_t value) {
+    while (value >= 0x80) {
+      bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  /**
+   * @brief Decodes the LEB128 varint at pos and moves past it.
+   */
+  static std::uint64_t ReadVarint(const std::uint8_t*& pos) {
+    std::uint64_t value = *pos++;
+    if (value < 0x80) return value;  // most gaps fit one byte
+    value &= 0x7F;
+    for (int shift = 7;; shift += 7) {
+      std::uint64_t byte = *pos++;
+      value |= (byte & 0x7F) << shift;
+      if (byte < 0x80) return value;
+    }
+  }
+
+  /**
+   * @brief Decodes the varint at pos if it ends before end.
+   * @return False if it does not, or does not fit 64 bits.
+   */
+  static bool ReadCheckedVarint(const std::uint8_t*& pos,
+                                const std::uint8_t* end,
+                                std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; pos != end && shift < 64; shift += 7) {
+      std::uint64_t byte = *pos++;
+      value |= (byte & 0x7F) << shift;
+      if (byte < 0x80) return true;
+    }
+    return false;
+  }
+
+  [[noreturn]] static void ReadOnly() {
+    throw std::logic_error("Compressed graphs are read-only!");
+  }
+};
+
+}  // namespace s21
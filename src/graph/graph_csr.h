@@ -0,0 +1,462 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "graph_matrix.h"
+
+namespace s21 {
+
+/**
+ * @brief Adjacency stored in compressed sparse row (CSR) form.
+ *
+ * The neighbours of vertex v are Neighbors()[Offsets()[v] ..
+ * Offsets()[v + 1]) sorted by id, and Weights() holds the matching edge
+ * weights. Memory is O(V + E) instead of O(V^2), and iterating the neighbours
+ * of a vertex costs O(degree).
+ *
+ * The arrays are shared between copies. They are either owned by the graph
+ * or borrowed from elsewhere, e.g. from a memory-mapped file (see Borrow).
+ * The mutators copy shared or borrowed arrays before their first change.
+ *
+ * @tparam T The edge weight type.
+ */
+template <typename T>
+class CsrGraph {
+ public:
+  using ValueType = T;  ///< The edge weight type.
+
+  /**
+   * @brief Owned arrays a graph can be built from.
+   */
+  struct Arrays {
+    std::vector<std::size_t> offsets;  ///< Start of every row; size V + 1.
+    std::vector<int> neighbors;        ///< Neighbour ids, sorted per row.
+    std::vector<T> weights;            ///< Edge weights, parallel to ids.
+  };
+
+  /**
+   * @brief A directed edge used to build a graph from an edge list.
+   */
+  struct Edge {
+    int from;  ///< Source vertex.
+    int to;    ///< Destination vertex.
+    T weight;  ///< Edge weight (positive).
+  };
+
+  /**
+   * @brief Creates an empty graph.
+   */
+  CsrGraph() = default;
+
+  /**
+   * @brief Takes ownership of already built CSR arrays.
+   * @param arrays Offsets, neighbour ids (sorted per row) and weights.
+   */
+  explicit CsrGraph(Arrays&& arrays)
+      : arrays_(std::make_shared<Arrays>(std::move(arrays))) {
+    Attach();
+  }
+
+  /**
+   * @brief Creates a graph over arrays owned by someone else.
+   * @param offsets Start of every row; size V + 1.
+   * @param neighbors Neighbour ids, sorted per row.
+   * @param weights Edge weights, parallel to neighbors.
+   * @param owner Keeps the arrays alive for as long as the graph or any of
+   * its copies refers to them.
+   * @return A graph that reads the borrowed arrays without copying them.
+   */
+  static CsrGraph Borrow(std::span<const std::size_t> offsets,
+                         std::span<const int> neighbors,
+                         std::span<const T> weights,
+                         std::shared_ptr<const void> owner) {
+    CsrGraph csr;
+    csr.offsets_ = offsets;
+    csr.neighbors_ = neighbors;
+    csr.weights_ = weights;
+    csr.owner_ = std::move(owner);
+    csr.borrowed_ = true;
+    return csr;
+  }
+
+  /**
+   * @brief Builds the CSR form of an adjacency matrix.
+   * @param matrix The matrix; every positive cell becomes an edge.
+   * @return The compressed graph.
+   */
+  static CsrGraph FromDense(const DenseMatrix<T>& matrix) {
+    Arrays arrays;
+    const int size = matrix.Size();
+    arrays.offsets.assign(size + 1, 0);
+    for (int i = 0; i < size; ++i) {
+      const T* row = matrix.Row(i);
+      std::size_t degree = 0;
+      for (int j = 0; j < size; ++j) {
+        degree += row[j] > 0;
+      }
+      arrays.offsets[i + 1] = arrays.offsets[i] + degree;
+    }
+    arrays.neighbors.resize(arrays.offsets[size]);
+    arrays.weights.resize(arrays.offsets[size]);
+    for (int i = 0; i < size; ++i) {
+      const T* row = matrix.Row(i);
+      std::size_t pos = arrays.offsets[i];
+      for (int j = 0; j < size; ++j) {
+        if (row[j] > 0) {
+          arrays.neighbors[pos] = j;
+          arrays.weights[pos] = row[j];
+          ++pos;
+        }
+      }
+    }
+    return CsrGraph(std::move(arrays));
+  }
+
+  /**
+   * @brief Builds a graph from an unordered list of edges.
+   *
+   * Every row is sorted by neighbour id. Of parallel edges the lightest one
+   * is kept.
+   * @param size The number of vertices; all ids must be below it.
+   * @param edges The edges in any order.
+   * @return The compressed graph.
+   */
+  static CsrGraph FromEdges(int size, std::span<const Edge> edges) {
+    return FromEdgeStream([size, edges](auto&& emit) {
+      for (const Edge& edge : edges) emit(edge.from, edge.to, edge.weight);
+      return size;
+    });
+  }
+
+  /**
+   * @brief Builds a graph from edges that are produced twice, without
+   * holding them in a list.
+   *
+   * The first pass counts the edges of every source, the second writes each
+   * edge straight into its row. The rows are then sorted by neighbour id in
+   * place, and of parallel edges the lightest one is kept. Besides the CSR
+   * arrays only the largest row is buffered.
+   * @param edges Called as edges(emit) once per pass. It must call
+   * emit(from, to, weight) for the same edges in both passes and return the
+   * number of vertices, which must be above every id.
+   * @return The compressed graph.
+   */
+  template <typename EdgeSource>
+  static CsrGraph FromEdgeStream(EdgeSource&& edges) {
+    Arrays arrays;
+    // offsets[v + 1] counts the edges of v until the prefix sum; the vertex
+    // count is only known once the first pass is over
+    std::size_t edge_count = 0;
+    const int vertices = edges([&](int from, int /*to*/, T) {
+      auto needed = static_cast<std::size_t>(from) + 2;
+      if (arrays.offsets.size() < needed) arrays.offsets.resize(needed, 0);
+      ++arrays.offsets[from + 1];
+      ++edge_count;
+    });
+    arrays.offsets.resize(static_cast<std::size_t>(vertices) + 1, 0);
+
+    // offsets[v + 1] starts at the first slot of v, so once the row is
+    // filled it holds the first slot of v + 1
+    std::size_t row_start = 0;
+    for (int v = 0; v < vertices; ++v) {
+      std::size_t degree = arrays.offsets[v + 1];
+      arrays.offsets[v + 1] = row_start;
+      row_start += degree;
+    }
+    arrays.neighbors.resize(edge_count);
+    arrays.weights.resize(edge_count);
+    edges([&](int from, int to, T weight) {
+      std::size_t pos = arrays.offsets[from + 1]++;
+      arrays.neighbors[pos] = to;
+      arrays.weights[pos] = weight;
+    });
+
+    std::vector<std::pair<int, T>> row;
+    std::size_t kept = 0;
+    for (int v = 0; v < vertices; ++v) {
+      const std::size_t first = arrays.offsets[v];
+      const std::size_t last = arrays.offsets[v + 1];
+      row.clear();
+      for (std::size_t pos = first; pos < last; ++pos) {
+        row.emplace_back(arrays.neighbors[pos], arrays.weights[pos]);
+      }
+      std::sort(row.begin(), row.end());
+      arrays.offsets[v] = kept;
+      for (auto it = row.begin(); it != row.end(); ++it) {
+        // sorted by weight too, so the first of equal ids is the lightest
+        if (it != row.begin() && it->first == (it - 1)->first) continue;
+        arrays.neighbors[kept] = it->first;
+        arrays.weights[kept] = it->second;
+        ++kept;
+      }
+    }
+    arrays.offsets[vertices] = kept;
+    arrays.neighbors.resize(kept);
+    arrays.weights.resize(kept);
+    return CsrGraph(std::move(arrays));
+  }
+
+  /**
+   * @brief Expands the graph back into an adjacency matrix.
+   */
+  DenseMatrix<T> ToDense() const {
+    DenseMatrix<T> matrix(Size());
+    for (int i = 0; i < Size(); ++i) {
+      T* row = matrix.Row(i);
+      ForEachNeighbor(i, [row](int j, T weight) { row[j] = weight; });
+    }
+    return matrix;
+  }
+
+  /**
+   * @brief Copies the graph with another weight type.
+   * @tparam U The new weight type; every weight must fit it.
+   */
+  template <typename U>
+  CsrGraph<U> Convert() const {
+    typename CsrGraph<U>::Arrays arrays;
+    arrays.offsets.assign(offsets_.begin(), offsets_.end());
+    arrays.neighbors.assign(neighbors_.begin(), neighbors_.end());
+    arrays.weights.assign(weights_.begin(), weights_.end());
+    return CsrGraph<U>(std::move(arrays));
+  }
+
+  /**
+   * @brief Builds the graph with every edge reversed.
+   *
+   * A counting sort by target in O(V + E); rows come out sorted because
+   * the sources are visited in ascending order.
+   */
+  CsrGraph Transpose() const {
+    const int size = Size();
+    Arrays arrays;
+    arrays.offsets.assign(size + 1, 0);
+    for (int j : neighbors_) ++arrays.offsets[j + 1];
+    for (int i = 0; i < size; ++i) {
+      arrays.offsets[i + 1] += arrays.offsets[i];
+    }
+    arrays.neighbors.resize(neighbors_.size());
+    arrays.weights.resize(neighbors_.size());
+    std::vector<std::size_t> fill(arrays.offsets.begin(),
+                                  arrays.offsets.end() - 1);
+    for (int i = 0; i < size; ++i) {
+      for (std::size_t e = offsets_[i]; e < offsets_[i + 1]; ++e) {
+        std::size_t pos = fill[neighbors_[e]]++;
+        arrays.neighbors[pos] = i;
+        arrays.weights[pos] = weights_[e];
+      }
+    }
+    return CsrGraph(std::move(arrays));
+  }
+
+  /**
+   * @brief Checks whether the arrays are borrowed rather than owned.
+   */
+  bool IsBorrowed() const { return borrowed_; }
+
+  /**
+   * @brief Gets the number of vertices.
+   */
+  int Size() const {
+    return offsets_.empty() ? 0 : static_cast<int>(offsets_.size() - 1);
+  }
+
+  /**
+   * @brief Gets the number of stored (directed) edges.
+   */
+  std::size_t EdgeCount() const { return neighbors_.size(); }
+
+  /**
+   * @brief Gets the number of edges leaving vertex v.
+   */
+  int Degree(int v) const {
+    return static_cast<int>(offsets_[v + 1] - offsets_[v]);
+  }
+
+  /**
+   * @brief Gets the sorted ids of the neighbours of vertex v.
+   */
+  std::span<const int> Neighbors(int v) const {
+    return neighbors_.subspan(offsets_[v], offsets_[v + 1] - offsets_[v]);
+  }
+
+  /**
+   * @brief Gets the weights of the edges leaving vertex v, in the order of
+   * Neighbors(v).
+   */
+  std::span<const T> Weights(int v) const {
+    return weights_.subspan(offsets_[v], offsets_[v + 1] - offsets_[v]);
+  }
+
+  /**
+   * @brief Gets the row offsets array (Size() + 1 entries).
+   */
+  std::span<const std::size_t> Offsets() const { return offsets_; }
+
+  /**
+   * @brief Gets the neighbour ids of all rows.
+   */
+  std::span<const int> AllNeighbors() const { return neighbors_; }
+
+  /**
+   * @brief Gets the weights of all edges.
+   */
+  std::span<const T> AllWeights() const { return weights_; }
+
+  /**
+   * @brief Gets the memory taken by the arrays in bytes.
+   */
+  std::size_t MemoryBytes() const {
+    return offsets_.size_bytes() + neighbors_.size_bytes() +
+           weights_.size_bytes();
+  }
+
+  /**
+   * @brief Gets the weight of edge (i, j) by binary search in row i.
+   * @return The weight, or 0 if there is no such edge.
+   */
+  T At(int i, int j) const {
+    auto first = neighbors_.begin() + offsets_[i];
+    auto last = neighbors_.begin() + offsets_[i + 1];
+    auto it = std::lower_bound(first, last, j);
+    if (it == last || *it != j) return T{};
+    return weights_[it - neighbors_.begin()];
+  }
+
+  /**
+   * @brief Calls visit(neighbor, weight) for every edge leaving vertex v in
+   * ascending neighbour order.
+   */
+  template <typename Visitor>
+  void ForEachNeighbor(int v, Visitor&& visit) const {
+    for (std::size_t e = offsets_[v]; e < offsets_[v + 1]; ++e) {
+      visit(neighbors_[e], weights_[e]);
+    }
+  }
+
+  /**
+   * @brief Sets the weight of edge (i, j), inserting or removing the edge.
+   *
+   * Changing the weight of an existing edge costs O(log degree); inserting
+   * or removing an edge shifts the arrays behind it, O(V + E).
+   * @param weight The new weight; 0 removes the edge.
+   * @return The previous weight, 0 if there was no edge.
+   */
+  T Set(int i, int j, T weight) {
+    MakeUnique();
+    auto first = arrays_->neighbors.begin() + arrays_->offsets[i];
+    auto last = arrays_->neighbors.begin() + arrays_->offsets[i + 1];
+    auto it = std::lower_bound(first, last, j);
+    std::size_t e = it - arrays_->neighbors.begin();
+    T previous{};
+    if (it != last && *it == j) {
+      previous = arrays_->weights[e];
+      if (weight != T{}) {
+        arrays_->weights[e] = weight;
+        return previous;
+      }
+      arrays_->neighbors.erase(it);
+      arrays_->weights.erase(arrays_->weights.begin() + e);
+      for (std::size_t v = i + 1; v < arrays_->offsets.size(); ++v) {
+        --arrays_->offsets[v];
+      }
+    } else if (weight != T{}) {
+      arrays_->neighbors.insert(it, j);
+      arrays_->weights.insert(arrays_->weights.begin() + e, weight);
+      for (std::size_t v = i + 1; v < arrays_->offsets.size(); ++v) {
+        ++arrays_->offsets[v];
+      }
+    }
+    Attach();
+    return previous;
+  }
+
+  /**
+   * @brief Appends a vertex without edges; its id is the old Size().
+   */
+  void AddVertex() {
+    MakeUnique();
+    if (arrays_->offsets.empty()) arrays_->offsets.push_back(0);
+    arrays_->offsets.push_back(arrays_->offsets.back());
+    Attach();
+  }
+
+  /**
+   * @brief Removes vertex v with all its edges in O(V + E). Vertices after v
+   * move down by one id.
+   */
+  void RemoveVertex(int v) {
+    MakeUnique();
+    Arrays& arrays = *arrays_;
+    std::size_t kept = 0;
+    std::size_t row_start = 0;
+    for (int i = 0; i < Size(); ++i) {
+      std::size_t begin = arrays.offsets[i];
+      std::size_t end = arrays.offsets[i + 1];
+      if (i != v) {
+        arrays.offsets[i < v ? i : i - 1] = row_start;
+        for (std::size_t e = begin; e < end; ++e) {
+          int u = arrays.neighbors[e];
+          if (u == v) continue;
+          arrays.neighbors[kept] = u > v ? u - 1 : u;
+          arrays.weights[kept] = arrays.weights[e];
+          ++kept;
+        }
+        row_start = kept;
+      }
+    }
+    arrays.offsets.pop_back();
+    arrays.offsets.back() = kept;
+    arrays.neighbors.resize(kept);
+    arrays.weights.resize(kept);
+    Attach();
+  }
+
+ private:
+  std::span<const std::size_t> offsets_;  ///< Start of every row; V + 1.
+  std::span<const int> neighbors_;        ///< Neighbour ids, sorted per row.
+  std::span<const T> weights_;            ///< Edge weights, parallel to ids.
+  std::shared_ptr<Arrays> arrays_;        ///< Owned arrays, if any.
+  std::shared_ptr<const void> owner_;     ///< Keeps borrowed arrays alive.
+  bool borrowed_ = false;                 ///< Arrays live in owner_.
+
+  /**
+   * @brief Points the spans at the owned arrays.
+   */
+  void Attach() {
+    offsets_ = arrays_->offsets;
+    neighbors_ = arrays_->neighbors;
+    weights_ = arrays_->weights;
+  }
+
+  /**
+   * @brief Gives the graph its own copy of the arrays before a change.
+   */
+  void MakeUnique() {
+    if (arrays_ != nullptr && arrays_.use_count() == 1) return;
+    Arrays arrays;
+    arrays.offsets.assign(offsets_.begin(), offsets_.end());
+    arrays.neighbors.assign(neighbors_.begin(), neighbors_.end());
+    arrays.weights.assign(weights_.begin(), weights_.end());
+    arrays_ = std::make_shared<Arrays>(std::move(arrays));
+    owner_.reset();
+    borrowed_ = false;
+    Attach();
+  }
+};
+
+/**
+ * @brief True for CsrGraph types, so code generic over adjacency storage can
+ * use their sorted rows.
+ */
+template <typename Storage>
+inline constexpr bool kIsCsrGraph = false;
+template <typename T>
+inline constexpr bool kIsCsrGraph<CsrGraph<T>> = true;
+
+}  // namespace s21
@@ -0,0 +1,97 @@
+#include "graph.h"
+
+#include <algorithm>
+#include <string_view>
+
+void s21_graph::LoadFromEdgeList(std::string& filename) {
+  auto start = std::chrono::steady_clock::now();
+  s21::MappedFile file(filename, true);
+  s21::MatrixTextParser parser(file.Data(), file.Data() + file.Size());
+  parser.NameLines();
+
+  if (!parser.NextRow()) {
+    throw std::logic_error("The file is empty or contains only empty lines!");
+  }
+
+  // optional declaration line: "directed" or "undirected" [vertex count]
+  enum class Direction { kInferred, kDirected, kUndirected };
+  Direction direction = Direction::kInferred;
+  int size = 0;
+  bool fixed_size = false;
+  if (parser.AtWord()) {
+    std::string_view word = parser.ParseWord();
+    if (word == "directed") {
+      direction = Direction::kDirected;
+    } else if (word == "undirected") {
+      direction = Direction::kUndirected;
+    } else {
+      parser.Fail<std::invalid_argument>("Unknown edge list declaration!");
+    }
+    fixed_size = parser.ParseVertexCount(size);
+    int extra = 0;
+    if (fixed_size && parser.ParseValues(&extra, 0) > 0) {
+      parser.Fail<std::logic_error>("Invalid edge list declaration!");
+    }
+    parser.EndRow();
+  }
+
+  // the edges are read twice, once to count the row lengths and once to
+  // fill the rows, so no edge list is held besides the CSR arrays; the
+  // second pass meets the lines the first one already checked
+  const s21::MatrixTextParser body = parser;
+  // a file of n bytes names at most about n / 2 vertices, so larger ids
+  // mostly add isolated ones and need a declared count
+  const std::size_t max_inferred_id =
+      std::max(kMaxInferredVertices, file.Size());
+  graph_ = SparseGraphData::FromEdgeStream([&](auto&& emit) {
+    s21::MatrixTextParser reader = body;
+    int vertices = fixed_size ? size : 0;
+    while (reader.NextRow()) {
+      // ids and weight are read apart, so each error names what is wrong
+      int source = 0;
+      int destination = 0;
+      int weight = 1;
+      if (!reader.ParseVertexId(source) ||
+          !reader.ParseVertexId(destination) ||
+          reader.ParseValues(&weight, 1) > 1) {
+        reader.Fail<std::logic_error>(
+            "An edge must be \"source destination [weight]\"!");
+      }
+      if (source == 0 || destination == 0) {
+        reader.Fail<std::logic_error>("Vertex ids start at 1!");
+      }
+      if (fixed_size && (source > size || destination > size)) {
+        reader.Fail<std::logic_error>("Vertex id is out of range!");
+      }
+      if (!fixed_size && static_cast<std::size_t>(std::max(
+                             source, destination)) > max_inferred_id) {
+        reader.Fail<std::out_of_range>("Vertex id is out of range!");
+      }
+      reader.EndRow();
+      if (!fixed_size) vertices = std::max({vertices, source, destination});
+
+      if (weight == 0) continue;
+      emit(source - 1, destination - 1, weight);
+      if (direction == Direction::kUndirected && source != destination) {
+        emit(destination - 1, source - 1, weight);
+      }
+    }
+    return vertices;
+  });
+  // the type needs the symmetry of the final rows, after parallel edges
+  // are merged, so it is derived from the built graph in O(V + E)
+  ComputeMetadata();
+  FitWeights(metadata_.max_weight);
+  // undirected edges were added both ways, so only "directed" needs to be
+  // remembered to tell a declared type from an inferred one
+  directed_declared_ = direction == Direction::kDirected;
+  ParseType();
+  OrderLoadedGraph();
+
+  version_ = NextVersion();
+  load_stats_.bytes = file.Size();
+  load_stats_.milliseconds =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+}
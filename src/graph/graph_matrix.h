@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+
+namespace s21 {
+
+/**
+ * @brief Size of a cache line in bytes; rows of DenseMatrix start on it.
+ */
+inline constexpr std::size_t kCacheLineSize = 64;
+
+/**
+ * @brief Non-owning view of a square row-major matrix with padded rows.
+ *
+ * Plays the role of a std::mdspan with a strided layout (C++23): it is a
+ * pointer, a size and a stride, so it is cheap to copy and never copies
+ * cells. The viewed cells must outlive the view.
+ *
+ * @tparam T The cell type; const T for a read-only view.
+ */
+template <typename T>
+class MatrixView {
+ public:
+  /**
+   * @brief Creates an empty view.
+   */
+  MatrixView() = default;
+
+  /**
+   * @brief Creates a view over size x size cells.
+   * @param data The first cell.
+   * @param size The number of rows and columns.
+   * @param stride The distance between rows in elements (>= size).
+   */
+  MatrixView(T* data, int size, std::size_t stride)
+      : data_(data), size_(size), stride_(stride) {}
+
+  /**
+   * @brief Gets the number of rows (and columns).
+   */
+  int Size() const { return size_; }
+
+  /**
+   * @brief Gets the distance in elements between the starts of two rows.
+   */
+  std::size_t Stride() const { return stride_; }
+
+  /**
+   * @brief Gets a pointer to the first cell.
+   */
+  T* Data() const { return data_; }
+
+  /**
+   * @brief Gets the Size() cells of row i.
+   */
+  std::span<T> Row(int i) const {
+    return {data_ + static_cast<std::size_t>(i) * stride_,
+            static_cast<std::size_t>(size_)};
+  }
+
+  /**
+   * @brief Accesses the cell in row i and column j.
+   */
+  T& operator()(int i, int j) const {
+    return data_[static_cast<std::size_t>(i) * stride_ + j];
+  }
+
+ private:
+  T* data_ = nullptr;       ///< First cell.
+  int size_ = 0;            ///< Number of rows and columns.
+  std::size_t stride_ = 0;  ///< Elements between row starts.
+};
+
+/**
+ * @brief Square matrix stored in a single contiguous, cache-line-aligned
+ * buffer in row-major order.
+ *
+ * Every row is padded to a whole number of cache lines, so row i starts at
+ * Data() + i * Stride() and is itself cache-line aligned. Padding cells are
+ * zero-initialized, which means "no edge" for adjacency data and lets vector
+ * kernels process full lines without a scalar tail.
+ *
+ * A matrix can also borrow read-only cells that live elsewhere, e.g. in a
+ * memory-mapped file (see Borrow). Borrowed cells are shared by copies and
+ * are copied into an owned buffer on the first non-const access.
+ *
+ * @tparam T The cell type (edge weight or distance).
+ */
+template <typename T>
+class DenseMatrix {
+ public:
+  using ValueType = T;  ///< The cell type.
+
+  /**
+   * @brief Creates an empty matrix.
+   */
+  DenseMatrix() = default;
+
+  /**
+   * @brief Creates a size x size matrix filled with value.
+   * @param size The number of rows and columns.
+   * @param value The initial value of every cell (padding stays zero).
+   */
+  explicit DenseMatrix(int size, T value = T{})
+      : size_(size), stride_(RowStride(size)) {
+    if (size_ <= 0) {
+      size_ = 0;
+      stride_ = 0;
+      return;
+    }
+    buffer_.reset(Allocate(Cells()));
+    cells_ = buffer_.get();
+    for (int i = 0; i < size_; ++i) {
+      std::fill(Row(i), Row(i) + size_, value);
+    }
+  }
+
+  /**
+   * @brief Creates a matrix over cells owned by someone else.
+   * @param cells The first cell; rows are stride elements apart.
+   * @param size The number of rows and columns.
+   * @param stride The distance between rows in elements (>= size).
+   * @param owner Keeps the cells alive for as long as the matrix or any of
+   * its copies refers to them.
+   * @return A matrix that reads the borrowed cells without copying them.
+   */
+  static DenseMatrix Borrow(const T* cells, int size, std::size_t stride,
+                            std::shared_ptr<const void> owner) {
+    DenseMatrix matrix;
+    matrix.cells_ = const_cast<T*>(cells);
+    matrix.size_ = size;
+    matrix.stride_ = stride;
+    matrix.owner_ = std::move(owner);
+    return matrix;
+  }
+
+  DenseMatrix(const DenseMatrix& other)
+      : cells_(other.cells_),
+        owner_(other.owner_),
+        size_(other.size_),
+        stride_(other.stride_) {
+    if (other.buffer_) {
+      buffer_.reset(Allocate(Cells()));
+      std::copy(other.cells_, other.cells_ + Cells(), buffer_.get());
+      cells_ = buffer_.get();
+    }
+  }
+
+  DenseMatrix(DenseMatrix&& other) noexcept
+      : buffer_(std::move(other.buffer_)),
+        cells_(other.cells_),
+        owner_(std::move(other.owner_)),
+        size_(other.size_),
+        stride_(other.stride_) {
+    other.cells_ = nullptr;
+    other.size_ = 0;
+    other.stride_ = 0;
+  }
+
+  DenseMatrix& operator=(const DenseMatrix& other) {
+    if (this != &other) {
+      DenseMatrix copy(other);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  DenseMatrix& operator=(DenseMatrix&& other) noexcept {
+    if (this != &other) {
+      buffer_ = std::move(other.buffer_);
+      cells_ = other.cells_;
+      owner_ = std::move(other.owner_);
+      size_ = other.size_;
+      stride_ = other.stride_;
+      other.cells_ = nullptr;
+      other.size_ = 0;
+      other.stride_ = 0;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Gets the number of rows (and columns).
+   */
+  int Size() const { return size_; }
+
+  /**
+   * @brief Gets the distance in elements between the starts of two rows.
+   */
+  std::size_t Stride() const { return stride_; }
+
+  /**
+   * @brief Checks whether the matrix has no cells.
+   */
+  bool Empty() const { return size_ == 0; }
+
+  /**
+   * @brief Checks whether the cells are borrowed rather than owned.
+   */
+  bool IsBorrowed() const { return owner_ != nullptr; }
+
+  /**
+   * @brief Gets the memory taken by the cells, including padding, in bytes.
+   */
+  std::size_t MemoryBytes() const { return Cells() * sizeof(T); }
+
+  /**
+   * @brief Gets a pointer to the first cell of the buffer.
+   */
+  T* Data() {
+    MakeOwned();
+    return cells_;
+  }
+  const T* Data() const { return cells_; }
+
+  /**
+   * @brief Gets a pointer to the first cell of row i.
+   */
+  T* Row(int i) {
+    MakeOwned();
+    return cells_ + static_cast<std::size_t>(i) * stride_;
+  }
+  const T* Row(int i) const {
+    return cells_ + static_cast<std::size_t>(i) * stride_;
+  }
+
+  /**
+   * @brief Accesses the cell in row i and column j.
+   */
+  T& operator()(int i, int j) { return Row(i)[j]; }
+  const T& operator()(int i, int j) const { return Row(i)[j]; }
+
+  /**
+   * @brief Gets a view of the whole matrix.
+   */
+  MatrixView<T> View() {
+    MakeOwned();
+    return {cells_, size_, stride_};
+  }
+  MatrixView<const T> View() const { return {cells_, size_, stride_}; }
+
+  /**
+   * @brief Copies the matrix into one with another cell type.
+   * @tparam U The new cell type; every value must fit it.
+   */
+  template <typename U>
+  DenseMatrix<U> Convert() const {
+    DenseMatrix<U> matrix(size_);
+    for (int i = 0; i < size_; ++i) {
+      std::copy(Row(i), Row(i) + size_, matrix.Row(i));
+    }
+    return matrix;
+  }
+
+  /**
+   * @brief Rounds a row of size cells up to a whole number of cache lines.
+   * @return The row stride in elements used by owned matrices.
+   */
+  static std::size_t RowStride(int size) {
+    constexpr std::size_t kPerLine =
+        kCacheLineSize / sizeof(T) > 0 ? kCacheLineSize / sizeof(T) : 1;
+    std::size_t cells = size > 0 ? static_cast<std::size_t>(size) : 0;
+    return (cells + kPerLine - 1) / kPerLine * kPerLine;
+  }
+
+ private:
+  /**
+   * @brief Frees buffers obtained from Allocate.
+   */
+  struct AlignedDelete {
+    void operator()(T* ptr) const {
+      ::operator delete[](ptr, std::align_val_t{kCacheLineSize});
+    }
+  };
+
+  std::unique_ptr<T[], AlignedDelete> buffer_;  ///< Owned cells, if any.
+  T* cells_ = nullptr;                          ///< Row-major cells.
+  std::shared_ptr<const void> owner_;  ///< Keeps borrowed cells alive.
+  int size_ = 0;                       ///< Number of rows and columns.
+  std::size_t stride_ = 0;             ///< Elements per padded row.
+
+  /**
+   * @brief Total number of cells including row padding.
+   */
+  std::size_t Cells() const {
+    return static_cast<std::size_t>(size_) * stride_;
+  }
+
+  /**
+   * @brief Copies borrowed cells into an owned buffer before a write.
+   */
+  void MakeOwned() {
+    if (owner_ == nullptr) return;
+    std::size_t stride = RowStride(size_);
+    buffer_.reset(Allocate(static_cast<std::size_t>(size_) * stride));
+    for (int i = 0; i < size_; ++i) {
+      const T* row = cells_ + static_cast<std::size_t>(i) * stride_;
+      std::copy(row, row + size_, buffer_.get() + i * stride);
+    }
+    cells_ = buffer_.get();
+    stride_ = stride;
+    owner_.reset();
+  }
+
+  /**
+   * @brief Allocates a zeroed, cache-line-aligned buffer of count cells.
+   */
+  static T* Allocate(std::size_t count) {
+    T* ptr = static_cast<T*>(
+        ::operator new[](count * sizeof(T), std::align_val_t{kCacheLineSize}));
+    std::uninitialized_fill(ptr, ptr + count, T{});
+    return ptr;
+  }
+};
+
+/**
+ * @brief True for DenseMatrix types, so code generic over adjacency storage
+ * can tell matrices from sparse formats.
+ */
+template <typename Storage>
+inline constexpr bool kIsDenseMatrix = false;
+template <typename T>
+inline constexpr bool kIsDenseMatrix<DenseMatrix<T>> = true;
+
+}  // namespace s21
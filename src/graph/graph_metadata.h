@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @brief Summary of a graph's edges, collected while it is loaded.
+ *
+ * Lets algorithms check preconditions (connectivity, symmetry, weights) in
+ * O(1) instead of scanning the adjacency again.
+ */
+struct GraphMetadata {
+  int vertex_count = 0;              ///< Number of vertices.
+  std::size_t edge_count = 0;        ///< Stored (directed) edges.
+  double density = 0;                ///< edge_count / vertex_count^2.
+  int min_weight = 0;                ///< Lightest edge, 0 without edges.
+  int max_weight = 0;                ///< Heaviest edge, 0 without edges.
+  std::size_t self_loops = 0;        ///< Edges (v, v).
+  std::size_t asymmetric_pairs = 0;  ///< Pairs with w(i, j) != w(j, i).
+  int components = 0;                ///< Weakly connected components.
+
+  /**
+   * @brief Checks whether w(i, j) == w(j, i) for all pairs.
+   */
+  bool IsSymmetric() const { return asymmetric_pairs == 0; }
+
+  /**
+   * @brief Checks whether any edge weighs more than 1.
+   */
+  bool IsWeighted() const { return max_weight > 1; }
+
+  /**
+   * @brief Checks whether all vertices are in one component, ignoring edge
+   * directions.
+   */
+  bool IsConnected() const { return components <= 1; }
+
+  /**
+   * @brief Checks whether every vertex has an edge to every other vertex.
+   */
+  bool IsComplete() const {
+    std::size_t size = static_cast<std::size_t>(vertex_count);
+    return edge_count - self_loops == size * (size - (size > 0));
+  }
+};
+
+/**
+ * @brief Union-find over vertices 0..size-1 with path halving.
+ */
+class DisjointSets {
+ public:
+  /**
+   * @brief Creates size singleton sets.
+   */
+  explicit DisjointSets(int size = 0) : parent_(size), count_(size) {
+    std::iota(parent_.begin(), parent_.end(), 0);
+  }
+
+  /**
+   * @brief Gets the representative of the set containing v.
+   */
+  int Find(int v) {
+    while (parent_[v] != v) {
+      parent_[v] = parent_[parent_[v]];
+      v = parent_[v];
+    }
+    return v;
+  }
+
+  /**
+   * @brief Merges the sets containing a and b.
+   * @return True if they were different sets.
+   */
+  bool Unite(int a, int b) {
+    a = Find(a);
+    b = Find(b);
+    if (a == b) return false;
+    // the smaller id becomes the root, so results do not depend on the order
+    // of the calls
+    parent_[std::max(a, b)] = std::min(a, b);
+    --count_;
+    return true;
+  }
+
+  /**
+   * @brief Appends a singleton set.
+   * @return The new element.
+   */
+  int Add() {
+    parent_.push_back(static_cast<int>(parent_.size()));
+    ++count_;
+    return parent_.back();
+  }
+
+  /**
+   * @brief Gets the number of disjoint sets.
+   */
+  int Count() const { return count_; }
+
+ private:
+  std::vector<int> parent_;  ///< Parent of every vertex; roots point to self.
+  int count_;                ///< Number of sets.
+};
+
+/**
+ * @brief Accumulates GraphMetadata from edges reported in any order.
+ *
+ * Several builders can collect disjoint parts of a graph concurrently and be
+ * merged afterwards. Symmetry needs both directions of a pair, so it is
+ * reported separately (AddAsymmetricPairs).
+ */
+class MetadataBuilder {
+ public:
+  /**
+   * @brief Creates a builder for a graph with size vertices.
+   */
+  explicit MetadataBuilder(int size = 0) : size_(size), components_(size) {}
+
+  /**
+   * @brief Records the edge (from, to) of positive weight.
+   */
+  void AddEdge(int from, int to, int weight) {
+    ++edges_;
+    min_weight_ = edges_ == 1 ? weight : std::min(min_weight_, weight);
+    max_weight_ = std::max(max_weight_, weight);
+    if (from == to) {
+      ++self_loops_;
+    } else {
+      components_.Unite(from, to);
+    }
+  }
+
+  /**
+   * @brief Records every positive cell of a matrix row as an edge.
+   * @param from The row index (source vertex).
+   * @param row The size weights of the row.
+   * @param size The number of columns.
+   */
+  void AddRow(int from, const int* row, int size) {
+    std::size_t edges = 0;
+    int min_weight = std::numeric_limits<int>::max();
+    int max_weight = 0;
+    for (int j = 0; j < size; ++j) {
+      // 0 (no edge) wraps around to the largest unsigned value
+      min_weight = std::min<unsigned>(row[j] - 1u, min_weight - 1u) + 1u;
+      max_weight = std::max(max_weight, row[j]);
+      edges += row[j] > 0;
+    }
+    if (edges == 0) return;
+    min_weight_ = edges_ == 0 ? min_weight : std::min(min_weight_, min_weight);
+    max_weight_ = std::max(max_weight_, max_weight);
+    edges_ += edges;
+    self_loops_ += row[from] > 0;
+    // once everything is joined the remaining edges cannot merge anything
+    for (int j = 0; j < size && components_.Count() > 1; ++j) {
+      if (row[j] > 0 && j != from) components_.Unite(from, j);
+    }
+  }
+
+  /**
+   * @brief Records pairs {i, j} whose two directions differ.
+   */
+  void AddAsymmetricPairs(std::size_t count) { asymmetric_pairs_ += count; }
+
+  /**
+   * @brief Adds everything another builder for the same graph collected.
+   */
+  void Merge(MetadataBuilder& other) {
+    if (other.edges_ > 0) {
+      min_weight_ = edges_ == 0 ? other.min_weight_
+                                : std::min(min_weight_, other.min_weight_);
+    }
+    max_weight_ = std::max(max_weight_, other.max_weight_);
+    edges_ += other.edges_;
+    self_loops_ += other.self_loops_;
+    asymmetric_pairs_ += other.asymmetric_pairs_;
+    if (other.components_.Count() < size_) {
+      for (int v = 0; v < size_; ++v) {
+        components_.Unite(v, other.components_.Find(v));
+      }
+    }
+  }
+
+  /**
+   * @brief Gets the collected metadata.
+   */
+  GraphMetadata Build() const {
+    GraphMetadata metadata;
+    metadata.vertex_count = size_;
+    metadata.edge_count = edges_;
+    metadata.density =
+        size_ > 0 ? static_cast<double>(edges_) / size_ / size_ : 0;
+    metadata.min_weight = min_weight_;
+    metadata.max_weight = max_weight_;
+    metadata.self_loops = self_loops_;
+    metadata.asymmetric_pairs = asymmetric_pairs_;
+    metadata.components = components_.Count();
+    return metadata;
+  }
+
+ private:
+  int size_;                          ///< Number of vertices.
+  std::size_t edges_ = 0;             ///< Edges recorded.
+  int min_weight_ = 0;                ///< Lightest edge recorded.
+  int max_weight_ = 0;                ///< Heaviest edge recorded.
+  std::size_t self_loops_ = 0;        ///< Self-loops recorded.
+  std::size_t asymmetric_pairs_ = 0;  ///< Asymmetric pairs recorded.
+  DisjointSets components_;           ///< Vertices joined by recorded edges.
+};
+
+}  // namespace s21
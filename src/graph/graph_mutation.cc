@@ -0,0 +1,250 @@
+#include "graph.h"
+
+#include <atomic>
+#include <utility>
+
+void s21_graph::AddEdge(int from, int to, int weight) {
+  CheckVertex(from);
+  CheckVertex(to);
+  if (weight < 1) {
+    throw std::invalid_argument("Edge weight must be positive!");
+  }
+  from = StorageId(from);
+  to = StorageId(to);
+  if (Weight(from, to) != 0) {
+    throw std::logic_error("Edge already exists!");
+  }
+  PreparePatch();
+  WriteEdge(from, to, weight);
+  CommitChange();
+}
+
+void s21_graph::RemoveEdge(int from, int to) {
+  CheckVertex(from);
+  CheckVertex(to);
+  from = StorageId(from);
+  to = StorageId(to);
+  if (Weight(from, to) == 0) {
+    throw std::logic_error("Edge does not exist!");
+  }
+  PreparePatch();
+  WriteEdge(from, to, 0);
+  CommitChange();
+}
+
+void s21_graph::SetWeight(int from, int to, int weight) {
+  CheckVertex(from);
+  CheckVertex(to);
+  if (weight < 1) {
+    throw std::invalid_argument("Edge weight must be positive!");
+  }
+  from = StorageId(from);
+  to = StorageId(to);
+  if (Weight(from, to) == 0) {
+    throw std::logic_error("Edge does not exist!");
+  }
+  PreparePatch();
+  WriteEdge(from, to, weight);
+  CommitChange();
+}
+
+int s21_graph::AddVertex() {
+  MakeWritable();
+  PreparePatch();
+  const int size = Size();
+  std::visit(
+      [size](auto& data) {
+        using Storage = std::decay_t<decltype(data)>;
+        if constexpr (s21::kIsDenseMatrix<Storage>) {
+          Storage matrix(size + 1);
+          for (int i = 0; i < size; ++i) {
+            const auto* row = std::as_const(data).Row(i);
+            std::copy(row, row + size, matrix.Row(i));
+          }
+          data = std::move(matrix);
+        } else {
+          data.AddVertex();
+        }
+      },
+      graph_);
+
+  ++metadata_.vertex_count;
+  ++metadata_.components;
+  metadata_.density = static_cast<double>(metadata_.edge_count) /
+                      (size + 1.0) / (size + 1.0);
+  patch_.components.Add();
+  if (!old_id_.empty()) {
+    old_id_.push_back(size);
+    new_id_.push_back(size);
+  }
+  CommitChange();
+  return size;
+}
+
+void s21_graph::RemoveVertex(int vertex) {
+  CheckVertex(vertex);
+  MakeWritable();
+  const int size = Size();
+  const int stored = StorageId(vertex);
+  std::visit(
+      [size, stored](auto& data) {
+        using Storage = std::decay_t<decltype(data)>;
+        if constexpr (s21::kIsDenseMatrix<Storage>) {
+          Storage matrix(size - 1);
+          for (int i = 0, row = 0; i < size; ++i) {
+            if (i == stored) continue;
+            const auto* cells = std::as_const(data).Row(i);
+            auto* target = matrix.Row(row++);
+            std::copy(cells, cells + stored, target);
+            std::copy(cells + stored + 1, cells + size, target + stored);
+          }
+          data = std::move(matrix);
+        } else {
+          data.RemoveVertex(stored);
+        }
+      },
+      graph_);
+  if (!old_id_.empty()) {
+    old_id_.erase(old_id_.begin() + stored);
+    for (int& id : old_id_) id -= id > vertex;
+    new_id_.resize(size - 1);
+    for (int k = 0; k < size - 1; ++k) new_id_[old_id_[k]] = k;
+  }
+  // ids shift, so the patch state is left stale and rebuilt on demand
+  ComputeMetadata();
+  version_ = NextVersion();
+  ParseType();
+}
+
+std::uint64_t s21_graph::GetVersion() const { return version_; }
+
+std::uint64_t s21_graph::NextVersion() {
+  static std::atomic<std::uint64_t> last{0};
+  return ++last;
+}
+
+void s21_graph::CheckVertex(int vertex) const {
+  if (vertex < 0 || vertex >= Size()) {
+    throw std::out_of_range("Vertex is out of range!");
+  }
+}
+
+void s21_graph::PreparePatch() {
+  if (patch_.version == version_ && version_ != 0) return;
+  CountWeightRange();
+  CountComponents();
+  patch_.version = version_;
+}
+
+void s21_graph::CountWeightRange() {
+  int min_weight = 0;
+  int max_weight = 0;
+  std::size_t min_edges = 0;
+  std::size_t max_edges = 0;
+  for (int i = 0; i < Size(); ++i) {
+    ForEachStoredNeighbor(i, [&](int, int weight) {
+      if (min_edges == 0 || weight < min_weight) {
+        min_weight = weight;
+        min_edges = 0;
+      }
+      if (weight > max_weight) {
+        max_weight = weight;
+        max_edges = 0;
+      }
+      min_edges += weight == min_weight;
+      max_edges += weight == max_weight;
+    });
+  }
+  metadata_.min_weight = min_weight;
+  metadata_.max_weight = max_weight;
+  patch_.min_weight_edges = min_edges;
+  patch_.max_weight_edges = max_edges;
+}
+
+void s21_graph::CountComponents() {
+  patch_.components = s21::DisjointSets(Size());
+  for (int i = 0; i < Size(); ++i) {
+    ForEachStoredNeighbor(i,
+                          [&](int j, int) { patch_.components.Unite(i, j); });
+  }
+  metadata_.components = patch_.components.Count();
+}
+
+void s21_graph::MakeWritable() {
+  if (GetLayout() == GraphLayout::kCompressed) SetLayout(GraphLayout::kSparse);
+}
+
+int s21_graph::WriteEdge(int from, int to, int weight) {
+  MakeWritable();
+  if (weight > MaxStorableWeight()) FitWeights(weight);
+  int previous = std::visit(
+      [from, to, weight](auto& data) -> int {
+        using Weight = typename std::decay_t<decltype(data)>::ValueType;
+        if constexpr (s21::kIsDenseMatrix<std::decay_t<decltype(data)>>) {
+          Weight& cell = data(from, to);
+          Weight previous = cell;
+          cell = static_cast<Weight>(weight);
+          return previous;
+        } else {
+          return data.Set(from, to, static_cast<Weight>(weight));
+        }
+      },
+      graph_);
+  if (previous == weight) return previous;
+
+  if (from != to) {
+    int reverse = Weight(to, from);
+    if (previous == reverse) ++metadata_.asymmetric_pairs;
+    if (weight == reverse) --metadata_.asymmetric_pairs;
+  }
+
+  bool recount_range = false;
+  if (previous > 0) {
+    --metadata_.edge_count;
+    if (from == to) --metadata_.self_loops;
+    if (previous == metadata_.min_weight) {
+      recount_range |= --patch_.min_weight_edges == 0;
+    }
+    if (previous == metadata_.max_weight) {
+      recount_range |= --patch_.max_weight_edges == 0;
+    }
+  }
+  if (weight > 0) {
+    if (metadata_.edge_count == 0) {
+      metadata_.min_weight = metadata_.max_weight = weight;
+      patch_.min_weight_edges = patch_.max_weight_edges = 0;
+    }
+    ++metadata_.edge_count;
+    if (from == to) ++metadata_.self_loops;
+    if (weight < metadata_.min_weight) {
+      metadata_.min_weight = weight;
+      patch_.min_weight_edges = 0;
+    }
+    if (weight > metadata_.max_weight) {
+      metadata_.max_weight = weight;
+      patch_.max_weight_edges = 0;
+    }
+    patch_.min_weight_edges += weight == metadata_.min_weight;
+    patch_.max_weight_edges += weight == metadata_.max_weight;
+  }
+  // only the last edge at an end of the range forces a rescan
+  if (recount_range) CountWeightRange();
+
+  if (from != to) {
+    if (previous == 0) {
+      if (patch_.components.Unite(from, to)) --metadata_.components;
+    } else if (weight == 0 && Weight(to, from) == 0) {
+      // the pair may have been the only link between two parts
+      CountComponents();
+    }
+  }
+  const double size = Size();
+  metadata_.density = size > 0 ? metadata_.edge_count / size / size : 0;
+  return previous;
+}
+
+void s21_graph::CommitChange() {
+  version_ = NextVersion();
+  patch_.version = version_;
+  ParseType();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "graph_csr.h"
+
+namespace s21 {
+
+/**
+ * @brief Orders the vertices as breadth-first searches visit them.
+ *
+ * A search starts from every vertex not reached yet, in id order. Vertices
+ * reached from the same one end up next to each other, so a later search
+ * over the reordered graph reads neighbouring memory.
+ * @return order[k] is the vertex placed at position k.
+ */
+template <typename T>
+std::vector<int> BreadthFirstOrder(const CsrGraph<T>& graph) {
+  const int size = graph.Size();
+  std::vector<int> order;
+  order.reserve(size);
+  std::vector<bool> placed(size, false);
+  for (int root = 0; root < size; ++root) {
+    if (placed[root]) continue;
+    placed[root] = true;
+    order.push_back(root);
+    for (std::size_t head = order.size() - 1; head < order.size(); ++head) {
+      for (int u : graph.Neighbors(order[head])) {
+        if (!placed[u]) {
+          placed[u] = true;
+          order.push_back(u);
+        }
+      }
+    }
+  }
+  return order;
+}
+
+/**
+ * @brief Orders the vertices by reverse Cuthill-McKee.
+ *
+ * Every component is searched breadth-first from a vertex of minimum
+ * degree, queueing the neighbours of a vertex by increasing degree; the
+ * resulting order is reversed. Edges then join vertices with close ids (the
+ * bandwidth of the adjacency matrix is small), which keeps the rows and
+ * per-vertex data a search touches together in memory.
+ * @return order[k] is the vertex placed at position k.
+ */
+template <typename T>
+std::vector<int> ReverseCuthillMcKeeOrder(const CsrGraph<T>& graph) {
+  const int size = graph.Size();
+  std::vector<int> by_degree(size);
+  std::iota(by_degree.begin(), by_degree.end(), 0);
+  std::stable_sort(by_degree.begin(), by_degree.end(), [&](int a, int b) {
+    return graph.Degree(a) < graph.Degree(b);
+  });
+
+  std::vector<int> order;
+  order.reserve(size);
+  std::vector<bool> placed(size, false);
+  for (int root : by_degree) {
+    if (placed[root]) continue;
+    placed[root] = true;
+    order.push_back(root);
+    for (std::size_t head = order.size() - 1; head < order.size(); ++head) {
+      const std::size_t first = order.size();
+      for (int u : graph.Neighbors(order[head])) {
+        if (!placed[u]) {
+          placed[u] = true;
+          order.push_back(u);
+        }
+      }
+      std::stable_sort(order.begin() + first, order.end(), [&](int a, int b) {
+        return graph.Degree(a) < graph.Degree(b);
+      });
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+/**
+ * @brief Orders the vertices by decreasing degree, ties by id.
+ *
+ * The hubs most paths run through share cache lines at the front of every
+ * per-vertex array.
+ * @return order[k] is the vertex placed at position k.
+ */
+template <typename T>
+std::vector<int> DegreeOrder(const CsrGraph<T>& graph) {
+  std::vector<int> order(graph.Size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return graph.Degree(a) > graph.Degree(b);
+  });
+  return order;
+}
+
+}  // namespace s21
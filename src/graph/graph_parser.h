@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace s21 {
+
+/**
+ * @brief In-place scanner for adjacency matrix text.
+ *
+ * Reads whitespace separated non-negative integers, one matrix row per line,
+ * straight from a character buffer (usually a MappedFile) without creating
+ * strings. Digits are decoded eight at a time with SWAR (SIMD within a
+ * register) arithmetic on 64-bit words, so a number costs a handful of
+ * integer operations instead of one branch per character.
+ *
+ * A scanner can cover just a slice of the text (split at line breaks), so
+ * several of them can parse one file concurrently. Errors name the 1-based
+ * matrix row they occurred in. Edge lists are read with the same scanner, one
+ * edge per row; their errors name the line of the file instead (see
+ * NameLines).
+ */
+class MatrixTextParser {
+ public:
+  /// Vertex counts and 1-based ids must stay below this bound.
+  static constexpr int kMaxVertexCount = std::numeric_limits<int>::max();
+
+  /**
+   * @brief Creates a scanner over the characters [begin, end).
+   * @param begin The first character, at the start of a line.
+   * @param end One past the last character.
+   * @param first_row Matrix row (0-based) of the first row in the slice,
+   * used in error messages.
+   */
+  MatrixTextParser(const char* begin, const char* end, int first_row = 0)
+      : begin_(begin), pos_(begin), end_(end), row_(first_row) {}
+
+  /**
+   * @brief Makes errors name the 1-based line of the text instead of the
+   * matrix row, counting blank lines too.
+   *
+   * Lines are counted from the first character of the scanner, so this is
+   * meant for scanners over a whole text, such as edge list ones.
+   */
+  void NameLines() { name_lines_ = true; }
+
+  /**
+   * @brief Moves to the start of the next line that contains a value.
+   * @return False when only whitespace is left.
+   */
+  bool NextRow() {
+    while (pos_ < end_ && IsSpace(*pos_)) ++pos_;
+    return pos_ < end_;
+  }
+
+  /**
+   * @brief Counts the remaining lines that contain a value.
+   *
+   * Only looks for line breaks and non-blank characters; the values are not
+   * decoded. Consumes the scanner.
+   */
+  int CountRows() {
+    int count = 0;
+    while (NextRow()) {
+      ++count;
+      const void* line_end = std::memchr(pos_, '\n', end_ - pos_);
+      pos_ = line_end ? static_cast<const char*>(line_end) + 1 : end_;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Gets the matrix row (0-based) the scanner is at.
+   */
+  int RowIndex() const { return row_; }
+
+  /**
+   * @brief Counts the values on the current line without consuming it.
+   */
+  int CountColumns() const {
+    MatrixTextParser probe = *this;
+    int count = 0;
+    while (probe.NextValue()) {
+      probe.ParseValue();
+      ++count;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Parses the current line into a row buffer and moves past it.
+   * @param row Destination for the values.
+   * @param columns The number of values the line must have.
+   * @throw std::logic_error on a negative weight or a line with a different
+   * number of values, std::invalid_argument on a character that is not part
+   * of a number, std::out_of_range if a value does not fit an int.
+   */
+  void ParseRow(int* row, int columns) {
+    if (ParseValues(row, columns) != columns) {
+      Fail<std::logic_error>("The graph is not a square matrix!");
+    }
+    EndRow();
+  }
+
+  /**
+   * @brief Parses the values of the current line, staying on the line.
+   * @param values Destination for the values.
+   * @param capacity The most values the line may have.
+   * @return The number of values, or capacity + 1 if the line has more (the
+   * extra values are not parsed).
+   * @throw std::logic_error on a negative weight, std::invalid_argument on a
+   * character that is not part of a number, std::out_of_range if a value
+   * does not fit an int.
+   */
+  int ParseValues(int* values, int capacity) {
+    int count = 0;
+    while (NextValue()) {
+      if (count == capacity) return capacity + 1;
+      values[count++] = ParseValue();
+    }
+    return count;
+  }
+
+  /**
+   * @brief Parses the next value of the line as a vertex id, staying on the
+   * line.
+   * @param id Receives the id; 0 is passed through for the caller to reject.
+   * @return False when the line has no more values.
+   * @throw std::logic_error on a negative id, std::invalid_argument on a
+   * character that is not part of a number, std::out_of_range if the id is
+   * not below INT_MAX, so that id + 1 vertices still fit an int.
+   */
+  bool ParseVertexId(int& id) {
+    if (!NextValue()) return false;
+    bool negative = false;
+    std::uint64_t value = 0;
+    Scan scan = ScanNumber(negative, value);
+    if (scan == Scan::kNumber && value >= kMaxVertexCount) {
+      scan = Scan::kTooLarge;
+    }
+    switch (scan) {
+      case Scan::kTooLarge:
+        Fail<std::out_of_range>("Vertex id is too large!");
+      case Scan::kInvalid:
+        Fail<std::invalid_argument>("Invalid character in the vertex id!");
+      case Scan::kNumber:
+        break;
+    }
+    if (negative && value != 0) {
+      Fail<std::logic_error>("Vertex id cannot be negative!");
+    }
+    id = static_cast<int>(value);
+    return true;
+  }
+
+  /**
+   * @brief Parses the next value of the line as a vertex count, staying on
+   * the line.
+   * @param count Receives the count.
+   * @return False when the line has no more values.
+   * @throw std::invalid_argument on anything but a non-negative integer,
+   * std::out_of_range if the count is not below INT_MAX.
+   */
+  bool ParseVertexCount(int& count) {
+    if (!NextValue()) return false;
+    bool negative = false;
+    std::uint64_t value = 0;
+    Scan scan = ScanNumber(negative, value);
+    if (scan == Scan::kInvalid || (negative && value != 0)) {
+      Fail<std::invalid_argument>("Invalid vertex count!");
+    }
+    if (scan == Scan::kTooLarge || value >= kMaxVertexCount) {
+      Fail<std::out_of_range>("Vertex count is too large!");
+    }
+    count = static_cast<int>(value);
+    return true;
+  }
+
+  /**
+   * @brief Moves past the current line to the next row.
+   */
+  void EndRow() {
+    const void* line_end = std::memchr(pos_, '\n', end_ - pos_);
+    pos_ = line_end ? static_cast<const char*>(line_end) + 1 : end_;
+    ++row_;
+  }
+
+  /**
+   * @brief Checks whether the next value on the line is a word rather than
+   * a number.
+   */
+  bool AtWord() {
+    return NextValue() && std::isalpha(static_cast<unsigned char>(*pos_));
+  }
+
+  /**
+   * @brief Reads the word at the current position, staying on the line.
+   */
+  std::string_view ParseWord() {
+    const char* word = pos_;
+    while (pos_ < end_ && !IsSpace(*pos_)) ++pos_;
+    return std::string_view(word, pos_ - word);
+  }
+
+  /**
+   * @brief Throws an error that names the current row, or the current line
+   * after NameLines.
+   * @tparam Error The exception type to throw.
+   * @param message The error text.
+   */
+  template <typename Error>
+  [[noreturn]] void Fail(const std::string& message) const {
+    if (name_lines_) {
+      // only errors pay for counting the line breaks
+      auto line = std::count(begin_, pos_, '\n') + 1;
+      throw Error(message + " (line " + std::to_string(line) + ")");
+    }
+    throw Error(message + " (row " + std::to_string(row_ + 1) + ")");
+  }
+
+  /**
+   * @brief Gets the position of the next unread character.
+   */
+  const char* Position() const { return pos_; }
+
+ private:
+  const char* begin_;        ///< The first character.
+  const char* pos_;          ///< Next unread character.
+  const char* end_;          ///< One past the last character.
+  int row_;                  ///< Matrix row (0-based) of the current line.
+  bool name_lines_ = false;  ///< Errors name lines rather than rows.
+
+  /// Outcome of ScanNumber.
+  enum class Scan { kNumber, kTooLarge, kInvalid };
+
+  static bool IsSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+  }
+
+  /**
+   * @brief Skips blanks up to the next value on the current line.
+   * @return False at the end of the line or of the buffer.
+   */
+  bool NextValue() {
+    while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\r')) {
+      ++pos_;
+    }
+    return pos_ < end_ && *pos_ != '\n';
+  }
+
+  /**
+   * @brief Parses one value starting at the current position.
+   */
+  int ParseValue() {
+    bool negative = false;
+    std::uint64_t value = 0;
+    switch (ScanNumber(negative, value)) {
+      case Scan::kTooLarge:
+        Fail<std::out_of_range>("Edge weight is too large!");
+      case Scan::kInvalid:
+        Fail<std::invalid_argument>("Invalid character in the matrix!");
+      case Scan::kNumber:
+        break;
+    }
+    if (negative && value != 0) {
+      Fail<std::logic_error>("Edge weight cannot be negative!");
+    }
+    return static_cast<int>(value);
+  }
+
+  /**
+   * @brief Reads an optionally signed number starting at the current
+   * position, stopping as soon as its magnitude exceeds an int.
+   * @param negative Receives whether a minus sign came first.
+   * @param value Receives the magnitude.
+   */
+  Scan ScanNumber(bool& negative, std::uint64_t& value) {
+    negative = *pos_ == '-';
+    if (negative || *pos_ == '+') ++pos_;
+    const char* digits = pos_;
+    value = 0;
+    while (true) {
+      int length = 0;
+      std::uint64_t chunk = 0;
+      if (end_ - pos_ >= 8 && std::endian::native == std::endian::little) {
+        length = ParseEightDigits(pos_, chunk);
+      } else {
+        while (length < 8 && pos_ + length < end_ &&
+               static_cast<unsigned char>(pos_[length] - '0') < 10) {
+          chunk = chunk * 10 + (pos_[length] - '0');
+          ++length;
+        }
+      }
+      value = value * kPowersOfTen[length] + chunk;
+      pos_ += length;
+      if (value > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        return Scan::kTooLarge;
+      }
+      if (length < 8) break;
+    }
+    if (pos_ == digits || (pos_ < end_ && !IsSpace(*pos_))) {
+      return Scan::kInvalid;
+    }
+    return Scan::kNumber;
+  }
+
+  /**
+   * @brief Decodes the run of up to eight digits at p with SWAR arithmetic.
+   * @param p At least eight readable characters.
+   * @param value Receives the decoded run.
+   * @return The length of the digit run (0..8).
+   */
+  static int ParseEightDigits(const char* p, std::uint64_t& value) {
+    constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+    std::uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    // digit bytes become 0..9, every other byte something larger
+    std::uint64_t digits = word ^ (kOnes * '0');
+    // high bit of a byte is set unless the byte was '0'..'9'
+    std::uint64_t non_digit =
+        (((digits & kOnes * 0x7F) + kOnes * (0x80 - 10)) | digits) &
+        (kOnes * 0x80);
+    int length = non_digit == 0 ? 8 : std::countr_zero(non_digit) / 8;
+    if (length == 0) {
+      value = 0;
+      return 0;
+    }
+    // keep the digit bytes and move them to the top, so the low bytes act
+    // as leading zeros
+    digits <<= 8 * (8 - length);
+    digits = (digits * 10 + (digits >> 8)) & 0x00FF00FF00FF00FFULL;
+    digits = (digits * 100 + (digits >> 16)) & 0x0000FFFF0000FFFFULL;
+    value = (digits * 10000 + (digits >> 32)) & 0xFFFFFFFFULL;
+    return length;
+  }
+
+  static constexpr std::uint64_t kPowersOfTen[9] = {
+      1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+};
+
+}  // namespace s21
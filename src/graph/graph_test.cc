@@ -2,9 +2,20 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "graph_test_util.h"
 
 TEST(GraphTest, LoadEmptyFileThrowsException) {
   s21_graph graph;
@@ -52,6 +63,25 @@ TEST(GraphTest, LoadNonSquareMatrixThrowsException) {
     file << "4 5\n";    // 2
   }
 
+  EXPECT_THROW(
+      {
+        try {
+          graph.LoadFromFile(filename);
+        } catch (const std::logic_error& e) {
+          EXPECT_STREQ(e.what(), "The graph is not a square matrix!");
+          throw;
+        }
+      },
+      std::logic_error);
+
+  // a single wide row is rejected before its 40000 x 40000 matrix is
+  // allocated
+  {
+    std::ofstream file(filename);
+    for (int j = 0; j < 40000; ++j) file << "0 ";
+    file << "\n";
+  }
+
   EXPECT_THROW(
       {
         try {
@@ -81,7 +111,7 @@ TEST(GraphTest, LoadMatrixWithNegativeEdgeThrowsException) {
         try {
           graph.LoadFromFile(filename);
         } catch (const std::logic_error& e) {
-          EXPECT_STREQ(e.what(), "Edge weight cannot be negative!");
+          EXPECT_STREQ(e.what(), "Edge weight cannot be negative! (row 1)");
           throw;
         }
       },
@@ -90,6 +120,1149 @@ TEST(GraphTest, LoadMatrixWithNegativeEdgeThrowsException) {
   std::filesystem::remove(filename);
 }
 
+TEST(GraphTest, LoadMatrixWithShortRowThrowsException) {
+  s21_graph graph;
+  std::string filename = "short_row_matrix.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 1 1\n";
+    file << "1 0\n";
+    file << "1 1 0\n";
+  }
+
+  EXPECT_THROW(graph.LoadFromFile(filename), std::logic_error);
+
+  std::filesystem::remove(filename);
+}
+
+TEST(GraphTest, LoadParsesLongNumbersAndMixedWhitespace) {
+  s21_graph graph;
+  std::string filename = "mixed_whitespace.txt";
+
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << "\n  0\t123456789  7\r\n"
+         << "2147483647 0 +12\r\n"
+         << "\n"
+         << "00000000009 1 0";  // no trailing line break
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  ASSERT_EQ(graph.Size(), 3);
+  EXPECT_EQ(graph(0, 1), 123456789);
+  EXPECT_EQ(graph(0, 2), 7);
+  EXPECT_EQ(graph(1, 0), 2147483647);
+  EXPECT_EQ(graph(1, 2), 12);
+  EXPECT_EQ(graph(2, 0), 9);
+  EXPECT_EQ(graph(2, 1), 1);
+  EXPECT_EQ(graph.GetType(), GraphType::kWeigtedDirected);
+  EXPECT_GT(graph.GetLoadStats().bytes, 0u);
+  EXPECT_GE(graph.GetLoadStats().MegabytesPerSecond(), 0.0);
+}
+
+TEST(GraphTest, LoadMalformedValuesThrowsException) {
+  s21_graph graph;
+  std::string filename = "malformed_matrix.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 1x\n1 0\n";
+  }
+  EXPECT_THROW(graph.LoadFromFile(filename), std::invalid_argument);
+
+  {
+    std::ofstream file(filename);
+    file << "0 2147483648\n1 0\n";
+  }
+  EXPECT_THROW(graph.LoadFromFile(filename), std::out_of_range);
+
+  {
+    std::ofstream file(filename);
+    file << "0 1\n-0 0\n";
+  }
+  EXPECT_NO_THROW(graph.LoadFromFile(filename));
+
+  std::filesystem::remove(filename);
+}
+
+TEST(GraphTest, LoadLargeFileInParallelSlices) {
+  s21_graph graph;
+  std::string filename = "large_matrix.txt";
+  const int size = 800;
+  auto write_matrix = [&](int broken_row, const std::string& broken_cell) {
+    std::ofstream file(filename);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        if (i == broken_row && j == 3) {
+          file << broken_cell << " ";
+        } else {
+          file << (i == j ? 0 : 100 + (i * 7 + j * 13) % 900) << " ";
+        }
+      }
+      file << "\n";
+    }
+  };
+
+  write_matrix(-1, "");
+  ASSERT_GT(std::filesystem::file_size(filename),
+            2 * s21_graph::kParseSliceBytes);
+  graph.LoadFromFile(filename);
+  ASSERT_EQ(graph.Size(), size);
+  EXPECT_EQ(graph.GetLayout(), GraphLayout::kDense);
+  EXPECT_EQ(graph.GetType(), GraphType::kWeigtedDirected);
+  for (int i : {0, 1, 345, 346, 798, 799}) {
+    int j = (i + 5) % size;
+    EXPECT_EQ(graph(i, j), 100 + (i * 7 + j * 13) % 900);
+  }
+
+  write_matrix(600, "-4");
+  try {
+    graph.LoadFromFile(filename);
+    FAIL() << "negative weight was accepted";
+  } catch (const std::logic_error& e) {
+    EXPECT_STREQ(e.what(), "Edge weight cannot be negative! (row 601)");
+  }
+
+  write_matrix(450, "1 2");
+  try {
+    graph.LoadFromFile(filename);
+    FAIL() << "a row with an extra value was accepted";
+  } catch (const std::logic_error& e) {
+    EXPECT_STREQ(e.what(), "The graph is not a square matrix! (row 451)");
+  }
+
+  std::filesystem::remove(filename);
+}
+
+TEST(GraphTest, MatrixRowsAreContiguousAndAligned) {
+  s21_graph graph;
+  std::string filename = "aligned_matrix.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 3 0\n"
+         << "3 0 5\n"
+         << "0 5 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  ASSERT_EQ(graph.GetWeightBytes(), 1u);
+  for (int i = 0; i < graph.Size(); ++i) {
+    auto row = graph.Row<std::uint8_t>(i);
+    auto address = reinterpret_cast<std::uintptr_t>(row.data());
+    EXPECT_EQ(address % s21::kCacheLineSize, 0u);
+    EXPECT_EQ(row.size(), 3u);
+  }
+  EXPECT_EQ(graph.Row<std::uint8_t>(1)[2], 5);
+  EXPECT_EQ(graph(2, 1), 5);
+  EXPECT_THROW(graph.Row<int>(1), std::logic_error);  // not stored as int
+
+  // the storage is read in place instead of being copied
+  const s21_graph& shared = graph;
+  auto cells = [](const s21_graph& g) {
+    return g.VisitStorage([](const auto& data) -> const void* {
+      if constexpr (s21::kIsDenseMatrix<std::decay_t<decltype(data)>>) {
+        return data.Row(0);
+      }
+      return nullptr;
+    });
+  };
+  EXPECT_EQ(cells(shared), shared.Row<std::uint8_t>(0).data());
+  EXPECT_EQ(cells(shared), cells(graph));
+  int sum = 0;
+  shared.ForEachNeighbor(1, [&](int u, int weight) { sum += u * weight; });
+  EXPECT_EQ(sum, 3 * 0 + 5 * 2);
+  EXPECT_EQ(shared(0, 1), 3);
+
+  s21::DenseMatrix<int> matrix(20, 7);
+  EXPECT_EQ(matrix.Stride() * sizeof(int) % s21::kCacheLineSize, 0u);
+  EXPECT_GE(matrix.Stride(), 20u);
+  EXPECT_EQ(matrix(19, 19), 7);
+  EXPECT_EQ(matrix.Row(0)[matrix.Stride() - 1], 0);  // padding stays empty
+}
+
+TEST(GraphTest, MatrixViewIsDenseOnly) {
+  s21_graph graph;
+  std::string filename = "view_matrix.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 70000 0 0\n"
+         << "70000 0 9 0\n"
+         << "0 9 0 1\n"
+         << "0 0 1 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  // a dense int matrix in the original order has a view
+  graph.SetLayout(GraphLayout::kDense);
+  ASSERT_EQ(graph.GetWeightBytes(), sizeof(int));
+  s21::MatrixView<const int> view = graph.View<int>();
+  EXPECT_EQ(view.Size(), 4);
+  EXPECT_EQ(view(1, 2), 9);
+  EXPECT_EQ(view.Row(0).data(), graph.Row<int>(0).data());
+
+  // every other layout and order is read through ForEachNeighbor
+  s21_graph narrow;
+  {
+    std::ofstream file(filename);
+    file << "0 2\n2 0\n";
+  }
+  narrow.LoadFromFile(filename);
+  EXPECT_NE(narrow.GetWeightBytes(), sizeof(int));
+  EXPECT_THROW(narrow.View<int>(), std::logic_error);
+  s21_graph sparse = graph;
+  sparse.SetLayout(GraphLayout::kSparse);
+  EXPECT_THROW(sparse.View<int>(), std::logic_error);
+  s21_graph reordered = graph;
+  reordered.SetVertexOrder(VertexOrder::kDegree);
+  EXPECT_THROW(reordered.View<int>(), std::logic_error);
+  s21_graph bits;
+  {
+    std::ofstream file(filename);
+    file << "0 1\n1 0\n";
+  }
+  bits.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  ASSERT_EQ(bits.GetLayout(), GraphLayout::kBitPacked);
+  EXPECT_THROW(bits.View<std::uint8_t>(), std::logic_error);
+  EXPECT_THROW(bits.Row<std::uint8_t>(0), std::logic_error);
+
+  for (const s21_graph* g : {&graph, &sparse, &reordered}) {
+    std::vector<std::pair<int, int>> edges;
+    g->ForEachNeighbor(1, [&](int u, int w) { edges.emplace_back(u, w); });
+    std::sort(edges.begin(), edges.end());
+    EXPECT_EQ(edges, (std::vector<std::pair<int, int>>{{0, 70000}, {2, 9}}));
+  }
+
+  // VisitRow hands out dense rows of any width and order in place
+  auto weights = [](const s21_graph& g, int v) {
+    std::vector<int> row;
+    g.VisitRow(v, [&](auto cells) { row.assign(cells.begin(), cells.end()); });
+    return row;
+  };
+  const void* cells = nullptr;
+  narrow.VisitRow(0, [&](auto row) {
+    EXPECT_EQ(sizeof(row[0]), 1u);
+    cells = row.data();
+  });
+  EXPECT_EQ(cells, narrow.Row<std::uint8_t>(0).data());
+  EXPECT_EQ(weights(narrow, 1), (std::vector<int>{2, 0}));
+  std::vector<int> row = weights(reordered, 1);
+  ASSERT_EQ(row.size(), 4u);
+  EXPECT_EQ(row[reordered.StorageId(0)], 70000);
+  EXPECT_EQ(row[reordered.StorageId(2)], 9);
+  EXPECT_EQ(row[reordered.StorageId(3)], 0);
+  EXPECT_THROW(weights(sparse, 1), std::logic_error);
+  EXPECT_THROW(weights(bits, 1), std::logic_error);
+}
+
+TEST(GraphTest, WeightsUseTheNarrowestType) {
+  std::string filename = "width_matrix.txt";
+  std::string binary_filename = "width_graph.s21g";
+  const std::pair<int, std::size_t> cases[] = {
+      {1, 1}, {255, 1}, {256, 2}, {65535, 2}, {65536, 4}};
+  for (const auto& [max_weight, bytes] : cases) {
+    {
+      std::ofstream file(filename);
+      file << "0 " << max_weight << "\n1 0\n";
+    }
+    s21_graph graph;
+    graph.LoadFromFile(filename);
+    EXPECT_EQ(graph.GetWeightBytes(), bytes) << max_weight;
+    EXPECT_EQ(graph(0, 1), max_weight);
+
+    graph.SetLayout(GraphLayout::kSparse);
+    EXPECT_EQ(graph.GetWeightBytes(), bytes);
+    EXPECT_EQ(graph.ToCsr().At(0, 1), max_weight);
+    graph.SaveToBinary(binary_filename);
+    s21_graph mapped;
+    mapped.LoadFromBinary(binary_filename);
+    EXPECT_EQ(mapped.GetWeightBytes(), bytes);
+    EXPECT_EQ(mapped(0, 1), max_weight);
+  }
+  std::filesystem::remove(filename);
+  std::filesystem::remove(binary_filename);
+
+  // a heavier edge widens the storage
+  {
+    std::ofstream file(filename);
+    file << "0 1\n1 0\n";
+  }
+  s21_graph graph;
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  graph.SetWeight(0, 1, 1000);
+  EXPECT_EQ(graph.GetWeightBytes(), 2u);
+  graph.AddEdge(1, 1, 100000);
+  EXPECT_EQ(graph.GetWeightBytes(), 4u);
+  EXPECT_EQ(graph(0, 1), 1000);
+  EXPECT_EQ(graph.Row<int>(1)[1], 100000);
+}
+
+TEST(GraphTest, LowDensityGraphIsStoredSparse) {
+  s21_graph graph;
+  std::string filename = "sparse_cycle.txt";
+  const int size = 50;
+
+  {
+    std::ofstream file(filename);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        bool edge = (j == (i + 1) % size) || (i == (j + 1) % size);
+        file << (edge ? i + j + 1 : 0) << " ";
+      }
+      file << "\n";
+    }
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  EXPECT_EQ(graph.GetLayout(), GraphLayout::kSparse);
+  EXPECT_EQ(graph.GetType(), GraphType::kWeightedUndirected);
+  EXPECT_EQ(graph.Size(), size);
+  EXPECT_EQ(graph(0, 1), 2);
+  EXPECT_EQ(graph(size - 1, 0), size);
+  EXPECT_EQ(graph(0, 2), 0);
+  EXPECT_THROW(graph.Row<std::uint8_t>(0), std::logic_error);
+
+  SparseGraphData csr = graph.ToCsr();
+  EXPECT_EQ(csr.EdgeCount(), 2u * size);
+  EXPECT_EQ(csr.Offsets().size(), size + 1u);
+  ASSERT_EQ(csr.Degree(0), 2);
+  EXPECT_EQ(csr.Neighbors(0)[0], 1);
+  EXPECT_EQ(csr.Neighbors(0)[1], size - 1);
+  EXPECT_EQ(csr.Weights(0)[1], size);
+
+  graph.SetLayout(GraphLayout::kDense);
+  EXPECT_EQ(graph.GetLayout(), GraphLayout::kDense);
+  EXPECT_EQ(graph.Row<std::uint8_t>(size - 1)[0], size);
+  EXPECT_EQ(graph(3, 4), 8);
+}
+
+TEST(GraphTest, MetadataIsCollectedOnLoad) {
+  std::string filename = "metadata_matrix.txt";
+  std::string binary_filename = "metadata_graph.s21g";
+
+  {
+    std::ofstream file(filename);
+    file << "0 4 0 0 0\n"
+         << "4 2 9 0 0\n"
+         << "0 3 0 0 0\n"
+         << "0 0 0 0 1\n"
+         << "0 0 0 0 0\n";
+  }
+  s21_graph graph;
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  const s21::GraphMetadata& metadata = graph.GetMetadata();
+  EXPECT_EQ(metadata.vertex_count, 5);
+  EXPECT_EQ(metadata.edge_count, 6u);
+  EXPECT_DOUBLE_EQ(metadata.density, 6.0 / 25);
+  EXPECT_EQ(metadata.min_weight, 1);
+  EXPECT_EQ(metadata.max_weight, 9);
+  EXPECT_EQ(metadata.self_loops, 1u);
+  EXPECT_EQ(metadata.asymmetric_pairs, 2u);  // {1, 2} and {3, 4}
+  EXPECT_EQ(metadata.components, 2);
+  EXPECT_FALSE(metadata.IsSymmetric());
+  EXPECT_FALSE(metadata.IsConnected());
+  EXPECT_FALSE(metadata.IsComplete());
+  EXPECT_EQ(graph.GetType(), GraphType::kWeigtedDirected);
+
+  // binary files carry the metadata of the parse pass in every layout
+  for (GraphLayout layout : {GraphLayout::kSparse, GraphLayout::kDense,
+                             GraphLayout::kCompressed}) {
+    graph.SetLayout(layout);
+    graph.SaveToBinary(binary_filename);
+    s21_graph mapped;
+    mapped.LoadFromBinary(binary_filename);
+    std::filesystem::remove(binary_filename);
+    const s21::GraphMetadata& restored = mapped.GetMetadata();
+    EXPECT_EQ(restored.vertex_count, metadata.vertex_count);
+    EXPECT_EQ(restored.edge_count, metadata.edge_count);
+    EXPECT_DOUBLE_EQ(restored.density, metadata.density);
+    EXPECT_EQ(restored.min_weight, metadata.min_weight);
+    EXPECT_EQ(restored.max_weight, metadata.max_weight);
+    EXPECT_EQ(restored.self_loops, metadata.self_loops);
+    EXPECT_EQ(restored.asymmetric_pairs, metadata.asymmetric_pairs);
+    EXPECT_EQ(restored.components, metadata.components);
+  }
+
+  {
+    std::ofstream file(filename);
+    file << "0 1 1\n1 0 1\n1 1 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  EXPECT_TRUE(graph.GetMetadata().IsComplete());
+  EXPECT_TRUE(graph.GetMetadata().IsConnected());
+  EXPECT_TRUE(graph.GetMetadata().IsSymmetric());
+}
+
+TEST(GraphTest, LoadBinaryWithEditedMetadataThrowsException) {
+  std::string filename = "edited_matrix.txt";
+  std::string binary_filename = "edited_graph.s21g";
+
+  {
+    std::ofstream file(filename);
+    file << "0 5 0 0\n"
+         << "0 0 5 0\n"
+         << "0 0 0 5\n"
+         << "1 0 0 0\n";
+  }
+  s21_graph source;
+  source.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  ASSERT_EQ(source.GetType(), GraphType::kWeigtedDirected);
+
+  // the metadata is trusted once loaded, so any edit of it must be caught
+  auto edit = [&](auto change) {
+    source.SaveToBinary(binary_filename);
+    s21::BinaryGraphHeader header;
+    {
+      std::ifstream file(binary_filename, std::ios::binary);
+      file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    change(header);
+    {
+      std::fstream file(binary_filename,
+                        std::ios::in | std::ios::out | std::ios::binary);
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    s21_graph graph;
+    EXPECT_THROW(graph.LoadFromBinary(binary_filename), std::logic_error);
+  };
+  // read as undirected, the cycle would search itself as its reverse
+  edit([](auto& header) {
+    header.graph_type =
+        static_cast<std::uint32_t>(GraphType::kWeightedUndirected);
+    header.asymmetric_pairs = 0;
+  });
+  edit([](auto& header) { header.components = 2; });
+  edit([](auto& header) { header.directed_declared = 1; });
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, MutatorsPatchTypeAndMetadata) {
+  std::string filename = "mutated_matrix.txt";
+  // reloading the mutated graph gives the metadata a full scan computes
+  auto reloaded_metadata = [&](const s21_graph& graph) {
+    {
+      std::ofstream file(filename);
+      for (int i = 0; i < graph.Size(); ++i) {
+        for (int j = 0; j < graph.Size(); ++j) file << graph(i, j) << " ";
+        file << "\n";
+      }
+    }
+    s21_graph fresh;
+    fresh.LoadFromFile(filename);
+    std::filesystem::remove(filename);
+    return fresh.GetMetadata();
+  };
+
+  for (GraphLayout layout : {GraphLayout::kDense, GraphLayout::kSparse}) {
+    {
+      std::ofstream file(filename);
+      file << "0 1 0 0\n1 0 1 0\n0 1 0 0\n0 0 0 0\n";
+    }
+    s21_graph graph;
+    graph.LoadFromFile(filename);
+    graph.SetLayout(layout);
+    std::uint64_t version = graph.GetVersion();
+    EXPECT_EQ(graph.GetType(), GraphType::kUnweightedUndirected);
+    EXPECT_EQ(graph.GetMetadata().components, 2);
+
+    graph.AddEdge(2, 3, 5);
+    EXPECT_EQ(graph.GetType(), GraphType::kWeigtedDirected);
+    EXPECT_EQ(graph.GetMetadata().components, 1);
+    graph.AddEdge(3, 2, 5);
+    EXPECT_EQ(graph.GetType(), GraphType::kWeightedUndirected);
+    graph.SetWeight(0, 1, 7);
+    graph.SetWeight(1, 0, 7);
+    EXPECT_EQ(graph(1, 0), 7);
+    EXPECT_EQ(graph.GetMetadata().max_weight, 7);
+    EXPECT_EQ(graph.GetMetadata().min_weight, 1);
+    graph.RemoveEdge(1, 2);
+    graph.RemoveEdge(2, 1);
+    EXPECT_EQ(graph.GetMetadata().components, 2);
+    EXPECT_EQ(graph.GetMetadata().min_weight, 5);
+    EXPECT_EQ(graph.GetVersion(), version + 6);
+
+    EXPECT_EQ(graph.AddVertex(), 4);
+    graph.AddEdge(4, 4, 2);
+    EXPECT_EQ(graph.GetMetadata().components, 3);
+    EXPECT_EQ(graph.GetMetadata().self_loops, 1u);
+    graph.RemoveVertex(0);
+    EXPECT_EQ(graph.Size(), 4);
+    EXPECT_EQ(graph(1, 2), 5);
+    EXPECT_EQ(graph(3, 3), 2);
+    EXPECT_EQ(graph.GetLayout(), layout);
+
+    // random edits keep the patched metadata equal to a full recount
+    std::srand(7);
+    for (int step = 0; step < 60; ++step) {
+      int from = std::rand() % graph.Size();
+      int to = std::rand() % graph.Size();
+      int weight = std::rand() % 4;
+      if (graph(from, to) == 0 && weight > 0) {
+        graph.AddEdge(from, to, weight);
+      } else if (graph(from, to) != 0 && weight == 0) {
+        graph.RemoveEdge(from, to);
+      } else if (graph(from, to) != 0) {
+        graph.SetWeight(from, to, weight);
+      }
+      s21::GraphMetadata expected = reloaded_metadata(graph);
+      const s21::GraphMetadata& actual = graph.GetMetadata();
+      ASSERT_EQ(actual.edge_count, expected.edge_count) << step;
+      ASSERT_EQ(actual.min_weight, expected.min_weight) << step;
+      ASSERT_EQ(actual.max_weight, expected.max_weight) << step;
+      ASSERT_EQ(actual.self_loops, expected.self_loops) << step;
+      ASSERT_EQ(actual.asymmetric_pairs, expected.asymmetric_pairs) << step;
+      ASSERT_EQ(actual.components, expected.components) << step;
+      ASSERT_DOUBLE_EQ(actual.density, expected.density) << step;
+    }
+
+    EXPECT_THROW(graph.AddEdge(0, 9), std::out_of_range);
+    EXPECT_THROW(graph.SetWeight(0, 1, 0), std::invalid_argument);
+    graph.AddVertex();
+    EXPECT_THROW(graph.RemoveEdge(0, 4), std::logic_error);
+  }
+}
+
+TEST(GraphTest, BinaryRoundTripKeepsDenseAndSparseGraphs) {
+  std::string text_filename = "binary_source.txt";
+  std::string binary_filename = "binary_graph.s21g";
+
+  {
+    std::ofstream file(text_filename);
+    file << "0 5 0 0\n"
+         << "0 0 2 0\n"
+         << "7 0 0 1\n"
+         << "0 0 0 0\n";
+  }
+  s21_graph source;
+  source.LoadFromFile(text_filename);
+  std::filesystem::remove(text_filename);
+
+  for (GraphLayout layout : {GraphLayout::kDense, GraphLayout::kSparse}) {
+    source.SetLayout(layout);
+    source.SaveToBinary(binary_filename);
+
+    s21_graph graph;
+    graph.LoadFromBinary(binary_filename);
+    EXPECT_TRUE(graph.IsMemoryMapped());
+    EXPECT_EQ(graph.GetLayout(), layout);
+    EXPECT_EQ(graph.GetType(), GraphType::kWeigtedDirected);
+    ASSERT_EQ(graph.Size(), 4);
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        EXPECT_EQ(graph(i, j), source(i, j));
+      }
+    }
+    EXPECT_EQ(graph.GetLoadStats().bytes,
+              std::filesystem::file_size(binary_filename));
+
+    // editing a mapped graph copies it first and leaves the file intact
+    s21_graph edited;
+    edited.LoadFromBinary(binary_filename);
+    edited.AddEdge(3, 0, 4);
+    EXPECT_FALSE(edited.IsMemoryMapped());
+    EXPECT_EQ(edited(3, 0), 4);
+    EXPECT_EQ(graph(3, 0), 0);
+
+    // converting the layout copies the data out of the mapping
+    graph.SetLayout(layout == GraphLayout::kDense ? GraphLayout::kSparse
+                                                  : GraphLayout::kDense);
+    EXPECT_FALSE(graph.IsMemoryMapped());
+    EXPECT_EQ(graph(2, 0), 7);
+  }
+
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, ConcurrentSavesKeepTheFileWhole) {
+  std::string binary_filename = "binary_graph.s21g";
+  const int size = 200;
+
+  s21_graph first, second;
+  s21_test::LoadRandomGraph(first, size, 29, 4, 300);
+  s21_test::LoadRandomGraph(second, size, 31, 4, 300);
+  // an unrelated file with the old temporary name is left alone
+  {
+    std::ofstream file(binary_filename + ".tmp");
+    file << "keep";
+  }
+
+  std::vector<std::thread> threads;
+  for (const s21_graph* graph : {&first, &second}) {
+    threads.emplace_back([&binary_filename, graph] {
+      std::string filename = binary_filename;
+      for (int i = 0; i < 10; ++i) graph->SaveToBinary(filename);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  // whichever save committed last, the file is one of the graphs
+  s21_graph saved;
+  saved.LoadFromBinary(binary_filename);
+  auto same = [&](const s21_graph& graph) {
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        if (saved(i, j) != graph(i, j)) return false;
+      }
+    }
+    return true;
+  };
+  EXPECT_TRUE(same(first) || same(second));
+  std::ifstream kept(binary_filename + ".tmp");
+  std::string contents;
+  kept >> contents;
+  EXPECT_EQ(contents, "keep");
+
+  std::filesystem::remove(binary_filename);
+  std::filesystem::remove(binary_filename + ".tmp");
+}
+
+TEST(GraphTest, MappedGraphSavesOverItsOwnFile) {
+  std::string binary_filename = "binary_graph.s21g";
+  const int size = 300;
+
+  s21_graph source;
+  s21_test::LoadRandomGraph(source, size, 23, 4, 300);
+  for (GraphLayout layout : {GraphLayout::kDense, GraphLayout::kSparse}) {
+    source.SetLayout(layout);
+    source.SaveToBinary(binary_filename);
+
+    // the save reads the mapping it replaces
+    s21_graph graph;
+    graph.LoadFromBinary(binary_filename);
+    ASSERT_TRUE(graph.IsMemoryMapped());
+    graph.SaveToBinary(binary_filename);
+    // no temporary file is left next to the target
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+      std::string name = entry.path().filename().string();
+      EXPECT_FALSE(name.starts_with(binary_filename + ".tmp")) << name;
+    }
+
+    s21_graph saved;
+    saved.LoadFromBinary(binary_filename);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        ASSERT_EQ(graph(i, j), source(i, j));
+        ASSERT_EQ(saved(i, j), source(i, j));
+      }
+    }
+  }
+
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, UnweightedGraphsAreBitPacked) {
+  std::string filename = "bits_matrix.txt";
+  std::string binary_filename = "bits_graph.s21g";
+  const int size = 70;  // rows span two words
+
+  {
+    std::ofstream file(filename);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        file << ((i * 3 + j * 5) % 7 == 0 && i != j) << " ";
+      }
+      file << "\n";
+    }
+  }
+  s21_graph graph;
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  ASSERT_EQ(graph.GetLayout(), GraphLayout::kBitPacked);
+  EXPECT_EQ(graph.GetType(), GraphType::kUnweightedDirected);
+  EXPECT_THROW(graph.Row<std::uint8_t>(0), std::logic_error);
+
+  s21_graph dense = graph;
+  dense.SetLayout(GraphLayout::kDense);
+  s21_graph sparse = graph;
+  sparse.SetLayout(GraphLayout::kSparse);
+  EXPECT_EQ(dense.GetWeightBytes(), 1u);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      int expected = (i * 3 + j * 5) % 7 == 0 && i != j;
+      ASSERT_EQ(graph(i, j), expected) << i << " " << j;
+      ASSERT_EQ(dense.Row<std::uint8_t>(i)[j], expected);
+      ASSERT_EQ(sparse(i, j), expected);
+    }
+  }
+  sparse.SetLayout(GraphLayout::kBitPacked);
+  EXPECT_EQ(sparse(69, 1), graph(69, 1));
+
+  graph.SaveToBinary(binary_filename);
+  s21_graph mapped;
+  mapped.LoadFromBinary(binary_filename);
+  std::filesystem::remove(binary_filename);
+  EXPECT_TRUE(mapped.IsMemoryMapped());
+  EXPECT_EQ(mapped.GetLayout(), GraphLayout::kBitPacked);
+  EXPECT_EQ(mapped.GetMetadata().edge_count, graph.GetMetadata().edge_count);
+  EXPECT_EQ(mapped(68, 67), graph(68, 67));
+
+  // unit edges keep the bits, heavier ones need a matrix
+  mapped.AddEdge(0, 69);
+  EXPECT_FALSE(mapped.IsMemoryMapped());
+  EXPECT_EQ(mapped.GetLayout(), GraphLayout::kBitPacked);
+  EXPECT_EQ(mapped.AddVertex(), size);
+  EXPECT_EQ(mapped(0, 69), 1);
+  mapped.SetWeight(0, 69, 3);
+  EXPECT_EQ(mapped.GetLayout(), GraphLayout::kDense);
+  EXPECT_EQ(mapped(0, 69), 3);
+  EXPECT_THROW(mapped.SetLayout(GraphLayout::kBitPacked), std::logic_error);
+}
+
+TEST(GraphTest, LoadCorruptedBinaryThrowsException) {
+  std::string text_filename = "binary_source.txt";
+  std::string binary_filename = "binary_graph.s21g";
+
+  {
+    std::ofstream file(text_filename);
+    file << "0 1\n1 0\n";
+  }
+  s21_graph source;
+  source.LoadFromFile(text_filename);
+  source.SaveToBinary(binary_filename);
+  std::filesystem::remove(text_filename);
+
+  {
+    std::fstream file(binary_filename,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(sizeof(s21::BinaryGraphHeader) + 4);
+    file.put(9);
+  }
+  s21_graph graph;
+  EXPECT_THROW(graph.LoadFromBinary(binary_filename), std::logic_error);
+
+  // the checksum covers the header too
+  source.SaveToBinary(binary_filename);
+  {
+    std::fstream file(binary_filename,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offsetof(s21::BinaryGraphHeader, graph_type));
+    file.put(static_cast<char>(GraphType::kWeigtedDirected));
+  }
+  EXPECT_THROW(graph.LoadFromBinary(binary_filename), std::logic_error);
+
+  std::filesystem::resize_file(binary_filename, 10);
+  EXPECT_THROW(graph.LoadFromBinary(binary_filename), std::logic_error);
+
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, LoadBinaryWithBadFieldsThrowsException) {
+  std::string text_filename = "binary_source.txt";
+  std::string binary_filename = "binary_graph.s21g";
+  const int size = 70;
+
+  {
+    std::ofstream file(text_filename);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) file << ((i + 1) % size == j) << ' ';
+      file << '\n';
+    }
+  }
+  s21_graph source;
+  source.LoadFromFile(text_filename);
+  std::filesystem::remove(text_filename);
+
+  // the checksum of every edit is fixed, so only the checks of the fields
+  // can reject it
+  auto tamper = [&](GraphLayout layout, auto edit) {
+    source.SetLayout(layout);
+    source.SaveToBinary(binary_filename);
+    s21_test::RewriteBinary<s21::BinaryGraphHeader>(binary_filename, edit);
+    s21_graph graph;
+    EXPECT_THROW(graph.LoadFromBinary(binary_filename), std::logic_error);
+  };
+
+  const std::size_t offsets_bytes = s21::AlignBinary((size + 1) * 8);
+  tamper(GraphLayout::kSparse, [&](auto&, char* payload) {
+    int neighbor = size;
+    std::memcpy(payload + offsets_bytes, &neighbor, sizeof(neighbor));
+  });
+  tamper(GraphLayout::kSparse, [&](auto&, char* payload) {
+    std::uint64_t offset = 1000;
+    std::memcpy(payload + 8, &offset, sizeof(offset));
+  });
+  tamper(GraphLayout::kSparse,
+         [&](auto& header, char*) { header.vertex_count = 1ULL << 40; });
+  tamper(GraphLayout::kDense, [&](auto& header, char*) {
+    header.vertex_count = 1 << 30;
+    header.stride = 1ULL << 40;
+  });
+  tamper(GraphLayout::kDense, [&](auto& header, char*) {
+    header.graph_type = static_cast<std::uint32_t>(GraphType::kUndefined) + 1;
+  });
+  tamper(GraphLayout::kDense, [&](auto& header, char*) {
+    header.graph_type = static_cast<std::uint32_t>(GraphType::kWeigtedDirected);
+  });
+  tamper(GraphLayout::kBitPacked, [&](auto&, char* payload) {
+    payload[15] = 0x40;  // column 126 of row 0
+  });
+  tamper(GraphLayout::kBitPacked,
+         [&](auto& header, char*) { header.self_loops = 1; });
+  tamper(GraphLayout::kDense,
+         [&](auto& header, char*) { header.components = size + 1; });
+  tamper(GraphLayout::kSparse, [&](auto& header, char*) {
+    header.min_weight = 2;
+    header.max_weight = 2;
+  });
+  tamper(GraphLayout::kCompressed, [&](auto&, char* payload) {
+    // the last byte of the rows starts a varint that never ends
+    const std::size_t blocks_bytes = s21::AlignBinary((size / 64 + 1) * 8);
+    const std::size_t rows_bytes = s21::AlignBinary((size + 1) * 4);
+    std::uint32_t bytes = 0;
+    std::memcpy(&bytes, payload + blocks_bytes + size * 4, sizeof(bytes));
+    std::uint64_t second_block = 0;
+    std::memcpy(&second_block, payload + 8, sizeof(second_block));
+    payload[blocks_bytes + rows_bytes + second_block + bytes - 1] |= 0x80;
+  });
+  source.AddEdge(0, 2);
+  tamper(GraphLayout::kSparse, [&](auto&, char* payload) {
+    // row 0 holds 1 and 2; swapped, its binary searches miss
+    int pair[2];
+    std::memcpy(pair, payload + offsets_bytes, sizeof(pair));
+    std::swap(pair[0], pair[1]);
+    std::memcpy(payload + offsets_bytes, pair, sizeof(pair));
+  });
+
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, LoadEdgeListBuildsSparseGraph) {
+  std::string filename = "edge_list.edges";
+
+  {
+    std::ofstream file(filename);
+    file << "1 2 5\n"
+         << "2 3\n"
+         << "\n"
+         << "3 1 7\n"
+         << "1 2 4\n";  // parallel edge, the lighter one is kept
+  }
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  EXPECT_EQ(graph.GetLayout(), GraphLayout::kSparse);
+  EXPECT_EQ(graph.GetType(), GraphType::kWeigtedDirected);
+  ASSERT_EQ(graph.Size(), 3);
+  EXPECT_EQ(graph(0, 1), 4);
+  EXPECT_EQ(graph(1, 2), 1);
+  EXPECT_EQ(graph(2, 0), 7);
+  EXPECT_EQ(graph(1, 0), 0);
+
+  {
+    std::ofstream file(filename);
+    file << "undirected 5\n"
+         << "1 2\n"
+         << "4 2\n";
+  }
+  graph.LoadFromEdgeList(filename);
+  EXPECT_EQ(graph.GetType(), GraphType::kUnweightedUndirected);
+  ASSERT_EQ(graph.Size(), 5);
+  EXPECT_EQ(graph(1, 0), 1);
+  EXPECT_EQ(graph(1, 3), 1);
+  EXPECT_EQ(graph(3, 1), 1);
+  EXPECT_EQ(graph.GetLoadStats().bytes, std::filesystem::file_size(filename));
+
+  {
+    // a zero weight adds no edge but still names a vertex
+    std::ofstream file(filename);
+    file << "1 2\n"
+         << "5 3 0\n"
+         << "2 1\n";
+  }
+  graph.LoadFromEdgeList(filename);
+  EXPECT_EQ(graph.GetType(), GraphType::kUnweightedUndirected);
+  ASSERT_EQ(graph.Size(), 5);
+  EXPECT_EQ(graph.GetMetadata().edge_count, 2u);
+  EXPECT_EQ(graph(4, 2), 0);
+
+  std::filesystem::remove(filename);
+}
+
+TEST(GraphTest, MutatorsKeepDeclaredDirection) {
+  std::string filename = "edge_list.edges";
+  std::string binary_filename = "declared_graph.s21g";
+
+  // symmetric edges, so only the declaration makes the graph directed
+  for (std::string declaration : {"directed 3\n", ""}) {
+    {
+      std::ofstream file(filename);
+      file << declaration << "1 2 4\n2 1 4\n2 3 1\n3 2 1\n";
+    }
+    s21_graph graph;
+    graph.LoadFromEdgeList(filename);
+    GraphType type = declaration.empty() ? GraphType::kWeightedUndirected
+                                         : GraphType::kWeigtedDirected;
+    EXPECT_EQ(graph.GetType(), type);
+    graph.SetWeight(0, 1, 6);
+    graph.SetWeight(1, 0, 6);
+    EXPECT_EQ(graph.GetType(), type);
+    graph.RemoveEdge(1, 2);
+    graph.RemoveEdge(2, 1);
+    EXPECT_EQ(graph.GetType(), type);
+
+    // the declaration is saved with the graph
+    graph.SaveToBinary(binary_filename);
+    s21_graph loaded;
+    loaded.LoadFromBinary(binary_filename);
+    loaded.AddVertex();
+    EXPECT_EQ(loaded.GetType(), type);
+  }
+
+  // an undirected declaration holds only while the edges are symmetric
+  {
+    std::ofstream file(filename);
+    file << "undirected\n1 2 4\n";
+  }
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  graph.SetWeight(0, 1, 6);
+  EXPECT_EQ(graph.GetType(), GraphType::kWeigtedDirected);
+
+  std::filesystem::remove(filename);
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, CompressedLayoutMatchesCsr) {
+  std::string filename = "compressed.edges";
+  std::string binary_filename = "compressed_graph.s21g";
+  const int size = 300;
+
+  for (bool weighted : {true, false}) {
+    {
+      // mostly nearby neighbours plus a few far ones, on both sides
+      std::srand(5);
+      std::ofstream file(filename);
+      file << "directed " << size << "\n";
+      for (int v = 1; v <= size; ++v) {
+        for (int k = 0; k < 4; ++k) {
+          int u = k < 3 ? v + std::rand() % 9 - 4 : std::rand() % size + 1;
+          if (u < 1 || u > size) continue;
+          file << v << " " << u;
+          if (weighted) file << " " << std::rand() % 1000 + 1;
+          file << "\n";
+        }
+      }
+    }
+    s21_graph csr;
+    csr.LoadFromEdgeList(filename);
+    s21_graph graph = csr;
+    graph.SetLayout(GraphLayout::kCompressed);
+    ASSERT_EQ(graph.GetLayout(), GraphLayout::kCompressed);
+    // ids shrink to a byte; varint weights are no smaller than uint16 ones
+    EXPECT_LT(graph.GetStorageBytes() * (weighted ? 1 : 3),
+              csr.GetStorageBytes());
+
+    auto neighbors = [](const s21_graph& g, int v) {
+      std::vector<std::pair<int, int>> edges;
+      g.ForEachNeighbor(v, [&](int u, int w) { edges.emplace_back(u, w); });
+      return edges;
+    };
+    for (int v = 0; v < size; ++v) {
+      ASSERT_EQ(neighbors(graph, v), neighbors(csr, v)) << v;
+    }
+    EXPECT_EQ(graph(7, 3), csr(7, 3));
+    EXPECT_EQ(graph.ToCsr().AllWeights().size(), csr.ToCsr().EdgeCount());
+
+    graph.SaveToBinary(binary_filename);
+    s21_graph mapped;
+    mapped.LoadFromBinary(binary_filename);
+    EXPECT_TRUE(mapped.IsMemoryMapped());
+    EXPECT_EQ(mapped.GetLayout(), GraphLayout::kCompressed);
+    EXPECT_EQ(mapped.GetMetadata().edge_count, csr.GetMetadata().edge_count);
+    EXPECT_EQ(mapped.GetType(), csr.GetType());
+    for (int v = 0; v < size; v += 17) {
+      EXPECT_EQ(neighbors(mapped, v), neighbors(csr, v)) << v;
+    }
+
+    // a change converts the graph to CSR first
+    mapped.AddEdge(0, size - 1, 70000);
+    EXPECT_EQ(mapped.GetLayout(), GraphLayout::kSparse);
+    EXPECT_EQ(mapped.GetWeightBytes(), 4u);
+    EXPECT_EQ(mapped(0, size - 1), 70000);
+    graph.SetLayout(GraphLayout::kDense);
+    EXPECT_EQ(graph.GetWeightBytes(), weighted ? 2u : 1u);
+    EXPECT_EQ(graph(4, 5), csr(4, 5));
+  }
+  std::filesystem::remove(filename);
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, VertexOrderKeepsOriginalIds) {
+  std::string filename = "shuffled.edges";
+  std::string binary_filename = "shuffled_graph.s21g";
+  const int size = 200;
+
+  {
+    // a path 0 - 1 - ... - 199 under scattered ids
+    std::ofstream file(filename);
+    file << "undirected " << size << "\n";
+    for (int k = 0; k + 1 < size; ++k) {
+      file << (k * 73 % size + 1) << " " << ((k + 1) * 73 % size + 1) << " "
+           << k % 5 + 1 << "\n";
+    }
+  }
+  s21_graph original;
+  original.LoadFromEdgeList(filename);
+  auto bandwidth = [size](const s21_graph& g) {
+    int widest = 0;
+    for (int v = 0; v < size; ++v) {
+      g.ForEachNeighbor(v, [&](int u, int) {
+        widest = std::max(widest, std::abs(g.StorageId(u) - g.StorageId(v)));
+      });
+    }
+    return widest;
+  };
+  EXPECT_GT(bandwidth(original), 100);
+
+  for (VertexOrder order :
+       {VertexOrder::kBreadthFirst, VertexOrder::kReverseCuthillMcKee,
+        VertexOrder::kDegree}) {
+    s21_graph graph;
+    graph.SetVertexOrder(order);
+    graph.LoadFromEdgeList(filename);
+    EXPECT_EQ(graph.GetVertexOrder(), order);
+    for (int i = 0; i < size; ++i) {
+      ASSERT_EQ(graph.OriginalId(graph.StorageId(i)), i);
+      for (int j = 0; j < size; ++j) {
+        ASSERT_EQ(graph(i, j), original(i, j)) << i << " " << j;
+      }
+    }
+    if (order != VertexOrder::kDegree) {
+      EXPECT_LE(bandwidth(graph), 2);
+    }
+
+    // edits and files use the original ids too
+    graph.AddEdge(0, 5, 9);
+    EXPECT_EQ(graph(0, 5), 9);
+    EXPECT_EQ(graph(5, 0), original(5, 0));
+    graph.RemoveVertex(3);
+    EXPECT_EQ(graph.Size(), size - 1);
+    EXPECT_EQ(graph(0, 4), 9);
+    EXPECT_EQ(graph.AddVertex(), size - 1);
+    graph.AddEdge(size - 1, 0);
+    graph.SaveToBinary(binary_filename);
+    s21_graph mapped;
+    mapped.LoadFromBinary(binary_filename);
+    EXPECT_EQ(mapped.StorageId(7), 7);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        ASSERT_EQ(mapped(i, j), graph(i, j));
+      }
+    }
+
+    graph.SetVertexOrder(VertexOrder::kOriginal);
+    EXPECT_EQ(graph.StorageId(7), 7);
+    EXPECT_EQ(graph(0, 4), 9);
+  }
+  std::filesystem::remove(filename);
+  std::filesystem::remove(binary_filename);
+}
+
+TEST(GraphTest, ReverseAdjacencyIsCachedPerVersion) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 2 0\n"
+            "0 0 3\n"
+            "4 0 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  auto reverse = graph.GetReverse();
+  EXPECT_EQ(reverse->At(1, 0), 2);
+  EXPECT_EQ(reverse->At(2, 1), 3);
+  EXPECT_EQ(reverse->At(0, 2), 4);
+  EXPECT_EQ(reverse->At(0, 1), 0);
+  EXPECT_EQ(graph.GetReverse(), reverse);
+
+  graph.AddEdge(0, 2, 5);
+  auto changed = graph.GetReverse();
+  EXPECT_NE(changed, reverse);
+  EXPECT_EQ(changed->At(2, 0), 5);
+  EXPECT_EQ(reverse->At(2, 0), 0);  // earlier results stay valid
+}
+
+TEST(GraphTest, LoadMalformedEdgeListThrowsException) {
+  std::string filename = "edge_list.edges";
+  const std::string shape = "An edge must be \"source destination [weight]\"!";
+  const std::pair<std::string, std::string> cases[] = {
+      {"1 2\n3\n", shape + " (line 2)"},
+      {"1 2 3 4\n", shape + " (line 1)"},
+      {"0 1\n", "Vertex ids start at 1! (line 1)"},
+      {"directed 2\n1 3\n", "Vertex id is out of range! (line 2)"},
+      // without a declared count one far id would size the whole graph
+      {"1 2\n2 1000000000\n", "Vertex id is out of range! (line 2)"},
+      {"mixed\n1 2\n", "Unknown edge list declaration! (line 1)"},
+      {"directed 2 3\n1 2\n", "Invalid edge list declaration! (line 1)"},
+      {"directed -5\n1 2\n", "Invalid vertex count! (line 1)"},
+      {"directed 5x\n1 2\n", "Invalid vertex count! (line 1)"},
+      {"1 2 -3\n", "Edge weight cannot be negative! (line 1)"},
+      // ids are not weights, and blank lines still count
+      {"1 2\n\n1 3000000000\n", "Vertex id is too large! (line 3)"},
+      // INT_MAX vertices would overflow the offsets of the graph
+      {"1 2147483647\n", "Vertex id is too large! (line 1)"},
+      {"undirected 2147483647\n1 2\n", "Vertex count is too large! (line 1)"},
+      {"-1 2\n", "Vertex id cannot be negative! (line 1)"},
+      {"1 x2\n", "Invalid character in the vertex id! (line 1)"},
+      {"1 2 3000000000\n", "Edge weight is too large! (line 1)"},
+  };
+  for (const auto& [text, message] : cases) {
+    {
+      std::ofstream file(filename);
+      file << text;
+    }
+    s21_graph graph;
+    try {
+      graph.LoadFromEdgeList(filename);
+      ADD_FAILURE() << "no exception for: " << text;
+    } catch (const std::logic_error& e) {
+      EXPECT_EQ(e.what(), message);
+    }
+  }
+
+  std::filesystem::remove(filename);
+}
+
+TEST(GraphTest, EdgeListInferredVertexCountIsBounded) {
+  std::string filename = "edge_list.edges";
+  const int bound = static_cast<int>(s21_graph::kMaxInferredVertices);
+  auto load = [&filename](s21_graph& graph, const std::string& text) {
+    {
+      std::ofstream file(filename);
+      file << text;
+    }
+    graph.LoadFromEdgeList(filename);
+  };
+
+  // a small file may name ids up to the bound without a declaration
+  s21_graph graph;
+  load(graph, "1 2\n2 " + std::to_string(bound) + "\n");
+  EXPECT_EQ(graph.Size(), bound);
+  EXPECT_THROW(load(graph, "1 2\n2 " + std::to_string(bound + 1) + "\n"),
+               std::out_of_range);
+  // a declared count lifts the bound
+  const int declared = 2 * bound;
+  load(graph, "undirected " + std::to_string(declared) + "\n1 2\n2 " +
+                  std::to_string(declared) + "\n");
+  EXPECT_EQ(graph.Size(), declared);
+
+  std::filesystem::remove(filename);
+}
+
 TEST(GraphTest, ExportToDotUnweightedUndirectedGraph) {
   s21_graph graph;
   std::string input_filename = "unweighted_undirected.txt";
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "graph_binary.h"
+
+/**
+ * @brief Namespace for the fixtures the test suites share.
+ */
+namespace s21_test {
+
+/**
+ * @brief Loads a random weighted directed graph without self-loops from a
+ * matrix file: each pair gets an edge with probability 1 / one_in, weighing
+ * 1 to max_weight. The same seed gives the same graph.
+ */
+inline void LoadRandomGraph(s21_graph& graph, int size, unsigned seed,
+                            int one_in, int max_weight) {
+  std::string filename = "random_graph.txt";
+  {
+    std::srand(seed);
+    std::ofstream file(filename);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        bool edge = i != j && std::rand() % one_in == 0;
+        file << (edge ? std::rand() % max_weight + 1 : 0) << ' ';
+      }
+      file << '\n';
+    }
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+}
+
+/**
+ * @brief Edits a binary file in place and fixes its checksum, so only the
+ * checks of the fields can reject it.
+ * @tparam Header The header the file starts with; it has payload_bytes and
+ * a checksum over that many bytes after it and the header.
+ * @param edit Called as edit(header, payload) with a copy of the header and
+ * the bytes after it.
+ */
+template <typename Header, typename Edit>
+void RewriteBinary(const std::string& filename, Edit&& edit) {
+  std::vector<char> bytes(std::filesystem::file_size(filename));
+  std::ifstream(filename, std::ios::binary)
+      .read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  Header header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  char* payload = bytes.data() + sizeof(header);
+  edit(header, payload);
+  s21::BinaryChecksum checksum;
+  checksum.Update(payload, header.payload_bytes);
+  header.checksum = s21::BinaryFileChecksum(checksum, header);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+  std::ofstream(filename, std::ios::binary | std::ios::trunc)
+      .write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+}  // namespace s21_test
@@ -0,0 +1,65 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace s21 {
+
+#ifndef _WIN32
+
+MappedFile::MappedFile(const std::string& filename, bool sequential) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::logic_error("Failed to open the file!");
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    close(fd);
+    throw std::logic_error("Failed to open the file!");
+  }
+  size_ = static_cast<std::size_t>(info.st_size);
+  if (size_ > 0) {
+    void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) {
+      close(fd);
+      throw std::logic_error("Failed to map the file!");
+    }
+    madvise(address, size_, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+    data_ = static_cast<const char*>(address);
+  }
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename, bool) {
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    throw std::logic_error("Failed to open the file!");
+  }
+  size_ = static_cast<std::size_t>(file.tellg());
+  buffer_.resize(size_);
+  file.seekg(0);
+  file.read(buffer_.data(), static_cast<std::streamsize>(size_));
+  data_ = size_ > 0 ? buffer_.data() : nullptr;
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif
+
+}  // namespace s21
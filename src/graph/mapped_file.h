@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @brief Read-only view of a whole file mapped into memory.
+ *
+ * On POSIX systems the file is mapped with mmap, so the contents are paged in
+ * on demand and never copied. Elsewhere the file is read into a buffer once.
+ * The mapping lives as long as the object.
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Maps a file.
+   * @param filename The path to the file.
+   * @param sequential Hint that the file will be read front to back once.
+   * @throw std::logic_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::string& filename, bool sequential = false);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedFile();
+
+  /**
+   * @brief Gets the first byte of the file (nullptr for an empty file).
+   */
+  const char* Data() const { return data_; }
+
+  /**
+   * @brief Gets the file size in bytes.
+   */
+  std::size_t Size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;  ///< Start of the mapped contents.
+  std::size_t size_ = 0;        ///< Number of mapped bytes.
+  std::vector<char> buffer_;    ///< File contents when mmap is unavailable.
+};
+
+}  // namespace s21
@@ -1,23 +1,55 @@
 #include "graph_algorithms.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <iomanip>
 #include <stdexcept>
+#include <string>
 
+#include "../utils/parallel.h"
 #include "../utils/timer.h"
+#include "graph_sp_astar.h"
+#include "graph_sp_bidirectional.h"
+#include "graph_sp_delta.h"
+#include "graph_sp_dijkstra.h"
+#include "graph_sp_floyd.h"
+#include "graph_sp_msbfs.h"
 #include "graph_tsp_aco.h"
 #include "graph_tsp_bf.h"
 #include "graph_tsp_nn.h"
 
-std::vector<int> s21_graph_algorithms::DepthFirstSearch(s21_graph& graph,
-                                                        int start_vertex) {
+namespace {
+
+/**
+ * @brief Sorts a batch of neighbours, given by storage id, by original id.
+ *
+ * The searches expand vertices in storage order, which differs from the
+ * original order once a vertex order is set; sorting every batch keeps the
+ * result independent of the layout.
+ */
+template <typename Iterator>
+void SortByOriginalId(const s21_graph& graph, Iterator first, Iterator last) {
+  std::sort(first, last, [&graph](int a, int b) {
+    return graph.OriginalId(a) < graph.OriginalId(b);
+  });
+}
+
+}  // namespace
+
+std::vector<int> s21_graph_algorithms::DepthFirstSearch(
+    const s21_graph& graph, int start_vertex) {
   std::vector<int> path;
   if (!CheckVertex(graph, start_vertex)) {
     return path;
   }
   s21::stack<int> stack;
   std::vector<bool> visited(graph.Size(), false);
+  std::vector<int> neighbors;
+  const bool reordered = graph.GetVertexOrder() != VertexOrder::kOriginal;
 
-  stack.push(start_vertex);
+  // the search runs on storage ids, so reordered graphs are read in order
+  stack.push(graph.StorageId(start_vertex));
 
   while (!stack.empty()) {
     int curr = stack.top();
@@ -27,142 +59,499 @@ std::vector<int> s21_graph_algorithms::DepthFirstSearch(s21_graph& graph,
     path.push_back(curr);
     visited[curr] = true;
 
-    for (int i = graph.Size() - 1; i >= 0; --i) {
-      if (graph(curr, i) > 0 && !visited[i]) {
-        stack.push(i);
+    // pushed in reverse so that the smallest neighbour is visited first
+    neighbors.clear();
+    graph.ForEachStoredNeighbor(curr, [&](int i, int) {
+      if (!visited[i]) neighbors.push_back(i);
+    });
+    if (reordered) SortByOriginalId(graph, neighbors.begin(), neighbors.end());
+    for (auto it = neighbors.rbegin(); it != neighbors.rend(); ++it) {
+      stack.push(*it);
+    }
+  }
+  for (int& vertex : path) vertex = graph.OriginalId(vertex);
+  return path;
+}
+
+namespace {
+
+/**
+ * @brief Breadth-first search over a bit-packed adjacency.
+ *
+ * The path doubles as the queue. The neighbours of a dequeued vertex are
+ * found a word at a time by TakeUnvisited (row AND unvisited, then unvisited
+ * AND NOT row), so a dense row costs V / 64 word operations instead of V
+ * cell checks. Only the words between the first and the last unvisited one
+ * are scanned, and the search ends as soon as every vertex is reached.
+ * Vertices come out in the same order as from the queue-based search; when
+ * the graph is reordered, the vertices found from each row are sorted by
+ * their original ids.
+ */
+std::vector<int> BitsetBreadthFirstSearch(const s21_graph& graph,
+                                          const s21::BitMatrix& adjacency,
+                                          int start_vertex) {
+  using Word = s21::BitMatrix::Word;
+  constexpr int kBits = s21::BitMatrix::kWordBits;
+  const int size = adjacency.Size();
+  const bool reordered = graph.GetVertexOrder() != VertexOrder::kOriginal;
+  std::size_t first = 0;
+  std::size_t last = s21::BitMatrix::RowStride(size);
+  std::vector<Word> unvisited(last, ~Word{0});
+  std::vector<Word> found(last, 0);
+  if (size % kBits != 0) unvisited[last - 1] = (Word{1} << (size % kBits)) - 1;
+  unvisited[start_vertex / kBits] &= ~(Word{1} << (start_vertex % kBits));
+
+  std::vector<int> path{start_vertex};
+  path.reserve(size);
+  for (std::size_t head = 0; head < path.size(); ++head) {
+    while (first < last && unvisited[first] == 0) ++first;
+    while (last > first && unvisited[last - 1] == 0) --last;
+    if (first == last) break;  // everything is reached
+    s21::TakeUnvisited(adjacency.Row(path[head]), unvisited.data(),
+                       found.data(), first, last);
+    const std::size_t batch = path.size();
+    for (std::size_t w = first; w < last; ++w) {
+      for (Word bits = found[w]; bits != 0; bits &= bits - 1) {
+        path.push_back(static_cast<int>(w * kBits + std::countr_zero(bits)));
       }
     }
+    if (reordered) SortByOriginalId(graph, path.begin() + batch, path.end());
   }
   return path;
 }
 
-std::vector<int> s21_graph_algorithms::BreadthFirstSearch(s21_graph& graph,
-                                                          int start_vertex) {
+}  // namespace
+
+std::vector<int> s21_graph_algorithms::BreadthFirstSearch(
+    const s21_graph& graph, int start_vertex) {
   std::vector<int> path;
   if (!CheckVertex(graph, start_vertex)) {
     return path;
   }
-  s21::queue<int> queue;
-  std::vector<bool> visited(graph.Size(), 0);
-
-  queue.push(start_vertex);
-  visited[start_vertex] = true;
-
-  while (!queue.empty()) {
-    int curr = queue.front();
-    queue.pop();
-    path.push_back(curr);
-
-    for (int i = 0; i < graph.Size(); ++i) {
-      if (graph(curr, i) > 0 && !visited[i]) {
-        queue.push(i);
-        visited[i] = true;
+  // the search runs on storage ids, so reordered graphs are read in order
+  const int start = graph.StorageId(start_vertex);
+  if (graph.GetLayout() == GraphLayout::kBitPacked) {
+    path = graph.VisitStorage([&graph, start](const auto& data) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(data)>,
+                                   s21::BitMatrix>) {
+        return BitsetBreadthFirstSearch(graph, data, start);
+      } else {
+        return std::vector<int>{};  // unreachable
+      }
+    });
+  } else {
+    s21::queue<int> queue;
+    std::vector<bool> visited(graph.Size(), 0);
+    std::vector<int> neighbors;
+    const bool reordered = graph.GetVertexOrder() != VertexOrder::kOriginal;
+
+    queue.push(start);
+    visited[start] = true;
+
+    while (!queue.empty()) {
+      int curr = queue.front();
+      queue.pop();
+      path.push_back(curr);
+
+      neighbors.clear();
+      graph.ForEachStoredNeighbor(curr, [&](int i, int) {
+        if (!visited[i]) {
+          neighbors.push_back(i);
+          visited[i] = true;
+        }
+      });
+      if (reordered) {
+        SortByOriginalId(graph, neighbors.begin(), neighbors.end());
       }
+      for (int neighbor : neighbors) queue.push(neighbor);
     }
   }
+  for (int& vertex : path) vertex = graph.OriginalId(vertex);
   return path;
 }
 
 std::pair<int, std::vector<int>>
-s21_graph_algorithms::GetShortestPathBetweenVertices(s21_graph& graph,
-                                                     int start, int finish) {
+s21_graph_algorithms::GetShortestPathBetweenVertices(
+    const s21_graph& graph, int start, int finish,
+    ShortestPathAlgorithm algorithm) {
   std::vector<int> path;
   if (!CheckVertex(graph, start) || !CheckVertex(graph, finish) ||
       start == finish) {
     return {-1, path};
   }
 
-  std::vector<int> distance(graph.Size(), kIntMax);
-  std::vector<int> previous(graph.Size(), -1);
-  std::vector<bool> visited(graph.Size(), false);
-  s21::queue<int> queue;
+  start = graph.StorageId(start);
+  finish = graph.StorageId(finish);
+  Distance distance = s21_sp::kUnreached;
+  if (algorithm == ShortestPathAlgorithm::kBidirectional) {
+    // undirected graphs are their own reverse
+    std::shared_ptr<const SparseGraphData> reverse;
+    if (!graph.GetMetadata().IsSymmetric()) reverse = graph.GetReverse();
+    s21_sp::VisitSparseView(graph, [&](const auto& view) {
+      auto run = [&](const auto& backward) {
+        s21_sp::BidirectionalDijkstra engine(view, backward);
+        distance = engine.Run(start, finish);
+        path = engine.Path();
+      };
+      if (reverse == nullptr) {
+        run(view);
+      } else {
+        run(*reverse);
+      }
+    });
+  } else {
+    // small integer weights get Dial's bucket queue instead of the heap
+    s21_sp::VisitSparseView(graph, [&](const auto& view) {
+      s21_sp::VisitDijkstra(
+          view, graph.GetMetadata().max_weight, [&](auto& engine) {
+            distance = engine.Run(start, finish);
+            path = engine.Path(finish);
+          });
+    });
+  }
+  if (distance == s21_sp::kUnreached) return {-1, {}};  // not found
 
-  distance[start] = 0;
-  previous[start] = start;
-  queue.push(start);
-  visited[start] = true;
+  for (int& vertex : path) vertex = graph.OriginalId(vertex);
+  return {s21_sp::NarrowDistance(distance), path};
+}
 
-  while (!queue.empty()) {
-    int curr = queue.front();
-    queue.pop();
+std::pair<int, std::vector<int>>
+s21_graph_algorithms::GetShortestPathBetweenVertices(
+    const s21_graph& graph, int start, int finish,
+    const s21_sp::LandmarkIndex& landmarks) {
+  if (!landmarks.Matches(graph)) {
+    throw std::invalid_argument(
+        "The landmark index was built for another graph!");
+  }
+  std::vector<int> path;
+  if (!CheckVertex(graph, start) || !CheckVertex(graph, finish) ||
+      start == finish) {
+    return {-1, path};
+  }
 
-    for (int i = 0; i < graph.Size(); ++i) {
-      int weight = graph(curr, i);
-      if (weight > 0) {
-        if (!visited[i]) {
-          queue.push(i);
-          visited[i] = true;
-        }
-        if (distance[curr] + weight < distance[i]) {
-          distance[i] = distance[curr] + weight;
-          previous[i] = curr;
-        }
+  start = graph.StorageId(start);
+  finish = graph.StorageId(finish);
+  s21_sp::LandmarkPotential potential(landmarks, graph, finish);
+  Distance distance = s21_sp::kUnreached;
+  s21_sp::VisitSparseView(graph, [&](const auto& view) {
+    s21_sp::AStar engine(view);
+    distance = engine.Run(start, finish, potential);
+    path = engine.Path(finish);
+  });
+  if (distance == s21_sp::kUnreached) return {-1, {}};  // not found
+
+  for (int& vertex : path) vertex = graph.OriginalId(vertex);
+  return {s21_sp::NarrowDistance(distance), path};
+}
+
+std::pair<int, std::vector<int>>
+s21_graph_algorithms::GetShortestPathBetweenVertices(
+    const s21_graph& graph, int start, int finish,
+    const s21_sp::ContractionHierarchy& hierarchy) {
+  if (!hierarchy.Matches(graph)) {
+    throw std::invalid_argument(
+        "The contraction hierarchy was built for another graph!");
+  }
+  if (!CheckVertex(graph, start) || !CheckVertex(graph, finish) ||
+      start == finish) {
+    return {-1, {}};
+  }
+
+  // the hierarchy is keyed by original ids, so no translation is needed
+  s21_sp::ContractionQuery query(hierarchy);
+  Distance distance = query.Run(start, finish);
+  if (distance == s21_sp::kUnreached) return {-1, {}};  // not found
+  return {s21_sp::NarrowDistance(distance), query.Path()};
+}
+
+ShortestPathTree s21_graph_algorithms::GetShortestPathTree(
+    const s21_graph& graph, int source) {
+  if (!CheckVertex(graph, source)) {
+    throw std::out_of_range("Vertex " + std::to_string(source) +
+                            " does not exist!");
+  }
+  const int size = graph.Size();
+  ShortestPathTree tree{std::vector<int>(size, -1),
+                        std::vector<int>(size, -1)};
+  const s21::GraphMetadata& metadata = graph.GetMetadata();
+  const Distance delta = s21_sp::ChooseDelta(metadata);
+  s21_sp::VisitSparseView(graph, [&](const auto& view) {
+    s21_sp::DeltaStepping engine(view, delta, metadata.max_weight);
+    engine.Run(graph.StorageId(source));
+    for (int v = 0; v < size; ++v) {
+      Distance distance = engine.DistanceTo(v);
+      if (distance == s21_sp::kUnreached) continue;
+      const int vertex = graph.OriginalId(v);
+      tree.distances[vertex] = s21_sp::NarrowDistance(distance);
+      if (engine.Previous(v) >= 0) {
+        tree.previous[vertex] = graph.OriginalId(engine.Previous(v));
+      }
+    }
+  });
+  return tree;
+}
+
+DistanceTable s21_graph_algorithms::GetDistanceTable(
+    const s21_graph& graph, const std::vector<int>& sources,
+    const std::vector<int>& targets) {
+  for (const auto* list : {&sources, &targets}) {
+    for (int vertex : *list) {
+      if (!CheckVertex(graph, vertex)) {
+        throw std::out_of_range("The distance table asks for vertex " +
+                                std::to_string(vertex) +
+                                " that does not exist!");
       }
     }
   }
+  DistanceTable table;
+  table.sources = static_cast<int>(sources.size());
+  table.targets = static_cast<int>(targets.size());
+  table.distances.assign(sources.size() * targets.size(), -1);
+  if (table.distances.empty()) return table;
+
+  // repeated targets are settled once, so the search counts distinct ones
+  std::vector<char> is_target(graph.Size());
+  std::vector<int> columns(targets.size());
+  std::size_t distinct = 0;
+  for (std::size_t j = 0; j < targets.size(); ++j) {
+    columns[j] = graph.StorageId(targets[j]);
+    if (!is_target[columns[j]]) ++distinct;
+    is_target[columns[j]] = 1;
+  }
 
-  if (distance[finish] == kIntMax) return {-1, path};  // not found
+  s21_sp::VisitSparseView(graph, [&](const auto& view) {
+    std::atomic<std::size_t> next{0};
+    // one engine per worker is reused, labels are reset per source
+    auto worker = [&](std::size_t) {
+      s21_sp::VisitDijkstra(
+          view, graph.GetMetadata().max_weight, [&](auto& engine) {
+            for (std::size_t i = next++; i < sources.size(); i = next++) {
+              engine.RunToAll(graph.StorageId(sources[i]), is_target,
+                              distinct);
+              int* row = &table.distances[i * targets.size()];
+              for (std::size_t j = 0; j < targets.size(); ++j) {
+                Distance distance = engine.DistanceTo(columns[j]);
+                if (distance != s21_sp::kUnreached) {
+                  row[j] = s21_sp::NarrowDistance(distance);
+                }
+              }
+            }
+          });
+    };
+    s21::ParallelFor(std::min<std::size_t>(s21::WorkerCount(), sources.size()),
+                     worker);
+  });
+  return table;
+}
 
-  for (int i = finish; i != previous[i] && previous[i] != -1; i = previous[i]) {
-    path.push_back(i);
+namespace {
+
+/**
+ * @brief Floyd-Warshall with distances of type D; kFloydInfinity<D> marks
+ * unreachable pairs.
+ *
+ * D only has to hold the sum of two shortest path lengths, so the narrowest
+ * type that does keeps the most of the matrix in cache.
+ */
+template <typename D>
+s21::DenseMatrix<D> FloydWarshall(const s21_graph& graph) {
+  const int size = graph.Size();
+  s21::DenseMatrix<D> distances(size, s21_sp::kFloydInfinity<D>);
+  for (int i = 0; i < size; ++i) {
+    D* dist = distances.Row(i);
+    graph.ForEachNeighbor(i, [dist](int j, int weight) { dist[j] = weight; });
+    dist[i] = 0;
   }
-  path.push_back(start);
-
-  std::reverse(path.begin(), path.end());
+  s21_sp::FloydWarshall(distances);
+  return distances;
+}
 
-  return {distance[finish], path};
+/**
+ * @brief Density (edges over vertices squared) below which a Dijkstra
+ * search per source beats Floyd-Warshall (see the `apsp` benchmark).
+ */
+constexpr double kAllPairsDijkstraDensity = 1.0 / 8;
+
+}  // namespace
+
+AllPairsAlgorithm s21_graph_algorithms::ChooseAllPairsAlgorithm(
+    const s21_graph& graph, AllPairsAlgorithm algorithm) {
+  const s21::GraphMetadata& metadata = graph.GetMetadata();
+  if (algorithm == AllPairsAlgorithm::kAuto) {
+    if (!metadata.IsWeighted()) return AllPairsAlgorithm::kBreadthFirst;
+    return metadata.density < kAllPairsDijkstraDensity
+               ? AllPairsAlgorithm::kDijkstra
+               : AllPairsAlgorithm::kFloydWarshall;
+  }
+  if (algorithm == AllPairsAlgorithm::kBreadthFirst && metadata.IsWeighted()) {
+    throw std::invalid_argument(
+        "Breadth-first all-pairs search is only applicable to unweighted "
+        "graphs!");
+  }
+  return algorithm;
 }
 
-std::vector<std::vector<int>>
-s21_graph_algorithms::GetShortestPathsBetweenAllVertices(s21_graph& graph) {
-  std::vector<std::vector<int>> distances;
-  for (int i = 0; i < graph.Size(); ++i) {
-    distances.push_back(std::vector<int>());
-    for (int j = 0; j < graph.Size(); ++j) {
-      if (i == j)
-        distances[i].push_back(0);
-      else if (graph(i, j) == 0)
-        distances[i].push_back(kIntMax);
-      else
-        distances[i].push_back(graph(i, j));
-    }
+template <typename Set>
+void s21_graph_algorithms::ForEachPairDistance(const s21_graph& graph,
+                                               AllPairsAlgorithm algorithm,
+                                               Set&& set) {
+  const int size = graph.Size();
+  const s21::GraphMetadata& metadata = graph.GetMetadata();
+  if (algorithm == AllPairsAlgorithm::kBreadthFirst) {
+    s21_sp::VisitSparseView(graph, [&](const auto& view) {
+      using Bfs = s21_sp::MultiSourceBfs<std::decay_t<decltype(view)>>;
+      const int batches = (size + Bfs::kBatch - 1) / Bfs::kBatch;
+      std::atomic<int> next{0};
+      // a batch is a run of storage ids, which are near each other in the
+      // reordered layouts, so their searches share more of the frontier
+      auto worker = [&](std::size_t) {
+        Bfs bfs(view);
+        std::vector<int> sources;
+        for (int batch = next++; batch < batches; batch = next++) {
+          sources.clear();
+          int last = std::min(size, (batch + 1) * Bfs::kBatch);
+          for (int s = batch * Bfs::kBatch; s < last; ++s) sources.push_back(s);
+          bfs.Run(sources.data(), static_cast<int>(sources.size()),
+                  [&](int i, int v, int hops) {
+                    set(graph.OriginalId(sources[i]), graph.OriginalId(v),
+                        hops);
+                  });
+        }
+      };
+      s21::ParallelFor(std::min<std::size_t>(s21::WorkerCount(), batches),
+                       worker);
+    });
+    return;
+  }
+
+  if (algorithm == AllPairsAlgorithm::kDijkstra) {
+    s21_sp::VisitSparseView(graph, [&](const auto& view) {
+      std::atomic<int> next{0};
+      // rows are taken one at a time, each written by the worker that
+      // searched from its vertex
+      auto worker = [&](std::size_t) {
+        s21_sp::VisitDijkstra(view, metadata.max_weight, [&](auto& engine) {
+          for (int source = next++; source < size; source = next++) {
+            engine.Run(graph.StorageId(source));
+            for (int v = 0; v < size; ++v) {
+              Distance distance = engine.DistanceTo(v);
+              if (distance != s21_sp::kUnreached) {
+                set(source, graph.OriginalId(v),
+                    s21_sp::NarrowDistance(distance));
+              }
+            }
+          }
+        });
+      };
+      s21::ParallelFor(std::min<std::size_t>(s21::WorkerCount(), size),
+                       worker);
+    });
+    return;
   }
 
-  for (int k = 0; k < graph.Size(); ++k) {
-    for (int i = 0; i < graph.Size(); ++i) {
-      for (int j = 0; j < graph.Size(); ++j) {
-        if (distances[i][k] < kIntMax && distances[k][j] < kIntMax) {
-          distances[i][j] =
-              std::min(distances[i][j], distances[i][k] + distances[k][j]);
+  auto convert = [&](const auto& distances) {
+    using D = std::decay_t<decltype(distances(0, 0))>;
+    for (int i = 0; i < size; ++i) {
+      const D* dist = distances.Row(i);
+      for (int j = 0; j < size; ++j) {
+        if (dist[j] < s21_sp::kFloydInfinity<D>) {
+          set(i, j, s21_sp::NarrowDistance(dist[j]));
         }
       }
     }
+  };
+
+  // a shortest path has at most size - 1 edges
+  Distance longest_path =
+      Distance{metadata.max_weight} * std::max(size - 1, 0);
+  if (longest_path < s21_sp::kFloydInfinity<int>) {
+    convert(FloydWarshall<int>(graph));
+  } else {
+    convert(FloydWarshall<Distance>(graph));
   }
+}
 
-  for (int i = 0; i < graph.Size(); ++i) {
-    for (int j = 0; j < graph.Size(); ++j) {
-      if (distances[i][j] == kIntMax) distances[i][j] = 0;
-    }
+std::vector<std::vector<int>>
+s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+    const s21_graph& graph, AllPairsAlgorithm algorithm) {
+  const int size = graph.Size();
+  std::vector<std::vector<int>> result(size, std::vector<int>(size));
+  ForEachPairDistance(
+      graph, ChooseAllPairsAlgorithm(graph, algorithm),
+      [&](int i, int j, int distance) { result[i][j] = distance; });
+  return result;
+}
+
+s21_sp::AllPairsPaths s21_graph_algorithms::GetAllPairsPaths(
+    const s21_graph& graph, s21_sp::AllPairsStorage storage,
+    AllPairsAlgorithm algorithm) {
+  const int size = graph.Size();
+  algorithm = ChooseAllPairsAlgorithm(graph, algorithm);
+  s21_sp::AllPairsPaths paths(size, storage);
+  if (!paths.has_next_hops_) {
+    ForEachPairDistance(graph, algorithm, [&](int i, int j, int distance) {
+      paths.distances_[paths.Cell(i, j)] = distance;
+    });
+    return paths;
   }
 
-  return distances;
+  const int max_weight = graph.GetMetadata().max_weight;
+  std::visit(
+      [&](auto& hops) {
+        using Hop = typename std::decay_t<decltype(hops)>::value_type;
+        s21_sp::VisitSparseView(graph, [&](const auto& view) {
+          std::atomic<int> next{0};
+          auto worker = [&](std::size_t) {
+            std::vector<int> first_hop(size);  // by storage id
+            s21_sp::VisitDijkstra(view, max_weight, [&](auto& engine) {
+              for (int source = next++; source < size; source = next++) {
+                const int start = graph.StorageId(source);
+                Hop* hop_row = &hops[paths.Cell(source, 0)];
+                int* distance_row =
+                    paths.has_distances_
+                        ? &paths.distances_[paths.Cell(source, 0)]
+                        : nullptr;
+                // a vertex settles after its predecessor, whose first hop
+                // it shares unless the predecessor is the source
+                engine.RunSettling(start, [&](int v) {
+                  const int target = graph.OriginalId(v);
+                  if (distance_row != nullptr) {
+                    distance_row[target] =
+                        s21_sp::NarrowDistance(engine.DistanceTo(v));
+                  }
+                  if (v == start) return;
+                  const int previous = engine.Previous(v);
+                  first_hop[v] = previous == start ? v : first_hop[previous];
+                  hop_row[target] =
+                      static_cast<Hop>(graph.OriginalId(first_hop[v]));
+                });
+              }
+            });
+          };
+          s21::ParallelFor(std::min<std::size_t>(s21::WorkerCount(), size),
+                           worker);
+        });
+      },
+      paths.next_hops_);
+  return paths;
 }
 
 std::pair<int, std::vector<std::vector<int>>>
-s21_graph_algorithms::GetLeastSpanningTree(s21_graph& graph) {
+s21_graph_algorithms::GetLeastSpanningTree(const s21_graph& graph) {
   if (graph.GetType() != GraphType::kWeightedUndirected ||
-      BreadthFirstSearch(graph, 0).size() != graph.Size()) {
+      !graph.GetMetadata().IsConnected()) {
     throw std::invalid_argument(
         "Prim's algorithm is only applicable to connected, weighted, "
         "undirected graphs!");
   }
-  std::vector<std::vector<int>> res(graph.Size(),
-                                    std::vector<int>(graph.Size(), 0));
-  if (graph.Size() == 0) return {0, res};
+  const int size = graph.Size();
+  std::vector<std::vector<int>> res(size, std::vector<int>(size, 0));
+  if (size == 0) return {0, res};
 
-  std::vector<int> key(graph.Size(), kIntMax);
-  std::vector<bool> visited(graph.Size(), false);  // добавлено в дерево
-  std::vector<int> parents(graph.Size(), -1);  // с кем связаны вершины
+  // kUnreached lies above every int weight, so an edge of kIntMax is taken
+  std::vector<Distance> key(size, s21_sp::kUnreached);
+  std::vector<bool> visited(size, false);  // добавлено в дерево
+  std::vector<int> parents(size, -1);      // с кем связаны вершины
 
   std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
                       std::greater<std::pair<int, int>>>
@@ -172,7 +561,7 @@ s21_graph_algorithms::GetLeastSpanningTree(s21_graph& graph) {
   key[0] = 0;
   edges_heap.push(std::make_pair(0, 0));
 
-  int weight_sum = 0;
+  Distance weight_sum = 0;
 
   while (!edges_heap.empty()) {
     auto curr = edges_heap.top();
@@ -182,28 +571,27 @@ s21_graph_algorithms::GetLeastSpanningTree(s21_graph& graph) {
 
     visited[curr.second] = true;
     weight_sum += curr.first;
-    for (int i = 0; i < graph.Size(); ++i) {
-      int edge = graph(curr.second, i);
-      if (edge != 0 && !visited[i] && edge < key[i]) {
+    graph.ForEachNeighbor(curr.second, [&](int i, int edge) {
+      if (!visited[i] && edge < key[i]) {
         key[i] = edge;
         parents[i] = curr.second;
         edges_heap.push(std::make_pair(edge, i));
       }
-    }
+    });
   }
 
   for (int i = 0; i < parents.size(); ++i) {
     if (parents[i] != -1) {
-      res[i][parents[i]] = graph(i, parents[i]);
+      res[i][parents[i]] = static_cast<int>(key[i]);
       res[parents[i]][i] = res[i][parents[i]];
     }
   }
 
-  return {weight_sum, res};
+  return {s21_sp::NarrowDistance(weight_sum), res};
 }
 
 TsmResult s21_graph_algorithms::SolveTravelingSalesmanProblem(
-    s21_graph& graph, TSPAlgorithm algorithm) {
+    const s21_graph& graph, TSPAlgorithm algorithm) {
   if (graph.Size() <= 1) {
     // Handle trivial cases or throw an error if a tour needs >1 city
     if (graph.Size() == 1) {
@@ -217,6 +605,15 @@ TsmResult s21_graph_algorithms::SolveTravelingSalesmanProblem(
     }
   }
 
+  // a tour reaches every vertex from every other, so the solvers need not
+  // search without one; complete graphs always have one and skip the check
+  const s21::GraphMetadata& metadata = graph.GetMetadata();
+  if (!metadata.IsComplete() &&
+      (!metadata.IsConnected() ||
+       (!metadata.IsSymmetric() && !IsStronglyConnected(graph)))) {
+    throw std::invalid_argument("TSP requires a strongly connected graph.");
+  }
+
   try {
     switch (algorithm) {
       case TSPAlgorithm::ACO: {
@@ -268,4 +665,30 @@ TsmResult s21_graph_algorithms::SolveTravelingSalesmanProblem(
 bool s21_graph_algorithms::CheckVertex(const s21_graph& graph, int vertex) {
   if (vertex < 0 || vertex >= graph.Size()) return false;
   return true;
+}
+
+bool s21_graph_algorithms::IsStronglyConnected(const s21_graph& graph) {
+  const int size = graph.Size();
+  if (static_cast<int>(BreadthFirstSearch(graph, 0).size()) != size) {
+    return false;
+  }
+  // every vertex reaches 0 if 0 reaches every vertex of the reversed graph
+  auto reverse = graph.GetReverse();
+  std::vector<bool> visited(size, false);
+  s21::stack<int> stack;
+  stack.push(graph.StorageId(0));
+  visited[graph.StorageId(0)] = true;
+  int reached = 1;
+  while (!stack.empty()) {
+    int curr = stack.top();
+    stack.pop();
+    for (int next : reverse->Neighbors(curr)) {
+      if (!visited[next]) {
+        visited[next] = true;
+        ++reached;
+        stack.push(next);
+      }
+    }
+  }
+  return reached == size;
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 #pragma once
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <queue>
 #include <vector>
 
 #include "../containers/s21_containers.h"
 #include "../graph/graph.h"
+#include "graph_sp_ch.h"
+#include "graph_sp_landmarks.h"
+#include "graph_sp_paths.h"
 
 /**
  * @brief Structure to store the result of the Traveling Salesman Problem.
@@ -16,6 +20,31 @@ struct TsmResult {
   double distance = 0;  ///< The length of this route.
 };
 
+/**
+ * @brief Shortest distances from a list of sources to a list of targets.
+ */
+struct DistanceTable {
+  int sources = 0;  ///< Number of rows.
+  int targets = 0;  ///< Number of columns.
+  std::vector<int> distances;  ///< Row-major cells, -1 where there is no path.
+
+  /**
+   * @brief Gets the distance from the i-th source to the j-th target.
+   */
+  int operator()(int i, int j) const {
+    return distances[static_cast<std::size_t>(i) * targets + j];
+  }
+};
+
+/**
+ * @brief Shortest paths from one source to every vertex.
+ */
+struct ShortestPathTree {
+  std::vector<int> distances;  ///< By vertex, -1 where there is no path.
+  std::vector<int> previous;   ///< Vertex before each on a shortest path, -1
+                               ///< for the source and unreachable vertices.
+};
+
 /**
  * @brief Enumerates the algorithms available for solving the Traveling Salesman
  * Problem.
@@ -26,6 +55,25 @@ enum class TSPAlgorithm {
   BRUTE_FORCE        ///< Brute Force algorithm.
 };
 
+/**
+ * @brief Enumerates the algorithms available for point-to-point shortest
+ * paths.
+ */
+enum class ShortestPathAlgorithm {
+  kDijkstra,      ///< One search from the start (s21_sp::Dijkstra).
+  kBidirectional  ///< Searches from both ends (s21_sp::BidirectionalDijkstra).
+};
+
+/**
+ * @brief Enumerates the algorithms available for all-pairs shortest paths.
+ */
+enum class AllPairsAlgorithm {
+  kAuto,           ///< Picks one by the density of the graph.
+  kFloydWarshall,  ///< Blocked Floyd-Warshall (s21_sp::FloydWarshall).
+  kDijkstra,       ///< One Dijkstra search per source, in parallel.
+  kBreadthFirst    ///< Batched BFS (s21_sp::MultiSourceBfs), unweighted only.
+};
+
 /**
  * @brief A class containing algorithms for graph processing.
  *
@@ -35,46 +83,182 @@ enum class TSPAlgorithm {
  */
 class s21_graph_algorithms {
  public:
+  /**
+   * @brief Type used to add up edge weights along paths and trees.
+   *
+   * Wider than the stored weights, so sums cannot overflow; results are
+   * checked when they are narrowed to int for the public interface.
+   */
+  using Distance = std::int64_t;
+
   /**
    * @brief Performs a Depth First Search on the graph.
+   *
+   * Neighbours are visited from the smallest original id, so the result
+   * does not depend on the vertex order (see s21_graph::SetVertexOrder).
    * @param graph The graph to search.
-   * @param start_vertex The vertex to start the search from (1-indexed).
-   * @return A vector of visited vertices in DFS order.
-   * @throw std::out_of_range if start_vertex is invalid.
+   * @param start_vertex The vertex to start the search from (0-based,
+   * original id).
+   * @return A vector of visited vertices in DFS order. An empty vector if
+   * start_vertex does not exist.
    */
-  static std::vector<int> DepthFirstSearch(s21_graph& graph, int start_vertex);
+  static std::vector<int> DepthFirstSearch(const s21_graph& graph,
+                                           int start_vertex);
 
   /**
    * @brief Performs a Breadth First Search on the graph.
+   *
+   * Bit-packed graphs (GraphLayout::kBitPacked) are searched with word-wide
+   * set operations on the rows; the order of the result is the same. The
+   * neighbours of a vertex are queued by original id, whatever the vertex
+   * order.
    * @param graph The graph to search.
-   * @param start_vertex The vertex to start the search from (1-indexed).
-   * @return A vector of visited vertices in BFS order.
-   * @throw std::out_of_range if start_vertex is invalid.
+   * @param start_vertex The vertex to start the search from (0-based,
+   * original id).
+   * @return A vector of visited vertices in BFS order. An empty vector if
+   * start_vertex does not exist.
    */
-  static std::vector<int> BreadthFirstSearch(s21_graph& graph,
+  static std::vector<int> BreadthFirstSearch(const s21_graph& graph,
                                              int start_vertex);
   /**
    * @brief Finds the shortest path between two vertices using Dijkstra's
    * algorithm.
+   *
+   * The search uses an indexed heap and stops as soon as vertex2 is
+   * settled, so it only explores the vertices closer than vertex2
+   * (see s21_sp::Dijkstra). The bidirectional search also searches back
+   * from vertex2 and usually explores fewer vertices on large graphs; the
+   * distance is the same, the path may differ among equally short ones.
+   * @param graph The graph to search.
+   * @param vertex1 The starting vertex (0-based).
+   * @param vertex2 The ending vertex (0-based).
+   * @param algorithm The search to use.
+   * @return A pair containing the shortest distance and the path (vector of
+   * vertices). If no path exists, either vertex is out of range or they are
+   * the same vertex, the distance is -1 and the path is empty.
+   */
+  static std::pair<int, std::vector<int>> GetShortestPathBetweenVertices(
+      const s21_graph& graph, int vertex1, int vertex2,
+      ShortestPathAlgorithm algorithm = ShortestPathAlgorithm::kDijkstra);
+
+  /**
+   * @brief Finds the shortest path between two vertices with A* guided by
+   * landmark lower bounds (ALT).
+   *
+   * On large graphs the search settles a fraction of the vertices Dijkstra's
+   * algorithm does. Build the index once with s21_sp::LandmarkIndex::Build,
+   * or map a saved one with s21_sp::LandmarkIndex::Load.
    * @param graph The graph to search.
-   * @param vertex1 The starting vertex (1-indexed).
-   * @param vertex2 The ending vertex (1-indexed).
+   * @param vertex1 The starting vertex (0-based).
+   * @param vertex2 The ending vertex (0-based).
+   * @param landmarks A landmark index of the graph.
+   * @return As for the other overload.
+   * @throw std::invalid_argument if the index was built for another graph.
+   */
+  static std::pair<int, std::vector<int>> GetShortestPathBetweenVertices(
+      const s21_graph& graph, int vertex1, int vertex2,
+      const s21_sp::LandmarkIndex& landmarks);
+
+  /**
+   * @brief Finds the shortest path between two vertices on a contraction
+   * hierarchy.
+   *
+   * The two upward searches settle a few hundred vertices even on large
+   * road-like graphs. Build the hierarchy once with
+   * s21_sp::ContractionHierarchy::Build, or map a saved one with
+   * s21_sp::ContractionHierarchy::Load.
+   * @param graph The graph to search.
+   * @param vertex1 The starting vertex (0-based).
+   * @param vertex2 The ending vertex (0-based).
+   * @param hierarchy A contraction hierarchy of the graph.
    * @return A pair containing the shortest distance and the path (vector of
-   * vertices). If no path exists, distance is infinity and path is empty.
-   * @throw std::out_of_range if vertex1 or vertex2 is invalid.
+   * vertices). If no path exists, either vertex is out of range or they are
+   * the same vertex, the distance is -1 and the path is empty.
+   * @throw std::invalid_argument if the hierarchy was built for another
+   * graph.
    */
   static std::pair<int, std::vector<int>> GetShortestPathBetweenVertices(
-      s21_graph& graph, int vertex1, int vertex2);
+      const s21_graph& graph, int vertex1, int vertex2,
+      const s21_sp::ContractionHierarchy& hierarchy);
+
+  /**
+   * @brief Finds the shortest paths from one vertex to all others with
+   * parallel delta-stepping (s21_sp::DeltaStepping).
+   *
+   * The bucket width is chosen from the edge weights (s21_sp::ChooseDelta).
+   * Each phase relaxes its vertices on up to s21::WorkerCount() threads.
+   * @param graph The graph to search.
+   * @param source The starting vertex.
+   * @return The distance and the previous vertex of every vertex.
+   * @throw std::out_of_range if source does not exist.
+   * @throw std::overflow_error if a distance does not fit an int.
+   */
+  static ShortestPathTree GetShortestPathTree(const s21_graph& graph,
+                                              int source);
+
+  /**
+   * @brief Finds the shortest distances from every source to every target.
+   *
+   * Each source gets one Dijkstra search that stops once all targets are
+   * settled, so a table costs a search per source rather than per pair.
+   * Sources are searched in parallel on up to s21::WorkerCount() threads.
+   * @param graph The graph to search.
+   * @param sources The rows of the table (vertex ids).
+   * @param targets The columns of the table (vertex ids); may repeat.
+   * @return The table; -1 where a target cannot be reached.
+   * @throw std::out_of_range if a vertex does not exist.
+   * @throw std::overflow_error if a distance does not fit an int.
+   */
+  static DistanceTable GetDistanceTable(const s21_graph& graph,
+                                        const std::vector<int>& sources,
+                                        const std::vector<int>& targets);
 
   /**
-   * @brief Finds the shortest paths between all pairs of vertices using
-   * Floyd-Warshall algorithm.
+   * @brief Finds the shortest paths between all pairs of vertices.
+   *
+   * Floyd-Warshall costs O(V^3) whatever the edges; a Dijkstra search per
+   * source costs O(V (E + V log V)), which is less on sparse graphs. The
+   * searches run on up to s21::WorkerCount() threads, each writing its own
+   * rows. On unweighted graphs distances are hop counts, and breadth-first
+   * searches from 256 sources at once share every pass over the edges.
+   * kAuto picks the batched BFS on unweighted graphs, and otherwise Dijkstra
+   * on graphs with few edges for their vertices.
    * @param graph The graph to process.
+   * @param algorithm The algorithm to use.
    * @return A matrix where element (i, j) is the shortest distance from vertex
-   * i to vertex j. std::numeric_limits<int>::max() indicates no path.
+   * i to vertex j, 0 if there is no path.
+   * @throw std::invalid_argument if kBreadthFirst is asked for a weighted
+   * graph.
+   * @throw std::overflow_error if a distance does not fit an int.
    */
   static std::vector<std::vector<int>> GetShortestPathsBetweenAllVertices(
-      s21_graph& graph);
+      const s21_graph& graph,
+      AllPairsAlgorithm algorithm = AllPairsAlgorithm::kAuto);
+
+  /**
+   * @brief Finds the shortest paths between all pairs of vertices and keeps
+   * the first step of each, so any path can be followed without a search.
+   *
+   * Only the matrices asked for are allocated. Distances alone are found
+   * as by GetShortestPathsBetweenAllVertices and written straight into
+   * their matrix. Next hops come from a Dijkstra search per source (on a
+   * bucket queue for small weights, so a breadth-first search on
+   * unweighted graphs), run on up to s21::WorkerCount() threads that each
+   * fill their own rows: as the search settles v, the first hop to v is v
+   * if v was reached straight from the source, and the first hop to its
+   * predecessor otherwise. The distances, if kept, come from the same
+   * searches.
+   * @param graph The graph to process.
+   * @param storage The matrices to keep.
+   * @param algorithm The algorithm that finds distances alone; next hops
+   * always need the searches, which keep a predecessor tree.
+   * @return The distances and/or next hops (see s21_sp::AllPairsPaths).
+   * @throw As GetShortestPathsBetweenAllVertices.
+   */
+  static s21_sp::AllPairsPaths GetAllPairsPaths(
+      const s21_graph& graph,
+      s21_sp::AllPairsStorage storage = s21_sp::AllPairsStorage::kBoth,
+      AllPairsAlgorithm algorithm = AllPairsAlgorithm::kAuto);
 
   /**
    * @brief Finds the Least Spanning Tree of the graph using Prim's algorithm.
@@ -84,7 +268,7 @@ class s21_graph_algorithms {
    * disconnected and unable to form a single tree, or not weighted undirected).
    */
   static std::pair<int, std::vector<std::vector<int>>> GetLeastSpanningTree(
-      s21_graph& graph);
+      const s21_graph& graph);
 
   /**
    * @brief Solves the Traveling Salesman Problem for the given graph.
@@ -92,11 +276,11 @@ class s21_graph_algorithms {
    * @param algorithm The algorithm to use (ACO, Nearest Neighbor, Brute Force).
    * @return A TsmResult struct containing the best route found and its
    * distance.
-   * @throw std::invalid_argument if the graph is not suitable for TSP (e.g.,
-   * not complete, or has 0 vertices).
+   * @throw std::invalid_argument if the graph has 0 vertices or no tour can
+   * exist because some vertex cannot reach another.
    */
   static TsmResult SolveTravelingSalesmanProblem(
-      s21_graph& graph, TSPAlgorithm algorithm = TSPAlgorithm::ACO);
+      const s21_graph& graph, TSPAlgorithm algorithm = TSPAlgorithm::ACO);
   // static void AnalyzeTSPAlgorithms(s21_graph& graph, int iterations = 1000);
 
  private:
@@ -105,6 +289,25 @@ class s21_graph_algorithms {
    */
   inline static const int kIntMax = std::numeric_limits<int>::max();
 
+  /**
+   * @brief Resolves kAuto for a graph (see
+   * GetShortestPathsBetweenAllVertices).
+   * @throw std::invalid_argument if kBreadthFirst is asked for a weighted
+   * graph.
+   */
+  static AllPairsAlgorithm ChooseAllPairsAlgorithm(
+      const s21_graph& graph, AllPairsAlgorithm algorithm);
+
+  /**
+   * @brief Finds the distances between all pairs with algorithm (not kAuto)
+   * and calls set(i, j, distance) for every pair with a path, by original
+   * ids. Several threads call set at once, each for rows of its own.
+   * @throw std::overflow_error if a distance does not fit an int.
+   */
+  template <typename Set>
+  static void ForEachPairDistance(const s21_graph& graph,
+                                  AllPairsAlgorithm algorithm, Set&& set);
+
   /**
    * @brief Checks if a vertex index is valid for the given graph.
    * @param graph The graph.
@@ -112,4 +315,13 @@ class s21_graph_algorithms {
    * @return True if the vertex is valid, false otherwise.
    */
   static bool CheckVertex(const s21_graph& graph, int vertex);
+
+  /**
+   * @brief Checks whether every vertex can reach every other one.
+   *
+   * Searches from vertex 0 along the edges and along the reversed ones
+   * (see s21_graph::GetReverse), O(V + E).
+   * @param graph The graph; it must have a vertex.
+   */
+  static bool IsStronglyConnected(const s21_graph& graph);
 };
\ No newline at end of file
@@ -0,0 +1,674 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../utils/parallel.h"
+#include "graph_algorithms.h"
+#include "graph_sp_astar.h"
+#include "graph_sp_bidirectional.h"
+#include "graph_sp_delta.h"
+#include "graph_sp_floyd.h"
+#include "graph_sp_lazy.h"
+
+// Micro-benchmarks of the graph layouts and algorithms. Built with
+// optimizations by `make bench`; `make bench BENCH=<name>` runs only the
+// named benchmarks.
+
+namespace {
+
+/**
+ * @brief Runs task repeats times.
+ * @return The fastest run in milliseconds.
+ */
+template <typename Task>
+double BestOfMs(int repeats, Task&& task) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    task();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+/**
+ * @brief Gets a path for a scratch file in the temporary directory.
+ */
+std::string TempFile(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+/**
+ * @brief Writes a road-like directed edge list: every vertex is joined to a
+ * few vertices with nearby ids and, rarely, to a random far one.
+ * @param max_weight Edges get weights in [1, max_weight].
+ * @param shuffled Whether the ids are scattered by a random permutation, as
+ * ids taken from a database are.
+ * @param far Whether the rare far edges are written; without them the
+ * graph has no shortcuts across, as road networks do not.
+ */
+void WriteLocalEdgeList(const std::string& filename, int size,
+                        int max_weight, bool shuffled = false,
+                        bool far = true) {
+  std::srand(42);
+  std::vector<int> id(size + 1);
+  std::iota(id.begin(), id.end(), 0);
+  if (shuffled) std::shuffle(id.begin() + 1, id.end(), std::mt19937(42));
+  std::ofstream file(filename);
+  file << "directed " << size << "\n";
+  for (int v = 1; v <= size; ++v) {
+    for (int k = 0; k < 4; ++k) {
+      int u = k < 3 || !far || std::rand() % 8 != 0
+                  ? v + std::rand() % 33 - 16
+                  : std::rand() % size + 1;
+      if (u < 1 || u > size || u == v) continue;
+      file << id[v] << ' ' << id[u];
+      if (max_weight > 1) file << ' ' << std::rand() % max_weight + 1;
+      file << '\n';
+    }
+  }
+}
+
+/**
+ * @brief Compares the compressed layout with CSR: memory and the time of
+ * BFS, DFS and a shortest path query on the same graph.
+ */
+void CompressedAdjacencyBench() {
+  const int size = 500000;
+  std::string filename = TempFile("s21_bench_local.edges");
+  std::printf("%-10s %-10s %10s %9s %9s %9s\n", "weights", "layout", "MiB",
+              "bfs ms", "dfs ms", "path ms");
+  for (bool weighted : {false, true}) {
+    WriteLocalEdgeList(filename, size, weighted ? 1000 : 1);
+    s21_graph graph;
+    graph.LoadFromEdgeList(filename);
+    for (GraphLayout layout :
+         {GraphLayout::kSparse, GraphLayout::kCompressed}) {
+      graph.SetLayout(layout);
+      double bfs = BestOfMs(5, [&] {
+        s21_graph_algorithms::BreadthFirstSearch(graph, 0);
+      });
+      double dfs = BestOfMs(5, [&] {
+        s21_graph_algorithms::DepthFirstSearch(graph, 0);
+      });
+      double path = BestOfMs(3, [&] {
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0,
+                                                             size - 1);
+      });
+      std::printf("%-10s %-10s %10.1f %9.1f %9.1f %9.1f\n",
+                  weighted ? "1..1000" : "unit",
+                  layout == GraphLayout::kSparse ? "csr" : "compressed",
+                  graph.GetStorageBytes() / (1024.0 * 1024.0), bfs, dfs, path);
+    }
+  }
+  std::filesystem::remove(filename);
+}
+
+/**
+ * @brief Runs the searches on a graph with scattered ids in every vertex
+ * order.
+ */
+void VertexOrderBench() {
+  const int size = 500000;
+  std::string filename = TempFile("s21_bench_shuffled.edges");
+  WriteLocalEdgeList(filename, size, 1000, true);
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+
+  const std::pair<VertexOrder, const char*> orders[] = {
+      {VertexOrder::kOriginal, "original"},
+      {VertexOrder::kBreadthFirst, "bfs"},
+      {VertexOrder::kReverseCuthillMcKee, "rcm"},
+      {VertexOrder::kDegree, "degree"}};
+  std::printf("%-10s %9s %9s %9s %9s\n", "order", "reorder", "bfs ms",
+              "dfs ms", "path ms");
+  for (const auto& [order, name] : orders) {
+    double reorder = BestOfMs(1, [&] { graph.SetVertexOrder(order); });
+    double bfs = BestOfMs(5, [&] {
+      s21_graph_algorithms::BreadthFirstSearch(graph, 0);
+    });
+    double dfs = BestOfMs(5, [&] {
+      s21_graph_algorithms::DepthFirstSearch(graph, 0);
+    });
+    double path = BestOfMs(3, [&] {
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, size - 1);
+    });
+    std::printf("%-10s %9.1f %9.1f %9.1f %9.1f\n", name, reorder, bfs, dfs,
+                path);
+  }
+}
+
+/**
+ * @brief Compares the point-to-point searches on a road-like graph, between
+ * vertices a few hundred ids apart and between random ones: time per query
+ * through the public interface and vertices settled per query.
+ */
+void PointToPointBench() {
+  const int size = 500000;
+  const int queries = 200;
+  std::string filename = TempFile("s21_bench_local.edges");
+  WriteLocalEdgeList(filename, size, 1000);
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+  auto reverse = graph.GetReverse();  // built once per graph, not per query
+
+  s21_sp::LandmarkIndex index;
+  double build =
+      BestOfMs(1, [&] { index = s21_sp::LandmarkIndex::Build(graph); });
+  std::string index_file = TempFile("s21_bench.landmarks");
+  index.Save(index_file);
+  double load =
+      BestOfMs(1, [&] { index = s21_sp::LandmarkIndex::Load(index_file); });
+  std::printf("%d landmarks, %.1f MiB: built in %.0f ms, mapped in %.1f ms\n",
+              index.Count(), index.MemoryBytes() / (1024.0 * 1024.0), build,
+              load);
+
+  using Query = std::pair<int, std::vector<int>> (*)(
+      const s21_graph&, int, int, const s21_sp::LandmarkIndex&);
+  const std::pair<const char*, Query> searches[] = {
+      {"dijkstra",
+       [](const s21_graph& graph, int start, int finish,
+          const s21_sp::LandmarkIndex&) {
+         return s21_graph_algorithms::GetShortestPathBetweenVertices(
+             graph, start, finish);
+       }},
+      {"bidir",
+       [](const s21_graph& graph, int start, int finish,
+          const s21_sp::LandmarkIndex&) {
+         return s21_graph_algorithms::GetShortestPathBetweenVertices(
+             graph, start, finish, ShortestPathAlgorithm::kBidirectional);
+       }},
+      {"alt",
+       [](const s21_graph& graph, int start, int finish,
+          const s21_sp::LandmarkIndex& index) {
+         return s21_graph_algorithms::GetShortestPathBetweenVertices(
+             graph, start, finish, index);
+       }}};
+  std::printf("%-10s %-10s %12s %12s\n", "search", "pairs", "ms/query",
+              "settled");
+  for (int spread : {500, size}) {
+    std::mt19937 random(42);
+    std::vector<std::pair<int, int>> pairs;
+    for (int q = 0; q < queries; ++q) {
+      int start = static_cast<int>(random() % (size - spread + 1));
+      pairs.emplace_back(start, start + random() % spread);
+    }
+    // the engines count what they settle; the interface does not report it
+    std::size_t settled[3] = {};
+    s21_sp::VisitSparseView(graph, [&](const auto& view) {
+      s21_sp::Dijkstra dijkstra(view);
+      s21_sp::BidirectionalDijkstra bidirectional(view, *reverse);
+      s21_sp::AStar astar(view);
+      for (auto [start, finish] : pairs) {
+        dijkstra.Run(start, finish);
+        settled[0] += dijkstra.SettledCount();
+        bidirectional.Run(start, finish);
+        settled[1] += bidirectional.SettledCount();
+        astar.Run(start, finish,
+                  s21_sp::LandmarkPotential(index, graph, finish));
+        settled[2] += astar.SettledCount();
+      }
+    });
+    for (int s = 0; s < 3; ++s) {
+      double total = BestOfMs(1, [&] {
+        for (auto [start, finish] : pairs) {
+          searches[s].second(graph, start, finish, index);
+        }
+      });
+      std::printf("%-10s %-10s %12.3f %12zu\n", searches[s].first,
+                  spread == size ? "random" : "near", total / queries,
+                  settled[s] / queries);
+    }
+  }
+  std::filesystem::remove(index_file);
+}
+
+/**
+ * @brief Compares contraction hierarchy queries with bidirectional Dijkstra
+ * on a road-like graph, and reports what the preprocessing costs.
+ */
+void ContractionHierarchyBench() {
+  const int size = 500000;
+  const int queries = 100;
+  std::string filename = TempFile("s21_bench_road.edges");
+  WriteLocalEdgeList(filename, size, 1000, false, false);
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+  auto reverse = graph.GetReverse();
+
+  s21_sp::ContractionHierarchy hierarchy;
+  double build = BestOfMs(
+      1, [&] { hierarchy = s21_sp::ContractionHierarchy::Build(graph); });
+  std::string hierarchy_file = TempFile("s21_bench.ch");
+  hierarchy.Save(hierarchy_file);
+  double load = BestOfMs(1, [&] {
+    hierarchy = s21_sp::ContractionHierarchy::Load(hierarchy_file);
+  });
+  std::printf(
+      "%zu shortcuts, %.1f MiB: built in %.0f ms on %u threads, mapped in "
+      "%.1f ms\n",
+      hierarchy.ShortcutCount(), hierarchy.MemoryBytes() / (1024.0 * 1024.0),
+      build, s21::WorkerCount(), load);
+
+  std::printf("%-10s %-10s %12s %12s\n", "search", "pairs", "ms/query",
+              "settled");
+  for (int spread : {500, size}) {
+    std::mt19937 random(42);
+    std::vector<std::pair<int, int>> pairs;
+    for (int q = 0; q < queries; ++q) {
+      int start = static_cast<int>(random() % (size - spread + 1));
+      pairs.emplace_back(start, start + random() % spread);
+    }
+    const char* label = spread == size ? "random" : "near";
+    std::size_t settled = 0;
+    double total = BestOfMs(1, [&] {
+      s21_sp::VisitSparseView(graph, [&](const auto& view) {
+        s21_sp::BidirectionalDijkstra engine(view, *reverse);
+        for (auto [start, finish] : pairs) {
+          engine.Run(start, finish);
+          engine.Path();
+          settled += engine.SettledCount();
+        }
+      });
+    });
+    std::printf("%-10s %-10s %12.3f %12zu\n", "bidir", label,
+                total / queries, settled / queries);
+    settled = 0;
+    total = BestOfMs(1, [&] {
+      s21_sp::ContractionQuery engine(hierarchy);
+      for (auto [start, finish] : pairs) {
+        engine.Run(start, finish);
+        engine.Path();
+        settled += engine.SettledCount();
+      }
+    });
+    std::printf("%-10s %-10s %12.3f %12zu\n", "ch", label, total / queries,
+                settled / queries);
+    // the interface sets up a query engine, and its labels, per call
+    total = BestOfMs(1, [&] {
+      for (auto [start, finish] : pairs) {
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, start,
+                                                             finish, hierarchy);
+      }
+    });
+    std::printf("%-10s %-10s %12.3f %12s\n", "ch api", label,
+                total / queries, "");
+  }
+  std::filesystem::remove(hierarchy_file);
+}
+
+/**
+ * @brief Compares the throughput of a distance table with one query per
+ * pair, for pickups and drop-offs spread over a region of the graph.
+ */
+void DistanceTableBench() {
+  const int size = 500000;
+  const int region = 50000;
+  std::string filename = TempFile("s21_bench_local.edges");
+  WriteLocalEdgeList(filename, size, 1000);
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+
+  std::printf("%-10s %10s %12s %14s\n", "method", "pairs", "ms",
+              "pairs/s");
+  auto report = [](const char* method, std::size_t pairs, double ms) {
+    std::printf("%-10s %10zu %12.1f %14.0f\n", method, pairs, ms,
+                pairs / (ms / 1000.0));
+  };
+  std::mt19937 random(42);
+  auto pick = [&](int count) {
+    std::vector<int> vertices(count);
+    for (int& v : vertices) v = static_cast<int>(random() % region);
+    return vertices;
+  };
+  // one query per pair is measured on a sample; the rate is what counts
+  std::vector<int> sample = pick(20);
+  double single = BestOfMs(1, [&] {
+    for (std::size_t k = 0; k + 1 < sample.size(); k += 2) {
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, sample[k],
+                                                           sample[k + 1]);
+    }
+  });
+  report("per pair", sample.size() / 2, single);
+  for (int count : {10, 100, 300}) {
+    std::vector<int> sources = pick(count);
+    std::vector<int> targets = pick(count);
+    double table = BestOfMs(1, [&] {
+      s21_graph_algorithms::GetDistanceTable(graph, sources, targets);
+    });
+    std::string method = "table " + std::to_string(count);
+    report(method.c_str(), sources.size() * targets.size(), table);
+  }
+}
+
+/**
+ * @brief Compares one full single-source search by Dijkstra's algorithm
+ * with delta-stepping at several bucket widths.
+ */
+void SingleSourceBench() {
+  const int size = 500000;
+  std::string filename = TempFile("s21_bench_local.edges");
+  WriteLocalEdgeList(filename, size, 1000);
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+  const s21::GraphMetadata& metadata = graph.GetMetadata();
+  const s21_sp::Distance chosen = s21_sp::ChooseDelta(metadata);
+
+  std::printf("%u threads\n", s21::WorkerCount());
+  std::printf("%-10s %8s %10s %10s\n", "search", "delta", "phases", "ms");
+  s21_sp::VisitSparseView(graph, [&](const auto& view) {
+    s21_sp::Dijkstra dijkstra(view);
+    double ms = BestOfMs(3, [&] { dijkstra.Run(0); });
+    std::printf("%-10s %8s %10s %10.1f\n", "dijkstra", "", "", ms);
+    for (s21_sp::Distance delta :
+         {s21_sp::Distance{1}, chosen / 4, chosen, 4 * chosen}) {
+      s21_sp::DeltaStepping engine(view, delta, metadata.max_weight);
+      ms = BestOfMs(3, [&] { engine.Run(0); });
+      std::printf("%-10s %8lld %10zu %10.1f%s\n", "delta",
+                  static_cast<long long>(delta), engine.PhaseCount(), ms,
+                  delta == chosen ? "  (chosen)" : "");
+    }
+  });
+}
+
+/**
+ * @brief Compares Dijkstra's algorithm with a heap and with a bucket queue
+ * as the heaviest weight grows, for a search of the whole graph and for
+ * short queries that include setting the engine up, as the interface does.
+ */
+void BucketQueueBench() {
+  const int size = 500000;
+  const int queries = 20;
+  std::string filename = TempFile("s21_bench_local.edges");
+  std::printf("%-10s %12s %12s %12s %12s\n", "max weight", "heap ms",
+              "buckets ms", "heap q ms", "buckets q ms");
+  for (int max_weight : {1, 10, 100, 1000, 10000, 100000, 1000000}) {
+    WriteLocalEdgeList(filename, size, max_weight);
+    s21_graph graph;
+    graph.LoadFromEdgeList(filename);
+    s21_sp::VisitSparseView(graph, [&](const auto& view) {
+      using View = std::decay_t<decltype(view)>;
+      auto measure = [&](auto make) {
+        auto engine = make();
+        double full = BestOfMs(3, [&] { engine.Run(0); });
+        double query = BestOfMs(1, [&] {
+          for (int q = 0; q < queries; ++q) {
+            auto fresh = make();
+            fresh.Run(q * (size / queries), q * (size / queries) + 100);
+          }
+        });
+        return std::pair{full, query / queries};
+      };
+      auto [heap, heap_query] =
+          measure([&] { return s21_sp::Dijkstra<View>(view); });
+      auto [buckets, buckets_query] = measure([&] {
+        return s21_sp::Dijkstra<View, s21_sp::BucketQueue>(view, max_weight);
+      });
+      std::printf("%-10d %12.1f %12.1f %12.3f %12.3f\n", max_weight, heap,
+                  buckets, heap_query, buckets_query);
+    });
+  }
+  std::filesystem::remove(filename);
+}
+
+/**
+ * @brief Compares the textbook k-i-j Floyd-Warshall loop with the blocked
+ * kernel, then blocked Floyd-Warshall with a Dijkstra search per source as
+ * the graph gets denser, and both with the batched BFS on unweighted
+ * graphs, random ones and a long path.
+ */
+void AllPairsBench() {
+  std::printf("%u threads, %d x %d tiles\n", s21::WorkerCount(),
+              s21_sp::kFloydTile, s21_sp::kFloydTile);
+  std::printf("%-8s %14s %12s\n", "vertices", "textbook ms", "blocked ms");
+  for (int size : {500, 1000, 2000}) {
+    std::srand(42);
+    s21::DenseMatrix<int> input(size, s21_sp::kFloydInfinity<int>);
+    for (int i = 0; i < size; ++i) {
+      for (int k = 0; k < 8; ++k) input(i, std::rand() % size) = 1;
+      input(i, i) = 0;
+    }
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        if (input(i, j) == 1) input(i, j) = std::rand() % 1000 + 1;
+      }
+    }
+    const int repeats = size < 2000 ? 3 : 1;
+    double textbook = BestOfMs(repeats, [&] {
+      std::vector<std::vector<int>> dist(size, std::vector<int>(size));
+      for (int i = 0; i < size; ++i) {
+        std::copy(input.Row(i), input.Row(i) + size, dist[i].begin());
+      }
+      for (int k = 0; k < size; ++k) {
+        for (int i = 0; i < size; ++i) {
+          if (dist[i][k] == s21_sp::kFloydInfinity<int>) continue;
+          for (int j = 0; j < size; ++j) {
+            if (dist[k][j] < s21_sp::kFloydInfinity<int>) {
+              dist[i][j] = std::min(dist[i][j], dist[i][k] + dist[k][j]);
+            }
+          }
+        }
+      }
+    });
+    double blocked = BestOfMs(repeats, [&] {
+      s21::DenseMatrix<int> dist = input;
+      s21_sp::FloydWarshall(dist);
+    });
+    std::printf("%-8d %14.1f %12.1f\n", size, textbook, blocked);
+  }
+
+  const int size = 1500;
+  std::string filename = TempFile("s21_bench_random.edges");
+  std::printf("\n%-8s %10s %12s %12s\n", "degree", "density", "floyd ms",
+              "dijkstra ms");
+  for (int degree : {4, 16, 64, 128, 256}) {
+    {
+      std::srand(42);
+      std::ofstream file(filename);
+      file << "directed " << size << "\n";
+      for (int v = 1; v <= size; ++v) {
+        for (int k = 0; k < degree; ++k) {
+          file << v << ' ' << std::rand() % size + 1 << ' '
+               << std::rand() % 1000 + 1 << '\n';
+        }
+      }
+    }
+    s21_graph graph;
+    graph.LoadFromEdgeList(filename);
+    auto run = [&](AllPairsAlgorithm algorithm) {
+      return BestOfMs(1, [&] {
+        s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph,
+                                                                 algorithm);
+      });
+    };
+    double floyd = run(AllPairsAlgorithm::kFloydWarshall);
+    double dijkstra = run(AllPairsAlgorithm::kDijkstra);
+    std::printf("%-8d %10.4f %12.1f %12.1f\n", degree,
+                graph.GetMetadata().density, floyd, dijkstra);
+  }
+
+  // unweighted: hop counts, where the batched BFS applies as well
+  std::printf("\n%-8s %12s %12s %12s\n", "degree", "floyd ms",
+              "dijkstra ms", "bfs ms");
+  for (int degree : {4, 16, 64}) {
+    {
+      std::srand(42);
+      std::ofstream file(filename);
+      file << "directed " << size << "\n";
+      for (int v = 1; v <= size; ++v) {
+        for (int k = 0; k < degree; ++k) {
+          file << v << ' ' << std::rand() % size + 1 << '\n';
+        }
+      }
+    }
+    s21_graph graph;
+    graph.LoadFromEdgeList(filename);
+    auto run = [&](AllPairsAlgorithm algorithm) {
+      return BestOfMs(1, [&] {
+        s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph,
+                                                                 algorithm);
+      });
+    };
+    std::printf("%-8d %12.1f %12.1f %12.1f\n", degree,
+                run(AllPairsAlgorithm::kFloydWarshall),
+                run(AllPairsAlgorithm::kDijkstra),
+                run(AllPairsAlgorithm::kBreadthFirst));
+  }
+
+  // long diameter: an undirected path, where the searches take a level per
+  // vertex and each level has a frontier of a few vertices only
+  std::printf("\n%-8s %12s %12s\n", "path", "dijkstra ms", "bfs ms");
+  for (int length : {2000, 4000, 8000}) {
+    {
+      std::ofstream file(filename);
+      file << "undirected " << length << "\n";
+      for (int v = 1; v < length; ++v) file << v << ' ' << v + 1 << '\n';
+    }
+    s21_graph graph;
+    graph.LoadFromEdgeList(filename);
+    auto run = [&](AllPairsAlgorithm algorithm) {
+      return BestOfMs(1, [&] {
+        s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph,
+                                                                 algorithm);
+      });
+    };
+    std::printf("%-8d %12.1f %12.1f\n", length,
+                run(AllPairsAlgorithm::kDijkstra),
+                run(AllPairsAlgorithm::kBreadthFirst));
+  }
+  std::filesystem::remove(filename);
+}
+
+/**
+ * @brief Measures the next-hop matrix of GetAllPairsPaths: what it adds to
+ * the all-pairs search and its memory, and paths read from it against a
+ * Dijkstra query per pair.
+ */
+void AllPairsPathsBench() {
+  const int size = 2000;
+  std::string filename = TempFile("s21_bench_local.edges");
+  WriteLocalEdgeList(filename, size, 1000);
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+
+  std::printf("%-12s %10s %10s\n", "storage", "build ms", "MiB");
+  s21_sp::AllPairsPaths paths;
+  for (auto [name, storage] :
+       {std::pair{"distances", s21_sp::AllPairsStorage::kDistances},
+        std::pair{"next hops", s21_sp::AllPairsStorage::kNextHops},
+        std::pair{"both", s21_sp::AllPairsStorage::kBoth}}) {
+    double ms = BestOfMs(1, [&] {
+      paths = s21_graph_algorithms::GetAllPairsPaths(graph, storage);
+    });
+    std::printf("%-12s %10.1f %10.1f\n", name, ms,
+                paths.MemoryBytes() / 1048576.0);
+  }
+
+  const int pairs = 1000;
+  std::mt19937 random(42);
+  std::vector<std::pair<int, int>> sample(pairs);
+  for (auto& [from, to] : sample) {
+    from = static_cast<int>(random() % size);
+    to = static_cast<int>(random() % size);
+  }
+  std::size_t vertices = 0;
+  double walk = BestOfMs(3, [&] {
+    for (auto [from, to] : sample) {
+      for (int v : paths.PathBetween(from, to)) vertices += v >= 0;
+    }
+  });
+  double query = BestOfMs(1, [&] {
+    for (auto [from, to] : sample) {
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, from, to);
+    }
+  });
+  std::printf("\n%d paths (%zu vertices): next hops %.3f ms, queries %.1f ms\n",
+              pairs, vertices / 3, walk, query);
+}
+
+/**
+ * @brief Measures LazyAllPairs on a graph whose full matrix would not fit:
+ * a pass over a working set of rows, first computed and then read again
+ * from the cache, against a budget smaller than the working set.
+ */
+void LazyAllPairsBench() {
+  const int size = 50000;
+  std::string filename = TempFile("s21_bench_local.edges");
+  WriteLocalEdgeList(filename, size, 1000);
+  s21_graph graph;
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+
+  const std::size_t row_bytes = size * sizeof(int) + sizeof(std::vector<int>);
+  std::printf("full matrix %.1f MiB, one row %.1f KiB\n",
+              static_cast<double>(size) * size * sizeof(int) / 1048576.0,
+              row_bytes / 1024.0);
+  std::printf("%-8s %-8s %12s %12s %10s\n", "rows", "budget", "first ms",
+              "again ms", "computed");
+  for (int rows : {16, 64}) {
+    for (int budget : {rows, rows / 2}) {
+      s21_sp::LazyAllPairs lazy(graph, budget * row_bytes);
+      long long sum = 0;
+      auto pass = [&] {
+        for (int i = 0; i < rows; ++i) sum += lazy[i * (size / rows)][0];
+      };
+      double first = BestOfMs(1, pass);
+      double again = BestOfMs(1, pass);
+      std::printf("%-8d %-8d %12.1f %12.3f %10zu\n", rows, budget, first,
+                  again, lazy.ComputedRows());
+    }
+  }
+}
+
+/**
+ * @brief A named benchmark.
+ */
+struct Benchmark {
+  const char* name;  ///< Name used to select the benchmark.
+  void (*run)();     ///< Runs it and prints the results.
+};
+
+const Benchmark kBenchmarks[] = {
+    {"compressed", CompressedAdjacencyBench},
+    {"order", VertexOrderBench},
+    {"path", PointToPointBench},
+    {"ch", ContractionHierarchyBench},
+    {"table", DistanceTableBench},
+    {"sssp", SingleSourceBench},
+    {"dial", BucketQueueBench},
+    {"apsp", AllPairsBench},
+    {"paths", AllPairsPathsBench},
+    {"lazy", LazyAllPairsBench},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (const Benchmark& benchmark : kBenchmarks) {
+    bool selected = argc < 2;
+    for (int i = 1; i < argc; ++i) {
+      selected |= std::strcmp(argv[i], benchmark.name) == 0;
+    }
+    if (!selected) continue;
+    std::printf("== %s\n", benchmark.name);
+    benchmark.run();
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -2,10 +2,18 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <numeric>
+#include <thread>
 
+#include "../graph/graph_test_util.h"
 #include "../utils/timer.h"
+#include "graph_sp_delta.h"
+#include "graph_sp_floyd.h"
+#include "graph_sp_lazy.h"
 
 TEST(GraphAlgorithmsTest, WrongInputedVertices) {
   s21_graph graph;
@@ -119,6 +127,178 @@ TEST(GraphAlgorithmsTest, ConnectedUndirectedWeighted) {
   EXPECT_EQ(prim_tree.first, 16);
 }
 
+TEST(GraphAlgorithmsTest, SparseLayoutMatchesDense) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0  2  4  0  0  0\n"
+            "2  0  0  1  0  0\n"
+            "4  0  0  0  3  0\n"
+            "0  1  0  0  5  7\n"
+            "0  0  3  5  0  6\n"
+            "0  0  0  7  6  0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  s21_graph sparse = graph;
+  sparse.SetLayout(GraphLayout::kSparse);
+  ASSERT_EQ(graph.GetLayout(), GraphLayout::kDense);
+  ASSERT_EQ(sparse.GetLayout(), GraphLayout::kSparse);
+
+  EXPECT_EQ(s21_graph_algorithms::DepthFirstSearch(sparse, 0),
+            s21_graph_algorithms::DepthFirstSearch(graph, 0));
+  EXPECT_EQ(s21_graph_algorithms::BreadthFirstSearch(sparse, 0),
+            s21_graph_algorithms::BreadthFirstSearch(graph, 0));
+  EXPECT_EQ(s21_graph_algorithms::GetShortestPathBetweenVertices(sparse, 0, 5),
+            s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 5));
+  EXPECT_EQ(s21_graph_algorithms::GetShortestPathsBetweenAllVertices(sparse),
+            s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph));
+  EXPECT_EQ(s21_graph_algorithms::GetLeastSpanningTree(sparse),
+            s21_graph_algorithms::GetLeastSpanningTree(graph));
+}
+
+TEST(GraphAlgorithmsTest, BitPackedSearchMatchesSparse) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+  const int size = 150;
+
+  {
+    std::srand(11);
+    std::ofstream file(filename);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        // vertices from 140 on are left isolated
+        bool edge = i != j && i < 140 && j < 140 && std::rand() % 12 == 0;
+        file << edge << " ";
+      }
+      file << "\n";
+    }
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  s21_graph sparse = graph;
+  sparse.SetLayout(GraphLayout::kSparse);
+  ASSERT_EQ(graph.GetLayout(), GraphLayout::kBitPacked);
+
+  for (int start : {0, 63, 64, 139, 145}) {
+    EXPECT_EQ(s21_graph_algorithms::BreadthFirstSearch(graph, start),
+              s21_graph_algorithms::BreadthFirstSearch(sparse, start))
+        << start;
+    EXPECT_EQ(s21_graph_algorithms::DepthFirstSearch(graph, start),
+              s21_graph_algorithms::DepthFirstSearch(sparse, start));
+  }
+  EXPECT_EQ(s21_graph_algorithms::BreadthFirstSearch(graph, 145),
+            std::vector<int>{145});
+}
+
+TEST(GraphAlgorithmsTest, ReorderedGraphKeepsResults) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0  2  4  0  0  0\n"
+            "2  0  0  1  0  0\n"
+            "4  0  0  0  3  0\n"
+            "0  1  0  0  5  7\n"
+            "0  0  3  5  0  6\n"
+            "0  0  0  7  6  0\n";
+  }
+  graph.LoadFromFile(filename);
+
+  // complete, so that the nearest neighbour tour exists; has weight ties
+  s21_graph complete;
+  {
+    std::ofstream file(filename);
+    file << "0  1  1 10  5\n"
+            "1  0  1  1  7\n"
+            "1  1  0 10  9\n"
+            "10 1 10  0  3\n"
+            "5  7  9  3  0\n";
+  }
+  complete.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  const TsmResult tour = s21_graph_algorithms::SolveTravelingSalesmanProblem(
+      complete, TSPAlgorithm::NEAREST_NEIGHBOR);
+
+  for (VertexOrder order :
+       {VertexOrder::kOriginal, VertexOrder::kBreadthFirst,
+        VertexOrder::kReverseCuthillMcKee, VertexOrder::kDegree}) {
+    s21_graph reordered = graph;
+    reordered.SetVertexOrder(order);
+
+    // searches break ties by original id, whatever the layout
+    for (int start = 0; start < 6; ++start) {
+      EXPECT_EQ(s21_graph_algorithms::DepthFirstSearch(reordered, start),
+                s21_graph_algorithms::DepthFirstSearch(graph, start))
+          << static_cast<int>(order) << " " << start;
+      EXPECT_EQ(s21_graph_algorithms::BreadthFirstSearch(reordered, start),
+                s21_graph_algorithms::BreadthFirstSearch(graph, start))
+          << static_cast<int>(order) << " " << start;
+    }
+    EXPECT_EQ(
+        s21_graph_algorithms::GetShortestPathBetweenVertices(reordered, 0, 5),
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 5));
+    EXPECT_EQ(
+        s21_graph_algorithms::GetShortestPathBetweenVertices(
+            reordered, 0, 5, ShortestPathAlgorithm::kBidirectional),
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 5));
+    EXPECT_EQ(
+        s21_graph_algorithms::GetShortestPathsBetweenAllVertices(reordered),
+        s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph));
+    EXPECT_EQ(s21_graph_algorithms::GetLeastSpanningTree(reordered),
+              s21_graph_algorithms::GetLeastSpanningTree(graph));
+
+    s21_graph reordered_complete = complete;
+    reordered_complete.SetVertexOrder(order);
+    const TsmResult reordered_tour =
+        s21_graph_algorithms::SolveTravelingSalesmanProblem(
+            reordered_complete, TSPAlgorithm::NEAREST_NEIGHBOR);
+    EXPECT_EQ(reordered_tour.vertices, tour.vertices)
+        << static_cast<int>(order);
+    EXPECT_DOUBLE_EQ(reordered_tour.distance, tour.distance)
+        << static_cast<int>(order);
+  }
+  s21_graph degree = graph;
+  degree.SetVertexOrder(VertexOrder::kDegree);
+  EXPECT_NE(degree.StorageId(0), 0);
+}
+
+TEST(GraphAlgorithmsTest, ReorderedBitPackedSearchKeepsOrder) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 1 1 0 0\n"
+            "1 0 0 0 0\n"
+            "1 0 0 1 1\n"
+            "0 0 1 0 0\n"
+            "0 0 1 0 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  ASSERT_EQ(graph.GetLayout(), GraphLayout::kBitPacked);
+
+  for (VertexOrder order :
+       {VertexOrder::kBreadthFirst, VertexOrder::kReverseCuthillMcKee,
+        VertexOrder::kDegree}) {
+    s21_graph reordered = graph;
+    reordered.SetVertexOrder(order);
+    ASSERT_EQ(reordered.GetLayout(), GraphLayout::kBitPacked);
+    EXPECT_EQ(s21_graph_algorithms::DepthFirstSearch(reordered, 0),
+              (std::vector<int>{0, 1, 2, 3, 4}))
+        << static_cast<int>(order);
+    EXPECT_EQ(s21_graph_algorithms::BreadthFirstSearch(reordered, 0),
+              (std::vector<int>{0, 1, 2, 3, 4}))
+        << static_cast<int>(order);
+  }
+}
+
 TEST(GraphAlgorithmsTest, ConnectedDirectedUnweighted) {
   s21_graph graph;
   std::string filename = "test_graph.txt";
@@ -248,6 +428,745 @@ TEST(GraphAlgorithmsTest, DisconnectedUndirectedWeighted) {
                std::logic_error);
 }
 
+TEST(GraphAlgorithmsTest, HeavyWeightsDoNotOverflow) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 1000000000 0 0\n"
+            "1000000000 0 1000000000 0\n"
+            "0 1000000000 0 1500000000\n"
+            "0 0 1500000000 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  // sums that fit an int come out exact even though the search adds past it
+  EXPECT_EQ(
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 2).first,
+      2000000000);
+  EXPECT_THROW(
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 3),
+      std::overflow_error);
+  EXPECT_THROW(s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph),
+               std::overflow_error);
+  EXPECT_THROW(s21_graph_algorithms::GetLeastSpanningTree(graph),
+               std::overflow_error);
+
+  // the largest weight is still lighter than no edge at all
+  {
+    std::ofstream file(filename);
+    file << "0 2147483647\n"
+            "2147483647 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  auto tree = s21_graph_algorithms::GetLeastSpanningTree(graph);
+  EXPECT_EQ(tree.first, 2147483647);
+  EXPECT_EQ(tree.second[0][1], 2147483647);
+  EXPECT_EQ(tree.second[1][0], 2147483647);
+}
+
+TEST(GraphAlgorithmsTest, ShortestPathTakesLaterImprovements) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+
+  {
+    std::ofstream file(filename);
+    file << "0 10 1 0 0\n"
+            "0 0 0 0 1\n"
+            "0 0 0 1 0\n"
+            "0 1 0 0 0\n"
+            "0 0 0 0 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+
+  // vertex 1 is reached directly first and more cheaply through 2 and 3
+  std::pair<int, std::vector<int>> expected = {4, {0, 2, 3, 1, 4}};
+  for (GraphLayout layout : {GraphLayout::kDense, GraphLayout::kSparse}) {
+    graph.SetLayout(layout);
+    for (ShortestPathAlgorithm algorithm :
+         {ShortestPathAlgorithm::kDijkstra,
+          ShortestPathAlgorithm::kBidirectional}) {
+      EXPECT_EQ(s21_graph_algorithms::GetShortestPathBetweenVertices(
+                    graph, 0, 4, algorithm),
+                expected);
+    }
+  }
+}
+
+TEST(GraphAlgorithmsTest, ShortestPathsMatchFloydWarshall) {
+  s21_graph graph;
+  const int size = 40;
+
+  s21_test::LoadRandomGraph(graph, size, 7, 8, 50);
+
+  auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  for (auto [layout, algorithm] :
+       {std::pair{GraphLayout::kDense, ShortestPathAlgorithm::kDijkstra},
+        std::pair{GraphLayout::kSparse, ShortestPathAlgorithm::kDijkstra},
+        std::pair{GraphLayout::kCompressed, ShortestPathAlgorithm::kDijkstra},
+        std::pair{GraphLayout::kDense, ShortestPathAlgorithm::kBidirectional},
+        std::pair{GraphLayout::kSparse,
+                  ShortestPathAlgorithm::kBidirectional}}) {
+    graph.SetLayout(layout);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        if (i == j) continue;
+        auto [distance, path] =
+            s21_graph_algorithms::GetShortestPathBetweenVertices(graph, i, j,
+                                                                 algorithm);
+        ASSERT_EQ(distance, all[i][j] == 0 ? -1 : all[i][j]);
+        if (distance == -1) continue;
+        ASSERT_EQ(path.front(), i);
+        ASSERT_EQ(path.back(), j);
+        int length = 0;
+        for (std::size_t k = 1; k < path.size(); ++k) {
+          length += graph(path[k - 1], path[k]);
+        }
+        ASSERT_EQ(length, distance);
+      }
+    }
+  }
+}
+
+TEST(GraphAlgorithmsTest, BlockedFloydWarshallMatchesTextbook) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+  // three tiles, the last one partial
+  const int size = 2 * s21_sp::kFloydTile + 22;
+
+  // a heavy edge makes the search use 64-bit distances
+  for (int heavy : {0, 1000000000}) {
+    std::vector<std::vector<long long>> expected(
+        size, std::vector<long long>(size, -1));
+    {
+      std::srand(11);
+      std::ofstream file(filename);
+      file << "directed " << size << "\n";
+      if (heavy > 0) {
+        expected[0][1] = heavy;
+        file << 1 << ' ' << 2 << ' ' << heavy << '\n';
+      }
+      for (int e = 0; e < 3 * size; ++e) {
+        int u = std::rand() % size;
+        int v = std::rand() % size;
+        int weight = std::rand() % 100 + 1;
+        if (u == v || expected[u][v] != -1) continue;
+        expected[u][v] = weight;
+        file << u + 1 << ' ' << v + 1 << ' ' << weight << '\n';
+      }
+    }
+    graph.LoadFromEdgeList(filename);
+    for (int i = 0; i < size; ++i) expected[i][i] = 0;
+    for (int k = 0; k < size; ++k) {
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+          if (expected[i][k] == -1 || expected[k][j] == -1) continue;
+          long long through = expected[i][k] + expected[k][j];
+          if (expected[i][j] == -1 || through < expected[i][j]) {
+            expected[i][j] = through;
+          }
+        }
+      }
+    }
+
+    auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+        graph, AllPairsAlgorithm::kFloydWarshall);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        ASSERT_EQ(all[i][j], expected[i][j] == -1 ? 0 : expected[i][j]);
+      }
+    }
+  }
+  std::filesystem::remove(filename);
+}
+
+TEST(GraphAlgorithmsTest, AllPairsAlgorithmsAgree) {
+  s21_graph graph;
+  const int size = 60;
+
+  // sparse and dense, so kAuto takes each branch once
+  for (int one_in : {33, 2}) {
+    s21_test::LoadRandomGraph(graph, size, one_in, one_in, 30);
+    auto floyd = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+        graph, AllPairsAlgorithm::kFloydWarshall);
+    // rows are searched on storage ids and written back by vertex
+    graph.SetVertexOrder(VertexOrder::kBreadthFirst);
+    EXPECT_EQ(s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+                  graph, AllPairsAlgorithm::kDijkstra),
+              floyd);
+    EXPECT_EQ(s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph),
+              floyd);
+  }
+}
+
+TEST(GraphAlgorithmsTest, MultiSourceBfsMatchesFloydWarshall) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+  // two batches of sources, the second one partial
+  const int size = 300;
+
+  {
+    std::srand(13);
+    std::ofstream file(filename);
+    file << "directed " << size << "\n";
+    for (int e = 0; e < 2 * size; ++e) {
+      file << std::rand() % size + 1 << ' ' << std::rand() % size + 1
+           << '\n';
+    }
+  }
+  graph.LoadFromEdgeList(filename);
+  auto floyd = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  EXPECT_EQ(s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+                graph, AllPairsAlgorithm::kBreadthFirst),
+            floyd);
+  graph.SetVertexOrder(VertexOrder::kBreadthFirst);
+  EXPECT_EQ(s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph),
+            floyd);
+
+  // a directed ring: one level per vertex, each with a thin frontier
+  {
+    std::ofstream file(filename);
+    file << "directed " << size << "\n";
+    for (int v = 1; v <= size; ++v) file << v << ' ' << v % size + 1 << '\n';
+  }
+  graph.LoadFromEdgeList(filename);
+  auto ring = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kBreadthFirst);
+  EXPECT_EQ(ring, s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+                      graph, AllPairsAlgorithm::kFloydWarshall));
+  EXPECT_EQ(ring[0][size - 1], size - 1);
+
+  {
+    std::ofstream file(filename);
+    file << "directed 2\n1 2 5\n";
+  }
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+  EXPECT_THROW(s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+                   graph, AllPairsAlgorithm::kBreadthFirst),
+               std::invalid_argument);
+}
+
+TEST(GraphAlgorithmsTest, AllPairsPathsFollowShortestPaths) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+  const int size = 50;
+
+  s21_test::LoadRandomGraph(graph, size, 17, 12, 40);
+  auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  auto paths = s21_graph_algorithms::GetAllPairsPaths(graph);
+  ASSERT_EQ(paths.NextHopBytes(), 1);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      int distance = i == j ? 0 : all[i][j] == 0 ? -1 : all[i][j];
+      ASSERT_EQ(paths.Distance(i, j), distance);
+      std::vector<int> path;
+      for (int v : paths.PathBetween(i, j)) path.push_back(v);
+      if (distance == -1) {
+        ASSERT_TRUE(path.empty());
+        continue;
+      }
+      ASSERT_EQ(path.front(), i);
+      ASSERT_EQ(path.back(), j);
+      int length = 0;
+      for (std::size_t k = 1; k < path.size(); ++k) {
+        ASSERT_GT(graph(path[k - 1], path[k]), 0);
+        length += graph(path[k - 1], path[k]);
+      }
+      ASSERT_EQ(length, distance);
+    }
+  }
+
+  // only the matrices asked for are kept
+  auto distances = s21_graph_algorithms::GetAllPairsPaths(
+      graph, s21_sp::AllPairsStorage::kDistances);
+  EXPECT_EQ(distances.MemoryBytes(), size * size * sizeof(int));
+  EXPECT_THROW(distances.PathBetween(0, 1), std::logic_error);
+  EXPECT_THROW(distances.PathBetween(2, 2), std::logic_error);
+  auto hops = s21_graph_algorithms::GetAllPairsPaths(
+      graph, s21_sp::AllPairsStorage::kNextHops);
+  EXPECT_EQ(hops.MemoryBytes(), size * size);
+  EXPECT_THROW(hops.Distance(0, 1), std::logic_error);
+  EXPECT_EQ(hops.NextHop(3, 7), paths.NextHop(3, 7));
+  EXPECT_THROW(paths.Distance(-1, 0), std::out_of_range);
+  EXPECT_THROW(paths.Distance(0, size), std::out_of_range);
+  EXPECT_THROW(paths.NextHop(size, 0), std::out_of_range);
+  EXPECT_THROW(paths.PathBetween(0, -1), std::out_of_range);
+  EXPECT_THROW(paths.PathBetween(size, size), std::out_of_range);
+
+  // past 255 vertices the next hops take two bytes
+  {
+    std::ofstream file(filename);
+    file << "undirected 300\n";
+    for (int v = 1; v < 300; ++v) file << v << ' ' << v + 1 << '\n';
+  }
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+  paths = s21_graph_algorithms::GetAllPairsPaths(graph);
+  EXPECT_EQ(paths.NextHopBytes(), 2);
+  EXPECT_EQ(std::distance(paths.PathBetween(299, 0).begin(),
+                          paths.PathBetween(299, 0).end()),
+            300);
+  EXPECT_EQ(paths.NextHop(299, 0), 298);
+}
+
+TEST(GraphAlgorithmsTest, LazyAllPairsMatchesMatrix) {
+  s21_graph graph;
+  const int size = 40;
+
+  s21_test::LoadRandomGraph(graph, size, 19, 10, 30);
+  graph.SetVertexOrder(VertexOrder::kBreadthFirst);
+
+  // code written against the matrix reads the handle the same way
+  auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  const std::size_t row_bytes = size * sizeof(int) + sizeof(std::vector<int>);
+  s21_sp::LazyAllPairs lazy(graph, 3 * row_bytes);
+  auto total = [](const auto& matrix) {
+    long long sum = 0;
+    for (std::size_t i = 0; i < matrix.size(); ++i) {
+      for (int distance : matrix[i]) sum += distance;
+    }
+    return sum;
+  };
+  EXPECT_EQ(total(lazy), total(all));
+  auto walk = [](const auto& matrix) {
+    long long sum = 0;
+    for (const auto& row : matrix) {
+      for (int distance : row) sum += distance;
+    }
+    return sum;
+  };
+  EXPECT_EQ(walk(lazy), walk(all));
+  EXPECT_EQ(std::distance(lazy.begin(), lazy.end()), size);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) ASSERT_EQ(lazy[i][j], all[i][j]);
+  }
+  EXPECT_EQ(lazy.CachedRows(), 3u);
+  EXPECT_LE(lazy.CachedBytes(), lazy.BudgetBytes());
+  EXPECT_THROW(lazy[size], std::out_of_range);
+
+  // rows 37, 38, 39 are cached; reading 37 makes 38 the oldest
+  std::size_t computed = lazy.ComputedRows();
+  lazy[37];
+  lazy[0];
+  EXPECT_EQ(lazy.ComputedRows(), computed + 1);
+  lazy[37];
+  lazy[39];
+  EXPECT_EQ(lazy.ComputedRows(), computed + 1);
+  lazy[38];
+  EXPECT_EQ(lazy.ComputedRows(), computed + 2);
+
+  // readers of one row wait for a single search
+  s21_sp::LazyAllPairs shared(graph, 3 * row_bytes);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 8; ++t) {
+    readers.emplace_back([&shared] { shared[5]; });
+  }
+  for (auto& reader : readers) reader.join();
+  EXPECT_EQ(shared.ComputedRows(), 1u);
+
+  // a change of the graph drops the cached rows
+  int target = 1;
+  while (graph(0, target) != 0 || all[0][target] <= 1) ++target;
+  graph.AddEdge(0, target, 1);
+  all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  EXPECT_EQ(lazy[0][target], 1);
+  EXPECT_EQ(lazy[0].Vector(), all[0]);
+  EXPECT_EQ(lazy.CachedRows(), 1u);
+}
+
+TEST(GraphAlgorithmsTest, LazyAllPairsFollowsReassignedGraph) {
+  std::string filename = "test_graph.txt";
+  // both graphs are loaded once, so they went through as many changes
+  auto load = [&](s21_graph& graph, int weight) {
+    {
+      std::ofstream file(filename);
+      file << "0 " << weight << "\n" << weight << " 0\n";
+    }
+    graph.LoadFromFile(filename);
+    std::filesystem::remove(filename);
+  };
+
+  s21_graph graph;
+  load(graph, 5);
+  s21_sp::LazyAllPairs lazy(graph, 1024);
+  EXPECT_EQ(lazy[0][1], 5);
+
+  s21_graph other;
+  load(other, 9);
+  EXPECT_NE(other.GetVersion(), graph.GetVersion());
+  graph = std::move(other);
+  EXPECT_EQ(lazy[0][1], 9);
+}
+
+TEST(GraphAlgorithmsTest, DeltaSteppingMatchesFloydWarshall) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+  const int size = 40;
+
+  s21_test::LoadRandomGraph(graph, size, 3, 10, 50);
+  auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  auto expected = [&all](int i, int j) {
+    return i == j ? 0 : all[i][j] == 0 ? -1 : all[i][j];
+  };
+
+  // every width, from Dijkstra by buckets to Bellman-Ford, finds the same
+  s21::CsrGraph<int> csr = graph.ToCsr();
+  s21_sp::Distance max_weight = graph.GetMetadata().max_weight;
+  for (s21_sp::Distance delta : {1, 7, 1000}) {
+    s21_sp::DeltaStepping engine(csr, delta, max_weight);
+    engine.Run(0);
+    for (int j = 0; j < size; ++j) {
+      s21_sp::Distance distance = engine.DistanceTo(j);
+      ASSERT_EQ(distance == s21_sp::kUnreached ? -1 : distance,
+                expected(0, j));
+    }
+  }
+
+  graph.SetVertexOrder(VertexOrder::kBreadthFirst);
+  for (int i = 0; i < size; ++i) {
+    auto tree = s21_graph_algorithms::GetShortestPathTree(graph, i);
+    for (int j = 0; j < size; ++j) {
+      ASSERT_EQ(tree.distances[j], expected(i, j));
+      // the previous vertex continues a shortest path
+      int previous = tree.previous[j];
+      if (i == j || tree.distances[j] == -1) {
+        ASSERT_EQ(previous, -1);
+      } else {
+        ASSERT_EQ(tree.distances[previous] + graph(previous, j),
+                  tree.distances[j]);
+      }
+    }
+  }
+  EXPECT_THROW(s21_graph_algorithms::GetShortestPathTree(graph, size),
+               std::out_of_range);
+  EXPECT_THROW(s21_graph_algorithms::GetShortestPathTree(graph, -1),
+               std::out_of_range);
+
+  // a wide star puts thousands of vertices in one phase, split into blocks
+  const int wide = 3000;
+  {
+    std::ofstream file(filename);
+    file << "directed " << wide << "\n";
+    for (int v = 2; v <= wide; ++v) {
+      file << 1 << ' ' << v << ' ' << std::rand() % 20 + 1 << '\n';
+      file << v << ' ' << v % wide + 1 << ' ' << std::rand() % 20 + 1 << '\n';
+    }
+  }
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+  csr = graph.ToCsr();
+  max_weight = graph.GetMetadata().max_weight;
+  s21_sp::Dijkstra dijkstra(csr);
+  dijkstra.Run(0);
+  for (s21_sp::Distance delta : {1, 20}) {
+    s21_sp::DeltaStepping engine(csr, delta, max_weight);
+    engine.Run(0);
+    for (int v = 0; v < wide; ++v) {
+      ASSERT_EQ(engine.DistanceTo(v), dijkstra.DistanceTo(v));
+    }
+  }
+
+  // a long heavy path reaches far past the ring of buckets, which wraps
+  // around instead of growing with the distance
+  const int length = 500;
+  const int heavy = 60000;
+  {
+    std::ofstream file(filename);
+    file << "undirected " << length << "\n";
+    for (int v = 1; v < length; ++v) {
+      file << v << ' ' << v + 1 << ' ' << heavy - v % 3 << '\n';
+    }
+  }
+  graph.LoadFromEdgeList(filename);
+  std::filesystem::remove(filename);
+  csr = graph.ToCsr();
+  max_weight = graph.GetMetadata().max_weight;
+  for (s21_sp::Distance delta : {1, 7, heavy}) {
+    s21_sp::DeltaStepping engine(csr, delta, max_weight);
+    engine.Run(0);
+    s21_sp::Distance distance = 0;
+    for (int v = 1; v < length; ++v) {
+      distance += heavy - v % 3;
+      ASSERT_EQ(engine.DistanceTo(v), distance);
+      ASSERT_EQ(engine.Previous(v), v - 1);
+    }
+  }
+}
+
+TEST(GraphAlgorithmsTest, BucketQueueMatchesHeap) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+  const int size = 300;
+
+  // a ring keeps every vertex reachable, chords add ties and detours
+  for (int max_weight : {1, 3, 1000}) {
+    {
+      std::srand(max_weight);
+      std::ofstream file(filename);
+      file << "directed " << size << "\n";
+      for (int v = 1; v <= size; ++v) {
+        file << v << ' ' << v % size + 1 << ' '
+             << std::rand() % max_weight + 1 << '\n';
+        file << v << ' ' << std::rand() % size + 1 << ' '
+             << std::rand() % max_weight + 1 << '\n';
+      }
+    }
+    graph.LoadFromEdgeList(filename);
+    s21::CsrGraph<int> csr = graph.ToCsr();
+    s21_sp::Dijkstra heap(csr);
+    s21_sp::Dijkstra<s21::CsrGraph<int>, s21_sp::BucketQueue> buckets(
+        csr, max_weight);
+    // the engines are reused, so stopped searches must leave no entries
+    for (int start = 0; start < size; start += 7) {
+      int finish = (start * 13) % size;
+      ASSERT_EQ(buckets.Run(start, finish), heap.Run(start, finish));
+      buckets.Run(start);
+      heap.Run(start);
+      for (int v = 0; v < size; ++v) {
+        ASSERT_EQ(buckets.DistanceTo(v), heap.DistanceTo(v));
+      }
+    }
+  }
+  std::filesystem::remove(filename);
+
+  // the public query picks the bucket queue for weights up to 1000
+  s21::CsrGraph<int> csr = graph.ToCsr();
+  s21_sp::Dijkstra heap(csr);
+  auto [distance, path] =
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, size / 2);
+  EXPECT_EQ(distance, heap.Run(0, size / 2));
+  EXPECT_EQ(path.front(), 0);
+  EXPECT_EQ(path.back(), size / 2);
+}
+
+TEST(GraphAlgorithmsTest, DistanceTableMatchesFloydWarshall) {
+  s21_graph graph;
+  const int size = 40;
+
+  s21_test::LoadRandomGraph(graph, size, 5, 16, 50);
+  graph.SetVertexOrder(VertexOrder::kReverseCuthillMcKee);
+
+  auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  std::vector<int> sources(size);
+  std::iota(sources.begin(), sources.end(), 0);
+  std::vector<int> targets = {5, 0, 5, 39, 12};
+  auto table = s21_graph_algorithms::GetDistanceTable(graph, sources, targets);
+  ASSERT_EQ(table.sources, size);
+  ASSERT_EQ(table.targets, 5);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < table.targets; ++j) {
+      int expected = all[i][targets[j]];
+      if (expected == 0) expected = i == targets[j] ? 0 : -1;
+      ASSERT_EQ(table(i, j), expected);
+    }
+  }
+
+  EXPECT_TRUE(
+      s21_graph_algorithms::GetDistanceTable(graph, sources, {}).distances
+          .empty());
+  EXPECT_THROW(s21_graph_algorithms::GetDistanceTable(graph, {0}, {size}),
+               std::out_of_range);
+  EXPECT_THROW(s21_graph_algorithms::GetDistanceTable(graph, {-1}, {0}),
+               std::out_of_range);
+}
+
+TEST(GraphAlgorithmsTest, LandmarkSearchMatchesDijkstra) {
+  s21_graph graph;
+  const int size = 40;
+
+  s21_test::LoadRandomGraph(graph, size, 11, 6, 50);
+  graph.SetVertexOrder(VertexOrder::kReverseCuthillMcKee);
+
+  auto index = s21_sp::LandmarkIndex::Build(graph, 4);
+  ASSERT_EQ(index.Count(), 4);
+  EXPECT_FALSE(index.IsSymmetric());
+  EXPECT_FALSE(index.IsMemoryMapped());
+  auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(graph);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      if (all[i][j] > 0) {
+        ASSERT_LE(index.LowerBound(i, j), all[i][j]);
+      }
+      if (i == j) continue;
+      auto [distance, path] =
+          s21_graph_algorithms::GetShortestPathBetweenVertices(graph, i, j,
+                                                               index);
+      ASSERT_EQ(distance, all[i][j] == 0 ? -1 : all[i][j]);
+      if (distance != -1) {
+        ASSERT_EQ(path.front(), i);
+        ASSERT_EQ(path.back(), j);
+      }
+    }
+  }
+
+  // a saved index is mapped back and gives the same bounds
+  std::string index_file = "test_graph.landmarks";
+  index.Save(index_file);
+  auto mapped = s21_sp::LandmarkIndex::Load(index_file);
+  EXPECT_TRUE(mapped.IsMemoryMapped());
+  EXPECT_TRUE(mapped.Matches(graph));
+  EXPECT_TRUE(std::equal(mapped.Landmarks().begin(), mapped.Landmarks().end(),
+                         index.Landmarks().begin(), index.Landmarks().end()));
+  EXPECT_EQ(
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 7, mapped),
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 7));
+  // the save reads the mapping it replaces
+  mapped.Save(index_file);
+  auto saved = s21_sp::LandmarkIndex::Load(index_file);
+  for (int v = 0; v < size; ++v) {
+    ASSERT_EQ(saved.LowerBound(v, 7), index.LowerBound(v, 7));
+  }
+  {
+    std::fstream file(index_file, std::ios::in | std::ios::out |
+                                      std::ios::binary);
+    file.seekp(-1, std::ios::end);
+    file.put('\x7f');
+  }
+  EXPECT_THROW(s21_sp::LandmarkIndex::Load(index_file), std::logic_error);
+
+  // header fields are checked even when the checksum matches
+  auto tamper = [&](auto edit) {
+    index.Save(index_file);
+    s21_test::RewriteBinary<s21_sp::LandmarkFileHeader>(index_file, edit);
+    EXPECT_THROW(s21_sp::LandmarkIndex::Load(index_file), std::logic_error);
+  };
+  tamper([](auto& header, char*) { header.vertex_count = 2; });
+  tamper([](auto& header, char*) { header.vertex_count = 1ULL << 40; });
+  std::filesystem::remove(index_file);
+
+  // the vertex order does not matter, any change to the edges does
+  graph.SetVertexOrder(VertexOrder::kOriginal);
+  EXPECT_TRUE(index.Matches(graph));
+  int to = 1;
+  while (graph(0, to) == 0) ++to;
+  graph.SetWeight(0, to, graph(0, to) + 1);
+  EXPECT_FALSE(index.Matches(graph));
+  EXPECT_THROW(
+      s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, 7, index),
+      std::invalid_argument);
+}
+
+TEST(GraphAlgorithmsTest, ContractionHierarchyMatchesFloydWarshall) {
+  s21_graph graph;
+  const int size = 60;
+
+  s21_test::LoadRandomGraph(graph, size, 17, 12, 50);
+  graph.SetVertexOrder(VertexOrder::kBreadthFirst);
+
+  auto hierarchy = s21_sp::ContractionHierarchy::Build(graph);
+  ASSERT_EQ(hierarchy.Size(), size);
+  EXPECT_FALSE(hierarchy.IsMemoryMapped());
+  EXPECT_GT(hierarchy.ShortcutCount(), 0u);
+  auto all = s21_graph_algorithms::GetShortestPathsBetweenAllVertices(
+      graph, AllPairsAlgorithm::kFloydWarshall);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      if (i == j) continue;
+      auto [distance, path] =
+          s21_graph_algorithms::GetShortestPathBetweenVertices(graph, i, j,
+                                                               hierarchy);
+      ASSERT_EQ(distance, all[i][j] == 0 ? -1 : all[i][j]);
+      if (distance == -1) continue;
+      // the unpacked path is made of edges of the graph
+      ASSERT_EQ(path.front(), i);
+      ASSERT_EQ(path.back(), j);
+      int length = 0;
+      for (std::size_t k = 1; k < path.size(); ++k) {
+        ASSERT_GT(graph(path[k - 1], path[k]), 0);
+        length += graph(path[k - 1], path[k]);
+      }
+      ASSERT_EQ(length, distance);
+    }
+  }
+
+  // a saved hierarchy is mapped back and answers the same
+  std::string hierarchy_file = "test_graph.ch";
+  hierarchy.Save(hierarchy_file);
+  auto mapped = s21_sp::ContractionHierarchy::Load(hierarchy_file);
+  EXPECT_TRUE(mapped.IsMemoryMapped());
+  EXPECT_TRUE(mapped.Matches(graph));
+  EXPECT_EQ(mapped.ShortcutCount(), hierarchy.ShortcutCount());
+  for (int j = 1; j < size; ++j) {
+    ASSERT_EQ(
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, j,
+                                                             mapped),
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, j,
+                                                             hierarchy));
+  }
+  // the save reads the mapping it replaces
+  mapped.Save(hierarchy_file);
+  auto saved = s21_sp::ContractionHierarchy::Load(hierarchy_file);
+  for (int j = 1; j < size; ++j) {
+    ASSERT_EQ(
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, j,
+                                                             saved),
+        s21_graph_algorithms::GetShortestPathBetweenVertices(graph, 0, j,
+                                                             hierarchy));
+  }
+  {
+    std::fstream file(hierarchy_file, std::ios::in | std::ios::out |
+                                          std::ios::binary);
+    file.seekp(-1, std::ios::end);
+    file.put('\x7f');
+  }
+  EXPECT_THROW(s21_sp::ContractionHierarchy::Load(hierarchy_file),
+               std::logic_error);
+
+  // the checksum of every edit is fixed, so only the checks of the arrays
+  // can reject it
+  auto tamper = [&](auto edit) {
+    hierarchy.Save(hierarchy_file);
+    s21_test::RewriteBinary<s21_sp::ContractionFileHeader>(hierarchy_file,
+                                                           edit);
+    EXPECT_THROW(s21_sp::ContractionHierarchy::Load(hierarchy_file),
+                 std::logic_error);
+  };
+  const std::size_t ranks = s21::AlignBinary(size * sizeof(int));
+  const std::size_t offsets = s21::AlignBinary((size + 1) * 8);
+  auto write = [](char* target, auto value) {
+    std::memcpy(target, &value, sizeof(value));
+  };
+  tamper([](auto& header, char*) { header.vertex_count = 1ULL << 40; });
+  tamper([&](auto&, char* payload) {
+    write(payload + ranks, hierarchy.Rank(1));  // two vertices of one rank
+  });
+  tamper([&](auto& header, char* payload) {
+    write(payload + 2 * ranks + 8, header.up_arcs + 1);
+  });
+  tamper([&](auto&, char* payload) {
+    write(payload + 2 * ranks + offsets, size);  // first upward head
+  });
+  tamper([&](auto& header, char* payload) {
+    // the first upward arc bypasses the top of the hierarchy
+    const std::size_t heads = s21::AlignBinary(header.up_arcs * sizeof(int));
+    write(payload + 2 * ranks + offsets + heads, size - 1);
+  });
+  std::filesystem::remove(hierarchy_file);
+
+  // the layout does not matter, any change to the edges does
+  graph.SetLayout(GraphLayout::kDense);
+  EXPECT_TRUE(hierarchy.Matches(graph));
+  int to = 1;
+  while (graph(0, to) == 0) ++to;
+  graph.SetWeight(0, to, graph(0, to) + 1);
+  EXPECT_FALSE(hierarchy.Matches(graph));
+  EXPECT_THROW(s21_graph_algorithms::GetShortestPathBetweenVertices(
+                   graph, 0, 7, hierarchy),
+               std::invalid_argument);
+}
+
 // TSP tests
 TEST(TSPTest, ACO_incorrect_algorithm) {
   s21_graph graph;
@@ -327,6 +1246,39 @@ TEST(TSPTest, ACO_connected_graph) {
   EXPECT_EQ(result.vertices.size(), 4);
 }
 
+TEST(TSPTest, Unreachable_vertices_throw) {
+  s21_graph graph;
+  std::string filename = "test_graph.txt";
+
+  // two components, then a path that only runs one way
+  for (const char* matrix : {"0 1 0 0\n1 0 0 0\n0 0 0 1\n0 0 1 0\n",
+                             "0 1 0 0\n0 0 1 0\n0 0 0 1\n0 0 1 0\n"}) {
+    {
+      std::ofstream file(filename);
+      file << matrix;
+    }
+    graph.LoadFromFile(filename);
+    for (TSPAlgorithm algorithm :
+         {TSPAlgorithm::ACO, TSPAlgorithm::NEAREST_NEIGHBOR,
+          TSPAlgorithm::BRUTE_FORCE}) {
+      EXPECT_THROW(
+          s21_graph_algorithms::SolveTravelingSalesmanProblem(graph, algorithm),
+          std::invalid_argument);
+    }
+  }
+
+  // a directed ring is strongly connected, so the solvers search it
+  {
+    std::ofstream file(filename);
+    file << "0 1 0\n0 0 2\n3 0 0\n";
+  }
+  graph.LoadFromFile(filename);
+  std::filesystem::remove(filename);
+  auto result = s21_graph_algorithms::SolveTravelingSalesmanProblem(
+      graph, TSPAlgorithm::BRUTE_FORCE);
+  EXPECT_EQ(result.distance, 6);
+}
+
 TEST(TSPTest, NN_connected_graph) {
   s21_graph graph;
   std::string filename = "test_graph.txt";
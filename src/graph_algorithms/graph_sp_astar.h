@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "graph_sp_dijkstra.h"
+
+namespace s21_sp {
+
+/**
+ * @brief A* search: Dijkstra's algorithm with vertices queued by their
+ * distance plus a lower bound on the distance left to the target.
+ *
+ * Vertices towards the target come out of the heap first, so a good bound
+ * (such as LandmarkPotential) settles far fewer vertices than Dijkstra. The
+ * result is exact for any bound that never overestimates. A vertex reached
+ * again by a shorter path is queued again, so bounds that are admissible
+ * but not consistent are fine too. Vertices with a bound of kUnreached
+ * cannot reach the target and are not queued.
+ * @tparam Graph A sparse view (see VisitSparseView).
+ */
+template <typename Graph>
+class AStar {
+ public:
+  /**
+   * @brief Creates an engine for graph; the graph must outlive it.
+   */
+  explicit AStar(const Graph& graph) : graph_(graph), space_(graph.Size()) {}
+
+  /**
+   * @brief Searches from start until finish is settled.
+   * @param potential Callable giving a lower bound on the distance from a
+   * vertex to finish, or kUnreached if there is no path.
+   * @return The distance to finish, kUnreached if it cannot be reached.
+   */
+  template <typename Potential>
+  Distance Run(int start, int finish, const Potential& potential) {
+    space_.Start(start);
+    settled_ = 0;
+    IndexedHeap& heap = space_.Heap();
+    while (!heap.Empty()) {
+      const int v = heap.Pop().first;
+      ++settled_;
+      const Distance distance = space_.DistanceTo(v);
+      if (v == finish) return distance;
+      graph_.ForEachNeighbor(v, [&](int u, auto weight) {
+        Distance candidate = distance + static_cast<Distance>(weight);
+        if (candidate >= space_.DistanceTo(u)) return;
+        Distance bound = potential(u);
+        if (bound != kUnreached) {
+          space_.Reach(u, candidate, v, candidate + bound);
+        }
+      });
+    }
+    return kUnreached;
+  }
+
+  /**
+   * @brief Gets the path the last search found to finish.
+   * @return The vertices from the start to finish, empty if finish was not
+   * reached.
+   */
+  std::vector<int> Path(int finish) const { return space_.PathTo(finish); }
+
+  /**
+   * @brief Gets the number of vertices the last search settled.
+   */
+  std::size_t SettledCount() const { return settled_; }
+
+ private:
+  const Graph& graph_;        ///< The searched graph.
+  SearchSpace space_;         ///< Labels of the last search.
+  std::size_t settled_ = 0;  ///< Vertices settled by the last search.
+};
+
+}  // namespace s21_sp
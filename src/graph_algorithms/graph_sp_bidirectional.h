@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "graph_sp_dijkstra.h"
+
+namespace s21_sp {
+
+/**
+ * @brief Dijkstra's algorithm run from both ends of a query at once.
+ *
+ * A forward search from the start runs over the graph, and a backward
+ * search from the target runs over the reversed graph. Each step settles
+ * the vertex with the smaller key of the two. Where the searches touch,
+ * the best total is kept. The query stops once the two smallest keys add
+ * up to at least that total: every path still to be found would be at
+ * least as long. On road-like graphs the two searches cover two disks of
+ * half the radius, about half the vertices of one search.
+ * @tparam Forward A sparse view of the graph (see VisitSparseView).
+ * @tparam Backward A sparse view of the reversed graph; the same as
+ * Forward for undirected graphs.
+ */
+template <typename Forward, typename Backward>
+class BidirectionalDijkstra {
+ public:
+  /**
+   * @brief Creates an engine; the graphs must outlive it.
+   */
+  BidirectionalDijkstra(const Forward& forward, const Backward& backward)
+      : forward_graph_(forward),
+        backward_graph_(backward),
+        forward_(forward.Size()),
+        backward_(forward.Size()) {}
+
+  /**
+   * @brief Finds the shortest path from start to finish.
+   * @return Its length, kUnreached if finish cannot be reached.
+   */
+  Distance Run(int start, int finish) {
+    forward_.Start(start);
+    backward_.Start(finish);
+    best_ = start == finish ? 0 : kUnreached;
+    meeting_ = start == finish ? start : -1;
+    settled_ = 0;
+    IndexedHeap& forward_heap = forward_.Heap();
+    IndexedHeap& backward_heap = backward_.Heap();
+    while (!forward_heap.Empty() && !backward_heap.Empty()) {
+      Distance forward_key = forward_heap.TopKey();
+      Distance backward_key = backward_heap.TopKey();
+      if (best_ != kUnreached && forward_key + backward_key >= best_) break;
+      ++settled_;
+      if (forward_key <= backward_key) {
+        Settle(forward_graph_, forward_, backward_);
+      } else {
+        Settle(backward_graph_, backward_, forward_);
+      }
+    }
+    return best_;
+  }
+
+  /**
+   * @brief Gets the path the last query found.
+   * @return The vertices from the start to the target, empty if the target
+   * was not reached.
+   */
+  std::vector<int> Path() const {
+    if (meeting_ < 0) return {};
+    std::vector<int> path = forward_.PathTo(meeting_);
+    // the backward labels lead from the meeting vertex on to the target
+    for (int v = meeting_; v != backward_.Previous(v);) {
+      v = backward_.Previous(v);
+      path.push_back(v);
+    }
+    return path;
+  }
+
+  /**
+   * @brief Gets the number of vertices both searches of the last query
+   * settled.
+   */
+  std::size_t SettledCount() const { return settled_; }
+
+ private:
+  const Forward& forward_graph_;    ///< Graph of the forward search.
+  const Backward& backward_graph_;  ///< Reversed graph of the backward one.
+  SearchSpace forward_;             ///< Labels from the start.
+  SearchSpace backward_;            ///< Labels from the target.
+  Distance best_ = kUnreached;      ///< Shortest path found so far.
+  int meeting_ = -1;  ///< Vertex where the searches meet on it, -1 if none.
+  std::size_t settled_ = 0;  ///< Vertices settled by the last query.
+
+  /**
+   * @brief Settles the nearest vertex of one search and relaxes its edges,
+   * recording better paths through vertices the other search reached.
+   */
+  template <typename Graph>
+  void Settle(const Graph& graph, SearchSpace& side,
+              const SearchSpace& other) {
+    const auto [v, distance] = side.Heap().Pop();
+    graph.ForEachNeighbor(v, [&](int u, auto weight) {
+      Distance candidate = distance + static_cast<Distance>(weight);
+      if (candidate >= side.DistanceTo(u)) return;
+      side.Reach(u, candidate, v);
+      Distance rest = other.DistanceTo(u);
+      if (rest != kUnreached && candidate + rest < best_) {
+        best_ = candidate + rest;
+        meeting_ = u;
+      }
+    });
+  }
+};
+
+}  // namespace s21_sp
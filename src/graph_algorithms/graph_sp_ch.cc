@@ -0,0 +1,542 @@
+#include "graph_sp_ch.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "../utils/parallel.h"
+
+namespace s21_sp {
+
+namespace {
+
+const std::string kFormat = "contraction hierarchy";
+
+/**
+ * @brief Contracts a graph vertex by vertex; all ids are storage ids.
+ */
+class Contractor {
+ public:
+  /**
+   * @brief An arc of the remaining graph.
+   */
+  struct Arc {
+    int head;         ///< Other end.
+    Distance weight;  ///< Length.
+    int middle;       ///< Bypassed vertex, -1 for edges of the graph.
+  };
+
+  /**
+   * @brief A shortcut found when contracting a vertex.
+   */
+  struct Shortcut {
+    int from;         ///< Tail.
+    int to;           ///< Head.
+    Distance weight;  ///< Length of the path through the vertex.
+  };
+
+  explicit Contractor(const s21_graph& graph)
+      : out_(graph.Size()),
+        in_(graph.Size()),
+        up_(graph.Size()),
+        down_(graph.Size()),
+        priority_(graph.Size()),
+        deleted_(graph.Size()),
+        contracting_(graph.Size()) {
+    for (int v = 0; v < graph.Size(); ++v) {
+      graph.ForEachStoredNeighbor(v, [&](int u, int weight) {
+        if (u == v) return;
+        out_[v].push_back({u, weight, -1});
+        in_[u].push_back({v, weight, -1});
+      });
+    }
+    for (unsigned w = 0; w < s21::WorkerCount(); ++w) {
+      spaces_.emplace_back(graph.Size());
+    }
+  }
+
+  /**
+   * @brief Contracts every vertex.
+   * @return The vertices in the order they were contracted.
+   */
+  std::vector<int> Run() {
+    std::vector<int> remaining(out_.size());
+    for (std::size_t v = 0; v < remaining.size(); ++v) {
+      remaining[v] = static_cast<int>(v);
+    }
+    ForEach(remaining, [this](int v, std::size_t, SearchSpace& space) {
+      priority_[v] = Priority(v, space);
+    });
+
+    std::vector<int> order;
+    while (!remaining.empty() && !IsCore(remaining)) {
+      std::vector<char> selected(remaining.size());
+      ForEach(remaining, [&](int v, std::size_t i, SearchSpace&) {
+        selected[i] = IsLocalMinimum(v);
+      });
+      std::vector<int> round;
+      for (std::size_t i = 0; i < remaining.size(); ++i) {
+        if (selected[i]) round.push_back(remaining[i]);
+      }
+
+      // witnesses must survive the round, so they avoid all of its vertices
+      for (int v : round) contracting_[v] = true;
+      std::vector<std::vector<Shortcut>> shortcuts(round.size());
+      ForEach(round, [&](int v, std::size_t i, SearchSpace& space) {
+        FindShortcuts(v, ContractionHierarchy::kWitnessSettleLimit, space,
+                      [&](int from, int to, Distance weight) {
+                        shortcuts[i].push_back({from, to, weight});
+                      });
+      });
+      std::vector<int> neighbours;
+      for (std::size_t i = 0; i < round.size(); ++i) {
+        Contract(round[i], shortcuts[i], neighbours);
+        order.push_back(round[i]);
+      }
+      for (int v : round) contracting_[v] = false;
+
+      std::sort(neighbours.begin(), neighbours.end());
+      neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                       neighbours.end());
+      ForEach(neighbours, [this](int v, std::size_t, SearchSpace& space) {
+        priority_[v] = Priority(v, space);
+      });
+      std::size_t kept = 0;
+      for (std::size_t i = 0; i < remaining.size(); ++i) {
+        if (!selected[i]) remaining[kept++] = remaining[i];
+      }
+      remaining.resize(kept);
+    }
+    // the core keeps its arcs both ways and is searched in full
+    for (int v : remaining) {
+      up_[v] = out_[v];
+      down_[v] = in_[v];
+      order.push_back(v);
+    }
+    return order;
+  }
+
+  /**
+   * @brief Gets the arcs a vertex had to higher ranks when contracted.
+   */
+  const std::vector<Arc>& Up(int v) const { return up_[v]; }
+
+  /**
+   * @brief Gets the arcs a vertex had from higher ranks when contracted.
+   */
+  const std::vector<Arc>& Down(int v) const { return down_[v]; }
+
+ private:
+  static constexpr std::size_t kBlock = 64;  ///< Vertices per work item.
+
+  std::vector<std::vector<Arc>> out_;  ///< Remaining arcs by tail.
+  std::vector<std::vector<Arc>> in_;   ///< Remaining arcs by head.
+  std::vector<std::vector<Arc>> up_;   ///< Out arcs at contraction.
+  std::vector<std::vector<Arc>> down_;  ///< In arcs at contraction.
+  std::vector<int> priority_;  ///< Contraction priority, lowest first.
+  std::vector<int> deleted_;   ///< Neighbours contracted so far.
+  std::vector<char> contracting_;  ///< Vertices of the current round.
+  std::vector<SearchSpace> spaces_;  ///< Witness search labels per worker.
+
+  /**
+   * @brief Calls task(vertices[i], i, space) for every i in parallel; each
+   * worker has its own search space.
+   */
+  template <typename Task>
+  void ForEach(const std::vector<int>& vertices, Task&& task) {
+    std::atomic<std::size_t> next{0};
+    s21::ParallelFor(spaces_.size(), [&](std::size_t worker) {
+      for (std::size_t begin = next.fetch_add(kBlock);
+           begin < vertices.size(); begin = next.fetch_add(kBlock)) {
+        std::size_t end = std::min(begin + kBlock, vertices.size());
+        for (std::size_t i = begin; i < end; ++i) {
+          task(vertices[i], i, spaces_[worker]);
+        }
+      }
+    });
+  }
+
+  /**
+   * @brief Checks whether the remaining graph is too dense to contract
+   * further: shortcuts would then grow quadratically.
+   */
+  bool IsCore(const std::vector<int>& remaining) const {
+    std::size_t arcs = 0;
+    for (int v : remaining) arcs += out_[v].size();
+    return arcs > ContractionHierarchy::kCoreDegree * remaining.size();
+  }
+
+  /**
+   * @brief Checks whether a vertex goes before all its remaining neighbours,
+   * ties broken by id.
+   */
+  bool IsLocalMinimum(int v) const {
+    auto before = [this, v](const Arc& arc) {
+      int u = arc.head;
+      return priority_[v] < priority_[u] ||
+             (priority_[v] == priority_[u] && v < u);
+    };
+    return std::all_of(out_[v].begin(), out_[v].end(), before) &&
+           std::all_of(in_[v].begin(), in_[v].end(), before);
+  }
+
+  /**
+   * @brief Estimates how late a vertex should be contracted: 2 * (the
+   * shortcuts it needs - the arcs it removes), plus the neighbours already
+   * contracted, which spreads contraction evenly. The factor lets the edge
+   * difference outweigh the spreading term.
+   */
+  int Priority(int v, SearchSpace& space) {
+    int shortcuts = 0;
+    FindShortcuts(v, ContractionHierarchy::kEstimateSettleLimit, space,
+                  [&shortcuts](int, int, Distance) { ++shortcuts; });
+    int removed = static_cast<int>(out_[v].size() + in_[v].size());
+    return 2 * (shortcuts - removed) + deleted_[v];
+  }
+
+  /**
+   * @brief Calls found(from, to, weight) for every shortcut contracting v
+   * needs: every path from -> v -> to without a witness.
+   */
+  template <typename Found>
+  void FindShortcuts(int v, int settle_limit, SearchSpace& space,
+                     Found&& found) {
+    Distance longest = 0;
+    for (const Arc& out : out_[v]) longest = std::max(longest, out.weight);
+    for (const Arc& in : in_[v]) {
+      WitnessSearch(in.head, v, in.weight + longest, settle_limit, space);
+      for (const Arc& out : out_[v]) {
+        Distance via = in.weight + out.weight;
+        if (out.head != in.head && space.DistanceTo(out.head) > via) {
+          found(in.head, out.head, via);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Runs Dijkstra's algorithm from source over the remaining graph,
+   * without v and the vertices of the round, up to limit and at most
+   * settle_limit settled vertices. Labels left are upper bounds.
+   */
+  void WitnessSearch(int source, int v, Distance limit, int settle_limit,
+                     SearchSpace& space) {
+    space.Start(source);
+    IndexedHeap& heap = space.Heap();
+    for (int settled = 0; !heap.Empty() && settled < settle_limit;
+         ++settled) {
+      const auto [u, distance] = heap.Pop();
+      for (const Arc& arc : out_[u]) {
+        if (arc.head == v || contracting_[arc.head]) continue;
+        Distance candidate = distance + arc.weight;
+        if (candidate <= limit && candidate < space.DistanceTo(arc.head)) {
+          space.Reach(arc.head, candidate, u);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Removes v from the remaining graph and adds its shortcuts.
+   * @param neighbours Collects the vertices whose priority may change.
+   */
+  void Contract(int v, const std::vector<Shortcut>& shortcuts,
+                std::vector<int>& neighbours) {
+    up_[v] = std::move(out_[v]);
+    down_[v] = std::move(in_[v]);
+    out_[v].clear();
+    in_[v].clear();
+    for (const Arc& arc : up_[v]) {
+      Erase(in_[arc.head], v);
+      ++deleted_[arc.head];
+      neighbours.push_back(arc.head);
+    }
+    for (const Arc& arc : down_[v]) {
+      Erase(out_[arc.head], v);
+      ++deleted_[arc.head];
+      neighbours.push_back(arc.head);
+    }
+    for (const Shortcut& shortcut : shortcuts) {
+      Insert(out_[shortcut.from], {shortcut.to, shortcut.weight, v});
+      Insert(in_[shortcut.to], {shortcut.from, shortcut.weight, v});
+    }
+  }
+
+  static void Erase(std::vector<Arc>& arcs, int head) {
+    std::erase_if(arcs, [head](const Arc& arc) { return arc.head == head; });
+  }
+
+  /**
+   * @brief Adds an arc, or shortens the arc to the same head.
+   */
+  static void Insert(std::vector<Arc>& arcs, const Arc& arc) {
+    for (Arc& existing : arcs) {
+      if (existing.head == arc.head) {
+        if (arc.weight < existing.weight) existing = arc;
+        return;
+      }
+    }
+    arcs.push_back(arc);
+  }
+};
+
+}  // namespace
+
+ContractionHierarchy ContractionHierarchy::Build(const s21_graph& graph) {
+  Contractor contractor(graph);
+  const std::vector<int> order = contractor.Run();
+
+  const int size = graph.Size();
+  Arrays arrays;
+  arrays.order.resize(size);
+  arrays.rank.resize(size);
+  std::vector<int> rank(size);  // by storage id
+  for (int r = 0; r < size; ++r) {
+    rank[order[r]] = r;
+    arrays.order[r] = graph.OriginalId(order[r]);
+    arrays.rank[arrays.order[r]] = r;
+  }
+  auto fill = [&](Arrays::OwnedArcs& arcs, auto arcs_of) {
+    arcs.offsets.push_back(0);
+    for (int v : order) {
+      for (const Contractor::Arc& arc : arcs_of(v)) {
+        arcs.heads.push_back(rank[arc.head]);
+        arcs.middles.push_back(arc.middle < 0 ? -1 : rank[arc.middle]);
+        arcs.weights.push_back(arc.weight);
+      }
+      arcs.offsets.push_back(arcs.heads.size());
+    }
+  };
+  fill(arrays.up, [&](int v) -> const auto& { return contractor.Up(v); });
+  fill(arrays.down, [&](int v) -> const auto& { return contractor.Down(v); });
+
+  ContractionHierarchy hierarchy;
+  hierarchy.edge_count_ = graph.GetMetadata().edge_count;
+  hierarchy.fingerprint_ = graph.GetFingerprint();
+  hierarchy.Adopt(std::make_shared<const Arrays>(std::move(arrays)));
+  return hierarchy;
+}
+
+void ContractionHierarchy::Adopt(std::shared_ptr<const Arrays> arrays) {
+  order_ = arrays->order;
+  rank_ = arrays->rank;
+  auto view = [](const Arrays::OwnedArcs& arcs) {
+    return Arcs{arcs.offsets, arcs.heads, arcs.middles, arcs.weights};
+  };
+  up_ = view(arrays->up);
+  down_ = view(arrays->down);
+  arrays_ = std::move(arrays);
+}
+
+ContractionHierarchy ContractionHierarchy::Load(const std::string& filename) {
+  auto file = std::make_shared<const s21::MappedFile>(filename);
+
+  auto header =
+      s21::ReadBinaryHeader<ContractionFileHeader>(*file, kFormat);
+
+  // ranks and vertex ids are ints
+  if (header.vertex_count >=
+      static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+    s21::InvalidBinaryFile(kFormat, "too many vertices");
+  }
+
+  ContractionHierarchy hierarchy;
+  const std::size_t size = header.vertex_count;
+  s21::BinarySectionReader reader(file->Data() + sizeof(header),
+                                  header.payload_bytes, kFormat);
+  hierarchy.order_ = reader.Next<int>(size, [&](int vertex) {
+    if (vertex < 0 || static_cast<std::size_t>(vertex) >= size) {
+      reader.Fail("vertex out of range");
+    }
+  });
+  // rank and order must be inverse permutations
+  std::size_t vertex = 0;
+  hierarchy.rank_ = reader.Next<int>(size, [&](int rank) {
+    if (rank < 0 || static_cast<std::size_t>(rank) >= size ||
+        static_cast<std::size_t>(hierarchy.order_[rank]) != vertex) {
+      reader.Fail("inconsistent ranks");
+    }
+    ++vertex;
+  });
+  auto arcs = [&](std::uint64_t count) {
+    Arcs arcs;
+    std::uint64_t previous = 0;
+    bool first = true;
+    arcs.offsets = reader.Next<std::uint64_t>(
+        size + 1, [&](std::uint64_t offset) {
+          if ((first && offset != 0) || offset < previous || offset > count) {
+            reader.Fail("inconsistent arc offsets");
+          }
+          previous = offset;
+          first = false;
+        });
+    if (arcs.offsets.back() != count) reader.Fail("inconsistent arc offsets");
+    arcs.heads = reader.Next<int>(count, [&](int head) {
+      if (head < 0 || static_cast<std::size_t>(head) >= size) {
+        reader.Fail("arc head out of range");
+      }
+    });
+    // a shortcut bypasses a vertex ranked below both its ends, which is what
+    // makes unpacking end
+    std::size_t v = 0;
+    std::size_t arc = 0;
+    arcs.middles = reader.Next<int>(count, [&](int middle) {
+      while (arcs.offsets[v + 1] <= arc) ++v;
+      if (middle < -1 ||
+          (middle >= 0 && (static_cast<std::size_t>(middle) >= v ||
+                           middle >= arcs.heads[arc]))) {
+        reader.Fail("shortcut middle out of order");
+      }
+      ++arc;
+    });
+    arcs.weights = reader.Next<Distance>(count, [&](Distance weight) {
+      if (weight <= 0) reader.Fail("non-positive arc weight");
+    });
+    return arcs;
+  };
+  hierarchy.up_ = arcs(header.up_arcs);
+  hierarchy.down_ = arcs(header.down_arcs);
+  reader.Finish(header);
+  hierarchy.edge_count_ = header.edge_count;
+  hierarchy.fingerprint_ = header.fingerprint;
+  hierarchy.owner_ = std::move(file);
+  return hierarchy;
+}
+
+void ContractionHierarchy::Save(const std::string& filename) const {
+  // the arrays may still be borrowed from a mapping of this file
+  s21::ReplacingFile output(filename);
+  std::ofstream& file = output.Stream();
+
+  ContractionFileHeader header;
+  header.vertex_count = order_.size();
+  header.edge_count = edge_count_;
+  header.fingerprint = fingerprint_;
+  header.up_arcs = up_.heads.size();
+  header.down_arcs = down_.heads.size();
+  // the header is rewritten once the checksum is known
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  s21::BinarySectionWriter writer(file);
+  writer.Write(order_);
+  writer.Write(rank_);
+  for (const Arcs* arcs : {&up_, &down_}) {
+    writer.Write(arcs->offsets);
+    writer.Write(arcs->heads);
+    writer.Write(arcs->middles);
+    writer.Write(arcs->weights);
+  }
+  writer.Finish(header, filename);
+  output.Commit();
+}
+
+std::size_t ContractionHierarchy::ShortcutCount() const {
+  auto shortcut = [](int middle) { return middle >= 0; };
+  return std::count_if(up_.middles.begin(), up_.middles.end(), shortcut) +
+         std::count_if(down_.middles.begin(), down_.middles.end(), shortcut);
+}
+
+std::size_t ContractionHierarchy::MemoryBytes() const {
+  std::size_t bytes = order_.size_bytes() + rank_.size_bytes();
+  for (const Arcs* arcs : {&up_, &down_}) {
+    bytes += arcs->offsets.size_bytes() + arcs->heads.size_bytes() +
+             arcs->middles.size_bytes() + arcs->weights.size_bytes();
+  }
+  return bytes;
+}
+
+bool ContractionHierarchy::Matches(const s21_graph& graph) const {
+  return graph.Size() == Size() &&
+         graph.GetMetadata().edge_count == edge_count_ &&
+         graph.GetFingerprint() == fingerprint_;
+}
+
+ContractionQuery::ContractionQuery(const ContractionHierarchy& hierarchy)
+    : hierarchy_(hierarchy),
+      forward_(hierarchy.Size()),
+      backward_(hierarchy.Size()) {}
+
+Distance ContractionQuery::Run(int start, int finish) {
+  start = hierarchy_.Rank(start);
+  finish = hierarchy_.Rank(finish);
+  forward_.Start(start);
+  backward_.Start(finish);
+  best_ = start == finish ? 0 : kUnreached;
+  meeting_ = start == finish ? start : -1;
+  settled_ = 0;
+  auto open = [this](SearchSpace& side) {
+    return !side.Heap().Empty() && side.Heap().TopKey() < best_;
+  };
+  for (;;) {
+    bool forward = open(forward_);
+    bool backward = open(backward_);
+    if (!forward && !backward) break;
+    ++settled_;
+    if (forward && (!backward || forward_.Heap().TopKey() <=
+                                     backward_.Heap().TopKey())) {
+      Settle(hierarchy_.Up(), hierarchy_.Down(), forward_, backward_);
+    } else {
+      Settle(hierarchy_.Down(), hierarchy_.Up(), backward_, forward_);
+    }
+  }
+  return best_;
+}
+
+void ContractionQuery::Settle(const ContractionHierarchy::Arcs& arcs,
+                              const ContractionHierarchy::Arcs& stall,
+                              SearchSpace& side, const SearchSpace& other) {
+  const auto [v, distance] = side.Heap().Pop();
+  for (std::uint64_t a = stall.offsets[v]; a < stall.offsets[v + 1]; ++a) {
+    Distance above = side.DistanceTo(stall.heads[a]);
+    if (above != kUnreached && above + stall.weights[a] < distance) return;
+  }
+  for (std::uint64_t a = arcs.offsets[v]; a < arcs.offsets[v + 1]; ++a) {
+    const int u = arcs.heads[a];
+    Distance candidate = distance + arcs.weights[a];
+    if (candidate >= side.DistanceTo(u)) continue;
+    side.Reach(u, candidate, v);
+    Distance rest = other.DistanceTo(u);
+    if (rest != kUnreached && candidate + rest < best_) {
+      best_ = candidate + rest;
+      meeting_ = u;
+    }
+  }
+}
+
+std::vector<int> ContractionQuery::Path() const {
+  if (meeting_ < 0) return {};
+  const std::vector<int> climb = forward_.PathTo(meeting_);
+  std::vector<int> path{hierarchy_.VertexAt(climb.front())};
+  for (std::size_t i = 1; i < climb.size(); ++i) {
+    Unpack(climb[i - 1], climb[i],
+           hierarchy_.Up().Middle(climb[i - 1], climb[i]), path);
+  }
+  // the backward labels descend from the meeting vertex to the target
+  for (int v = meeting_; v != backward_.Previous(v);) {
+    int next = backward_.Previous(v);
+    Unpack(v, next, hierarchy_.Down().Middle(next, v), path);
+    v = next;
+  }
+  return path;
+}
+
+void ContractionQuery::Unpack(int from, int to, int middle,
+                              std::vector<int>& path) const {
+  std::vector<std::array<int, 3>> stack{{from, to, middle}};
+  while (!stack.empty()) {
+    const auto [a, b, c] = stack.back();
+    stack.pop_back();
+    if (c < 0) {
+      path.push_back(hierarchy_.VertexAt(b));
+      continue;
+    }
+    // a -> c is a downward arc of c and c -> b an upward one; a -> c first
+    stack.push_back({c, b, hierarchy_.Up().Middle(c, b)});
+    stack.push_back({a, c, hierarchy_.Down().Middle(c, a)});
+  }
+}
+
+}  // namespace s21_sp
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../graph/graph.h"
+#include "graph_sp_dijkstra.h"
+
+namespace s21_sp {
+
+/**
+ * @brief Current version of the contraction hierarchy file format.
+ */
+inline constexpr std::uint32_t kContractionFormatVersion = 3;
+
+/**
+ * @brief Fixed-size header at the start of a contraction hierarchy file.
+ *
+ * The header is followed by sections, each zero-padded to
+ * s21::kBinaryAlignment bytes: the vertices by rank and the ranks by vertex
+ * (int32 each, vertex_count entries), then the upward and the downward arcs
+ * (see ContractionHierarchy::Arcs), each as vertex_count + 1 offsets
+ * (uint64), heads and middles (int32) and weights (int64).
+ */
+struct ContractionFileHeader {
+  char magic[4] = {'S', '2', '1', 'C'};  ///< File signature.
+  std::uint32_t version = kContractionFormatVersion;   ///< Format version.
+  std::uint32_t byte_order = s21::kBinaryByteOrderMark;  ///< Byte order mark.
+  std::uint32_t reserved = 0;        ///< Zero.
+  std::uint64_t vertex_count = 0;    ///< Vertices of the graph.
+  std::uint64_t edge_count = 0;      ///< Stored edges of the graph.
+  std::uint64_t up_arcs = 0;         ///< Arcs of the upward graph.
+  std::uint64_t down_arcs = 0;       ///< Arcs of the downward graph.
+  std::uint64_t payload_bytes = 0;   ///< Bytes following the header.
+  std::uint64_t checksum = 0;        ///< See s21::BinaryFileChecksum.
+  std::uint64_t fingerprint = 0;     ///< s21_graph::GetFingerprint().
+  std::uint64_t padding[7] = {};     ///< Zero.
+};
+
+static_assert(sizeof(ContractionFileHeader) % s21::kBinaryAlignment == 0,
+              "the payload must start on an aligned offset");
+
+/**
+ * @brief A contraction hierarchy: the graph with every vertex ranked and
+ * shortcut edges that let queries only ever climb in rank.
+ *
+ * Vertices are contracted one by one from the least important: a contracted
+ * vertex is removed, and a shortcut u -> x is added for every path
+ * u -> v -> x that no other path of at most the same length (a witness)
+ * replaces. A shortest path then always exists that first climbs and then
+ * descends in rank, and two small searches that only climb find it (see
+ * ContractionQuery).
+ *
+ * Preprocessing runs in rounds. Each round contracts, in parallel, the
+ * vertices whose priority is lower than that of all their neighbours:
+ * twice the shortcuts they would add minus the edges they remove, plus the
+ * neighbours already contracted. The vertices of a round are not adjacent,
+ * and witness searches avoid all of them, so they do not depend on each
+ * other.
+ * Graphs with many long edges get denser as they shrink; once the remaining
+ * vertices average kCoreDegree arcs, they are left uncontracted as a core
+ * that keeps its arcs both ways and that queries search in full.
+ *
+ * Vertices are renumbered by rank, so the top of the hierarchy, where all
+ * queries meet, is stored together. The arcs are kept in two sparse graphs:
+ * upward arcs v -> x and downward arcs u -> v (stored at v) with x and u
+ * ranked above v. Each arc keeps the vertex it bypasses, so paths are
+ * unpacked into original edges. The arrays can be saved and memory-mapped.
+ * The hierarchy must be rebuilt when the graph changes.
+ */
+class ContractionHierarchy {
+ public:
+  static constexpr int kWitnessSettleLimit = 500;  ///< Per witness search.
+  static constexpr int kEstimateSettleLimit = 10;  ///< Same, for priorities.
+  /// Average out-degree at which contraction stops and leaves a core.
+  static constexpr std::size_t kCoreDegree = 16;
+
+  /**
+   * @brief Sparse arcs by rank: arcs of v are [offsets[v], offsets[v + 1]).
+   */
+  struct Arcs {
+    std::span<const std::uint64_t> offsets;  ///< Start of every vertex.
+    std::span<const int> heads;     ///< Other end of every arc, by rank.
+    std::span<const int> middles;   ///< Bypassed vertex, -1 for edges.
+    std::span<const Distance> weights;  ///< Length of every arc.
+
+    /**
+     * @brief Gets the middle of the arc from v to head, -1 if none.
+     */
+    int Middle(int v, int head) const {
+      for (std::uint64_t a = offsets[v]; a < offsets[v + 1]; ++a) {
+        if (heads[a] == head) return middles[a];
+      }
+      return -1;
+    }
+  };
+
+  /**
+   * @brief Creates an empty hierarchy.
+   */
+  ContractionHierarchy() = default;
+
+  /**
+   * @brief Contracts the graph, using up to s21::WorkerCount() threads.
+   */
+  static ContractionHierarchy Build(const s21_graph& graph);
+
+  /**
+   * @brief Maps a hierarchy saved by Save.
+   *
+   * The arcs are read from the mapping as needed, not copied; the checksum
+   * is verified once, and the arrays are checked in the same pass.
+   * @throw std::logic_error if the file cannot be mapped, is not a
+   * contraction hierarchy file, has a different version or byte order,
+   * fails the checksum, or has ranks or arcs that do not form a hierarchy.
+   */
+  static ContractionHierarchy Load(const std::string& filename);
+
+  /**
+   * @brief Saves the hierarchy in the contraction hierarchy file format.
+   *
+   * The file is written next to the target and renamed over it, so
+   * hierarchies mapping the old file, this one included, stay valid.
+   * @throw std::runtime_error if the file cannot be written.
+   */
+  void Save(const std::string& filename) const;
+
+  /**
+   * @brief Checks whether the arrays are borrowed from a mapped file.
+   */
+  bool IsMemoryMapped() const { return owner_ != nullptr; }
+
+  /**
+   * @brief Gets the number of vertices.
+   */
+  int Size() const { return static_cast<int>(order_.size()); }
+
+  /**
+   * @brief Gets the rank of a vertex (original id); 0 was contracted first.
+   */
+  int Rank(int vertex) const { return rank_[vertex]; }
+
+  /**
+   * @brief Gets the vertex (original id) of a rank.
+   */
+  int VertexAt(int rank) const { return order_[rank]; }
+
+  /**
+   * @brief Gets the arcs to higher ranks.
+   */
+  const Arcs& Up() const { return up_; }
+
+  /**
+   * @brief Gets the arcs from higher ranks, stored at their lower end.
+   */
+  const Arcs& Down() const { return down_; }
+
+  /**
+   * @brief Gets the number of arcs that are shortcuts.
+   */
+  std::size_t ShortcutCount() const;
+
+  /**
+   * @brief Gets the memory taken by the arrays in bytes.
+   */
+  std::size_t MemoryBytes() const;
+
+  /**
+   * @brief Checks whether the hierarchy was built for a graph with the same
+   * vertices and edges, by size, edge count and fingerprint (see
+   * s21_graph::GetFingerprint). Any change to the edges since the build
+   * makes it fail.
+   */
+  bool Matches(const s21_graph& graph) const;
+
+ private:
+  /**
+   * @brief Owned arrays of a hierarchy.
+   */
+  struct Arrays {
+    std::vector<int> order;  ///< Vertices by rank.
+    std::vector<int> rank;   ///< Ranks by vertex.
+    /**
+     * @brief Owned arcs.
+     */
+    struct OwnedArcs {
+      std::vector<std::uint64_t> offsets;  ///< Start of every vertex.
+      std::vector<int> heads;              ///< Other end of every arc.
+      std::vector<int> middles;            ///< Bypassed vertex or -1.
+      std::vector<Distance> weights;       ///< Length of every arc.
+    } up, down;  ///< Upward and downward arcs.
+  };
+
+  std::span<const int> order_;  ///< Vertices (original ids) by rank.
+  std::span<const int> rank_;   ///< Ranks by vertex (original id).
+  Arcs up_;                     ///< Arcs to higher ranks.
+  Arcs down_;                   ///< Arcs from higher ranks.
+  std::size_t edge_count_ = 0;  ///< Stored edges of the graph.
+  std::uint64_t fingerprint_ = 0;  ///< Fingerprint of the graph.
+  std::shared_ptr<const Arrays> arrays_;  ///< Owned arrays, if any.
+  std::shared_ptr<const void> owner_;     ///< Keeps a mapped file alive.
+
+  /**
+   * @brief Points the spans at owned arrays.
+   */
+  void Adopt(std::shared_ptr<const Arrays> arrays);
+};
+
+/**
+ * @brief Point-to-point queries on a contraction hierarchy.
+ *
+ * A forward search from the start climbs the upward arcs and a backward
+ * search from the target climbs the downward ones, the smaller key first.
+ * A search stops once its smallest key reaches the best path found where
+ * they meet; it cannot stop earlier, as upward distances are not shortest
+ * distances. Vertices reached more cheaply from above are stalled and not
+ * expanded (stall-on-demand). The path is unpacked shortcut by shortcut.
+ */
+class ContractionQuery {
+ public:
+  /**
+   * @brief Creates an engine; the hierarchy must outlive it.
+   */
+  explicit ContractionQuery(const ContractionHierarchy& hierarchy);
+
+  /**
+   * @brief Finds the shortest path from start to finish (original ids).
+   * @return Its length, kUnreached if finish cannot be reached.
+   */
+  Distance Run(int start, int finish);
+
+  /**
+   * @brief Gets the path the last query found, unpacked into edges.
+   * @return The vertices (original ids) from the start to the target,
+   * empty if the target was not reached.
+   */
+  std::vector<int> Path() const;
+
+  /**
+   * @brief Gets the number of vertices both searches of the last query
+   * settled.
+   */
+  std::size_t SettledCount() const { return settled_; }
+
+ private:
+  const ContractionHierarchy& hierarchy_;  ///< The searched hierarchy.
+  SearchSpace forward_;         ///< Labels from the start, by rank.
+  SearchSpace backward_;        ///< Labels from the target, by rank.
+  Distance best_ = kUnreached;  ///< Shortest path found so far.
+  int meeting_ = -1;  ///< Rank where the searches meet on it, -1 if none.
+  std::size_t settled_ = 0;  ///< Vertices settled by the last query.
+
+  /**
+   * @brief Settles the nearest vertex of one search and, unless it is
+   * stalled, relaxes its arcs.
+   * @param arcs The arcs the search climbs.
+   * @param stall The arcs that reach the search's vertices from above.
+   */
+  void Settle(const ContractionHierarchy::Arcs& arcs,
+              const ContractionHierarchy::Arcs& stall, SearchSpace& side,
+              const SearchSpace& other);
+
+  /**
+   * @brief Appends the original edges of arc from -> to (ranks) to path,
+   * as the vertices (original ids) after from.
+   */
+  void Unpack(int from, int to, int middle, std::vector<int>& path) const;
+};
+
+}  // namespace s21_sp
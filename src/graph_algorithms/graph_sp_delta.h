@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../graph/graph_metadata.h"
+#include "../utils/parallel.h"
+#include "graph_sp_dijkstra.h"
+
+namespace s21_sp {
+
+/**
+ * @brief Picks the bucket width of delta-stepping from the edge weights.
+ *
+ * Edges lighter than delta are relaxed within a bucket, the others once
+ * the bucket is done. Wide buckets hold more vertices to relax in parallel
+ * but relax them more often; the usual compromise is the heaviest weight
+ * over the average degree, so about one edge per vertex is light.
+ * @return A width between the lightest and the heaviest weight, at least 1.
+ */
+inline Distance ChooseDelta(const s21::GraphMetadata& metadata) {
+  if (metadata.vertex_count == 0 || metadata.edge_count == 0) return 1;
+  double degree =
+      static_cast<double>(metadata.edge_count) / metadata.vertex_count;
+  auto delta =
+      static_cast<Distance>(metadata.max_weight / std::max(degree, 1.0));
+  return std::clamp<Distance>(delta, std::max(metadata.min_weight, 1),
+                              std::max(metadata.max_weight, 1));
+}
+
+/**
+ * @brief Delta-stepping: single-source shortest paths relaxed in parallel.
+ *
+ * Vertices are kept in buckets of distances [i * delta, (i + 1) * delta).
+ * A relaxation lands at most ceil(C / delta) buckets past the current one
+ * for a heaviest weight C, so, as in BucketQueue, a ring of that many
+ * buckets plus one holds them all, indexed by bucket modulo the ring size.
+ * The lowest bucket is emptied in phases: all its vertices relax their
+ * light edges (lighter than delta) at once, which may refill it. Once it
+ * stays empty, the vertices it held relax their heavy edges, which only
+ * reach later buckets. The run ends once a full sweep of the ring finds no
+ * vertex. Each phase splits its vertices into blocks relaxed
+ * on up to s21::WorkerCount() threads; distances are lowered with an
+ * atomic compare-and-swap, and every block lists the vertices it improved.
+ * With delta = 1 this is Dijkstra's algorithm by buckets, with a delta
+ * above every weight it is Bellman-Ford.
+ *
+ * The threads are started once per run and meet at a barrier after every
+ * phase; the bookkeeping between phases runs on one of them, which also
+ * relaxes phases of a single block on its own, so short phases cost
+ * neither a thread start nor a barrier.
+ * @tparam Graph A sparse view (see VisitSparseView); its ForEachNeighbor
+ * is called from several threads.
+ */
+template <typename Graph>
+class DeltaStepping {
+ public:
+  /**
+   * @brief Creates an engine for graph; the graph must outlive it.
+   * @param delta The bucket width, at least 1 (see ChooseDelta).
+   * @param max_weight The heaviest edge weight C, at least 1.
+   */
+  DeltaStepping(const Graph& graph, Distance delta, Distance max_weight)
+      : graph_(graph),
+        delta_(std::max<Distance>(delta, 1)),
+        distance_(graph.Size()),
+        previous_(graph.Size()),
+        taken_(graph.Size()),
+        buckets_(static_cast<std::size_t>(
+                     (std::max<Distance>(max_weight, 1) + delta_ - 1) /
+                     delta_) +
+                 1) {}
+
+  /**
+   * @brief Finds the distances from start to every vertex.
+   */
+  void Run(int start) {
+    const int size = graph_.Size();
+    for (int v = 0; v < size; ++v) {
+      distance_[v].store(kUnreached, std::memory_order_relaxed);
+      previous_[v].store(-1, std::memory_order_relaxed);
+    }
+    std::fill(taken_.begin(), taken_.end(), 0);
+    phases_ = 0;
+    for (std::vector<int>& bucket : buckets_) bucket.clear();
+    buckets_[0].push_back(start);
+    distance_[start].store(0, std::memory_order_relaxed);
+    bucket_ = 0;
+    idle_ = 0;
+    first_phase_ = 1;
+    heavy_done_ = false;
+    emptied_.clear();
+
+    // no phase has more vertices than the graph, so small graphs run on the
+    // calling thread alone
+    const std::size_t workers =
+        std::min<std::size_t>(s21::WorkerCount(), Blocks(size));
+    std::exception_ptr error;
+    bool more = NextPhase();
+    next_block_ = 0;
+    std::barrier sync(static_cast<std::ptrdiff_t>(workers), [&]() noexcept {
+      try {
+        more = error == nullptr && NextPhase();
+      } catch (...) {
+        error = std::current_exception();
+        more = false;
+      }
+      next_block_ = 0;
+    });
+    std::mutex error_mutex;
+    auto worker = [&]() {
+      while (more) {
+        // a worker that fails still meets the others at the barrier
+        try {
+          const std::size_t blocks = Blocks(active_.size());
+          for (std::size_t block = next_block_++; block < blocks;
+               block = next_block_++) {
+            RelaxBlock(block);
+          }
+        } catch (...) {
+          std::lock_guard lock(error_mutex);
+          if (error == nullptr) error = std::current_exception();
+        }
+        sync.arrive_and_wait();
+      }
+      for (std::size_t block = next_block_++; block < Blocks(size);
+           block = next_block_++) {
+        SetPrevious(start, block);
+      }
+    };
+    // every participant of the barrier needs its own thread, so the threads
+    // are started here rather than taken from a work queue; the calling
+    // thread is one of them, and a thread that fails to start is dropped
+    // from the barrier so the others do not wait for it
+    std::vector<std::jthread> pool;
+    pool.reserve(workers - 1);
+    for (std::size_t t = 1; t < workers; ++t) {
+      try {
+        pool.emplace_back(worker);
+      } catch (...) {
+        for (; t < workers; ++t) sync.arrive_and_drop();
+      }
+    }
+    worker();
+    pool.clear();
+    if (error) std::rethrow_exception(error);
+  }
+
+  /**
+   * @brief Gets the distance the last run found to v, kUnreached if v
+   * cannot be reached.
+   */
+  Distance DistanceTo(int v) const {
+    return distance_[v].load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Gets the vertex before v on a shortest path from the start, -1
+   * for the start and unreachable vertices.
+   */
+  int Previous(int v) const {
+    return previous_[v].load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Gets the number of light phases the last run took.
+   */
+  std::size_t PhaseCount() const { return phases_; }
+
+ private:
+  static constexpr std::size_t kBlock = 512;  ///< Vertices per task.
+
+  const Graph& graph_;  ///< The searched graph.
+  Distance delta_;      ///< Bucket width.
+  std::vector<std::atomic<Distance>> distance_;  ///< Tentative distances.
+  std::vector<std::atomic<int>> previous_;  ///< Predecessors, set at the end.
+  std::vector<std::size_t> taken_;  ///< Last phase relaxing each vertex.
+  std::vector<std::vector<int>> buckets_;  ///< Ring of vertices by bucket.
+  std::vector<std::vector<int>> improved_;  ///< Improved vertices per block.
+  std::vector<int> active_;   ///< Vertices the current phase relaxes.
+  std::vector<int> emptied_;  ///< Every vertex taken from the bucket, once.
+  std::size_t bucket_ = 0;       ///< The bucket being emptied.
+  std::size_t idle_ = 0;         ///< Buckets in a row that held no vertex.
+  std::size_t first_phase_ = 0;  ///< First light phase of that bucket.
+  bool light_ = true;            ///< Whether the phase relaxes light edges.
+  bool heavy_done_ = false;      ///< Whether the bucket's heavy pass ran.
+  std::atomic<std::size_t> next_block_{0};  ///< Next block to hand out.
+  std::size_t phases_ = 0;  ///< Light phases of the last run.
+
+  std::size_t BucketOf(int v) const {
+    return static_cast<std::size_t>(DistanceTo(v) / delta_);
+  }
+
+  static std::size_t Blocks(std::size_t count) {
+    return (count + kBlock - 1) / kBlock;
+  }
+
+  /**
+   * @brief Queues the improved vertices and picks the vertices of the next
+   * phase that needs more than one block, relaxing smaller phases on the
+   * spot. Runs on one thread between phases.
+   * @return False once every bucket is done.
+   */
+  bool NextPhase() {
+    for (;;) {
+      QueueImproved();
+      std::vector<int>& bucket = buckets_[bucket_ % buckets_.size()];
+      if (!bucket.empty()) {
+        ++phases_;
+        // skip entries whose vertex has moved on to a lower bucket, and
+        // repeats of one vertex
+        active_.clear();
+        for (int v : bucket) {
+          if (BucketOf(v) != bucket_ || taken_[v] == phases_) continue;
+          if (taken_[v] < first_phase_) emptied_.push_back(v);
+          taken_[v] = phases_;
+          active_.push_back(v);
+        }
+        bucket.clear();
+        light_ = true;
+      } else if (!heavy_done_) {
+        idle_ = emptied_.empty() ? idle_ + 1 : 0;
+        active_.swap(emptied_);
+        emptied_.clear();
+        light_ = false;
+        heavy_done_ = true;
+      } else {
+        // empty buckets need no phase, and every queued vertex lies within
+        // one ring of the last bucket that held a vertex
+        ++bucket_;
+        while (idle_ < buckets_.size() &&
+               buckets_[bucket_ % buckets_.size()].empty()) {
+          ++bucket_;
+          ++idle_;
+        }
+        if (idle_ == buckets_.size()) return false;
+        first_phase_ = phases_ + 1;
+        heavy_done_ = false;
+        continue;
+      }
+      const std::size_t blocks = Blocks(active_.size());
+      if (improved_.size() < std::max<std::size_t>(blocks, 1)) {
+        improved_.resize(std::max<std::size_t>(blocks, 1));
+      }
+      if (blocks > 1) return true;
+      if (blocks == 1) RelaxBlock(0);
+    }
+  }
+
+  /**
+   * @brief Relaxes the light or the heavy edges of one block of the
+   * current phase and lists the vertices that got closer.
+   */
+  void RelaxBlock(std::size_t block) {
+    std::vector<int>& improved = improved_[block];
+    const std::size_t begin = block * kBlock;
+    const std::size_t end = std::min(begin + kBlock, active_.size());
+    for (std::size_t k = begin; k < end; ++k) {
+      const int v = active_[k];
+      const Distance distance = DistanceTo(v);
+      graph_.ForEachNeighbor(v, [&](int u, auto weight) {
+        const auto length = static_cast<Distance>(weight);
+        if ((length < delta_) != light_) return;
+        const Distance candidate = distance + length;
+        Distance current = distance_[u].load(std::memory_order_relaxed);
+        while (candidate < current) {
+          if (distance_[u].compare_exchange_weak(current, candidate,
+                                                 std::memory_order_relaxed)) {
+            improved.push_back(u);
+            break;
+          }
+        }
+      });
+    }
+  }
+
+  /**
+   * @brief Queues the vertices the last phase improved in their new
+   * buckets.
+   */
+  void QueueImproved() {
+    // a vertex lowered by several blocks is queued once per block; the
+    // copies in other buckets are stale and skipped
+    for (std::vector<int>& improved : improved_) {
+      for (int u : improved) {
+        buckets_[BucketOf(u) % buckets_.size()].push_back(u);
+      }
+      improved.clear();
+    }
+  }
+
+  /**
+   * @brief Picks a predecessor for every reached vertex of one block: any u
+   * with an edge (u, v) and distance(u) + w(u, v) = distance(v). Weights
+   * are positive, so these links form a tree.
+   */
+  void SetPrevious(int start, std::size_t block) {
+    const std::size_t begin = block * kBlock;
+    const std::size_t end = std::min(begin + kBlock, distance_.size());
+    for (std::size_t k = begin; k < end; ++k) {
+      const int u = static_cast<int>(k);
+      const Distance distance = DistanceTo(u);
+      if (distance == kUnreached) continue;
+      graph_.ForEachNeighbor(u, [&](int v, auto weight) {
+        if (v == start ||
+            distance + static_cast<Distance>(weight) != DistanceTo(v)) {
+          return;
+        }
+        int none = -1;
+        previous_[v].compare_exchange_strong(none, u,
+                                             std::memory_order_relaxed);
+      });
+    }
+  }
+};
+
+}  // namespace s21_sp
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../graph/graph.h"
+
+/**
+ * @brief Namespace for the shortest path engines.
+ *
+ * The engines work on storage ids (see s21_graph::StorageId) and read the
+ * adjacency through a sparse view of the concrete storage (see
+ * VisitSparseView), so they are instantiated once per layout and weight
+ * type.
+ */
+namespace s21_sp {
+
+/**
+ * @brief Type path lengths are added up in.
+ */
+using Distance = std::int64_t;
+
+/**
+ * @brief Distance of vertices that have not been reached.
+ */
+inline constexpr Distance kUnreached = std::numeric_limits<Distance>::max();
+
+/**
+ * @brief Converts an accumulated distance to the int the interface uses.
+ * @throw std::overflow_error if the distance does not fit an int.
+ */
+inline int NarrowDistance(Distance distance) {
+  if (distance > std::numeric_limits<int>::max()) {
+    throw std::overflow_error("The distance does not fit an int!");
+  }
+  return static_cast<int>(distance);
+}
+
+/**
+ * @brief Neighbour iteration over the rows of an adjacency matrix.
+ *
+ * Gives matrices the ForEachNeighbor interface the sparse layouts have, so
+ * the engines are written once. A row still costs a scan of Size() cells.
+ */
+template <typename T>
+class DenseNeighbors {
+ public:
+  /**
+   * @brief Creates a view of matrix; the matrix must outlive the view.
+   */
+  explicit DenseNeighbors(const s21::DenseMatrix<T>& matrix)
+      : matrix_(matrix) {}
+
+  /**
+   * @brief Gets the number of vertices.
+   */
+  int Size() const { return matrix_.Size(); }
+
+  /**
+   * @brief Calls visit(neighbor, weight) for every edge leaving vertex v in
+   * ascending neighbour order.
+   */
+  template <typename Visitor>
+  void ForEachNeighbor(int v, Visitor&& visit) const {
+    const T* row = matrix_.Row(v);
+    const int size = matrix_.Size();
+    for (int u = 0; u < size; ++u) {
+      if (row[u] > 0) visit(u, row[u]);
+    }
+  }
+
+ private:
+  const s21::DenseMatrix<T>& matrix_;  ///< The viewed matrix.
+};
+
+/**
+ * @brief Calls visit with a sparse view of the storage of graph.
+ *
+ * Sparse, compressed and bit-packed storage is passed as is; matrices are
+ * wrapped in DenseNeighbors. Every view has Size() and
+ * ForEachNeighbor(v, visit(neighbor, weight)) over storage ids.
+ * @return What visit returns.
+ */
+template <typename Visitor>
+decltype(auto) VisitSparseView(const s21_graph& graph, Visitor&& visit) {
+  return graph.VisitStorage([&](const auto& storage) -> decltype(auto) {
+    using Storage = std::decay_t<decltype(storage)>;
+    if constexpr (s21::kIsDenseMatrix<Storage>) {
+      return visit(DenseNeighbors<typename Storage::ValueType>(storage));
+    } else {
+      return visit(storage);
+    }
+  });
+}
+
+/**
+ * @brief 4-ary min-heap of vertices keyed by distance, with decrease-key.
+ *
+ * Every vertex is in the heap at most once. Its position is tracked, so a
+ * shorter distance moves the entry up in place instead of pushing a
+ * duplicate, and the heap never holds more than Size() entries. Four
+ * children per node make the heap half as deep as a binary one, and the
+ * children share a cache line.
+ */
+class IndexedHeap {
+ public:
+  /**
+   * @brief Creates an empty heap for vertices 0..size-1.
+   */
+  explicit IndexedHeap(int size = 0) : position_(size, kAbsent) {}
+
+  /**
+   * @brief Checks whether the heap has no entries.
+   */
+  bool Empty() const { return heap_.empty(); }
+
+  /**
+   * @brief Checks whether vertex v is in the heap.
+   */
+  bool Contains(int v) const { return position_[v] != kAbsent; }
+
+  /**
+   * @brief Gets the smallest key. The heap must not be empty.
+   */
+  Distance TopKey() const { return heap_.front().key; }
+
+  /**
+   * @brief Inserts vertex v with key, or lowers its key if v is in the heap
+   * with a larger one.
+   */
+  void Push(int v, Distance key) {
+    int i = position_[v];
+    if (i == kAbsent) {
+      i = static_cast<int>(heap_.size());
+      heap_.emplace_back();
+    } else if (key >= heap_[i].key) {
+      return;
+    }
+    SiftUp(i, {key, v});
+  }
+
+  /**
+   * @brief Removes the vertex with the smallest key.
+   * @return The vertex and its key. The heap must not be empty.
+   */
+  std::pair<int, Distance> Pop() {
+    Entry top = heap_.front();
+    position_[top.vertex] = kAbsent;
+    Entry last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) SiftDown(0, last);
+    return {top.vertex, top.key};
+  }
+
+  /**
+   * @brief Removes all entries in O(entries).
+   */
+  void Clear() {
+    for (const Entry& entry : heap_) position_[entry.vertex] = kAbsent;
+    heap_.clear();
+  }
+
+ private:
+  /**
+   * @brief A vertex with its key.
+   */
+  struct Entry {
+    Distance key;  ///< Tentative distance of the vertex.
+    int vertex;    ///< The vertex.
+  };
+
+  static constexpr int kArity = 4;    ///< Children per node.
+  static constexpr int kAbsent = -1;  ///< Position of vertices not in heap_.
+
+  std::vector<Entry> heap_;    ///< The heap, smallest key first.
+  std::vector<int> position_;  ///< Index in heap_ by vertex, or kAbsent.
+
+  /**
+   * @brief Places entry at hole i or above it.
+   */
+  void SiftUp(int i, Entry entry) {
+    while (i > 0) {
+      int parent = (i - 1) / kArity;
+      if (heap_[parent].key <= entry.key) break;
+      Move(parent, i);
+      i = parent;
+    }
+    heap_[i] = entry;
+    position_[entry.vertex] = i;
+  }
+
+  /**
+   * @brief Places entry at hole i or below it.
+   */
+  void SiftDown(int i, Entry entry) {
+    const int size = static_cast<int>(heap_.size());
+    for (int first = kArity * i + 1; first < size; first = kArity * i + 1) {
+      int child = first;
+      const int last = std::min(first + kArity, size);
+      for (int c = first + 1; c < last; ++c) {
+        if (heap_[c].key < heap_[child].key) child = c;
+      }
+      if (heap_[child].key >= entry.key) break;
+      Move(child, i);
+      i = child;
+    }
+    heap_[i] = entry;
+    position_[entry.vertex] = i;
+  }
+
+  /**
+   * @brief Moves the entry at from to to.
+   */
+  void Move(int from, int to) {
+    heap_[to] = heap_[from];
+    position_[heap_[to].vertex] = to;
+  }
+};
+
+/**
+ * @brief Dial's queue: vertices in a ring of buckets, one per distance.
+ *
+ * For integer weights of at most C, the keys waiting in a Dijkstra search
+ * lie within C of the smallest one, so C + 1 buckets indexed by key modulo
+ * C + 1 hold them all. Pushing is O(1), and popping advances a cursor over
+ * the buckets, so a search costs O(E + largest distance) instead of a
+ * logarithmic factor per vertex. A lowered key leaves its old entry behind,
+ * which is skipped when the cursor reaches it. Keys must be pushed in
+ * Dijkstra's order: no smaller than the last popped key and at most C above
+ * it.
+ */
+class BucketQueue {
+ public:
+  /**
+   * @brief Creates an empty queue for vertices 0..size-1.
+   * @param max_weight The heaviest edge weight C, at least 1.
+   */
+  BucketQueue(int size, int max_weight)
+      : key_(size, kAbsent),
+        buckets_(std::max(max_weight, 1) + 1),
+        listed_(buckets_.size()) {}
+
+  /**
+   * @brief Checks whether the queue has no entries.
+   */
+  bool Empty() const { return size_ == 0; }
+
+  /**
+   * @brief Checks whether vertex v is in the queue.
+   */
+  bool Contains(int v) const { return key_[v] != kAbsent; }
+
+  /**
+   * @brief Gets the smallest key. The queue must not be empty.
+   */
+  Distance TopKey() const { return cursor_; }
+
+  /**
+   * @brief Inserts vertex v with key, or lowers its key if v is queued with
+   * a larger one.
+   */
+  void Push(int v, Distance key) {
+    if (key_[v] == kAbsent) {
+      if (size_++ == 0) cursor_ = key;
+    } else if (key >= key_[v]) {
+      return;
+    }
+    key_[v] = key;
+    const std::size_t bucket = key % buckets_.size();
+    if (!listed_[bucket]) {
+      listed_[bucket] = true;
+      used_.push_back(bucket);
+    }
+    buckets_[bucket].push_back(v);
+    cursor_ = std::min(cursor_, key);
+  }
+
+  /**
+   * @brief Removes a vertex with the smallest key.
+   * @return The vertex and its key. The queue must not be empty.
+   */
+  std::pair<int, Distance> Pop() {
+    std::vector<int>& bucket = buckets_[cursor_ % buckets_.size()];
+    const int v = bucket.back();
+    const Distance key = cursor_;
+    bucket.pop_back();
+    key_[v] = kAbsent;
+    if (--size_ > 0) Advance();
+    return {v, key};
+  }
+
+  /**
+   * @brief Removes all entries in O(entries), visiting only the buckets
+   * filled since the last Clear.
+   */
+  void Clear() {
+    for (std::size_t index : used_) {
+      std::vector<int>& bucket = buckets_[index];
+      for (int v : bucket) key_[v] = kAbsent;
+      bucket.clear();
+      listed_[index] = false;
+    }
+    used_.clear();
+    size_ = 0;
+  }
+
+ private:
+  static constexpr Distance kAbsent = -1;  ///< Key of vertices not queued.
+
+  std::vector<Distance> key_;  ///< Key by vertex, or kAbsent.
+  std::vector<std::vector<int>> buckets_;  ///< Vertices by key % size.
+  std::vector<std::size_t> used_;  ///< Buckets filled since the last Clear.
+  std::vector<bool> listed_;       ///< Whether a bucket is in used_.
+  std::size_t size_ = 0;  ///< Queued vertices, without stale entries.
+  Distance cursor_ = 0;   ///< The smallest key.
+
+  /**
+   * @brief Moves the cursor to the next entry that is not stale.
+   */
+  void Advance() {
+    for (;;) {
+      std::vector<int>& bucket = buckets_[cursor_ % buckets_.size()];
+      while (!bucket.empty() && key_[bucket.back()] != cursor_) {
+        bucket.pop_back();
+      }
+      if (!bucket.empty()) return;
+      ++cursor_;
+    }
+  }
+};
+
+/**
+ * @brief The labels of one search: tentative distances, predecessors and
+ * the heap of reached but unsettled vertices.
+ *
+ * Only the vertices a search touched are reset before the next one, which
+ * makes repeated searches cost what they explore rather than O(V).
+ * @tparam Queue The queue of unsettled vertices: IndexedHeap, or
+ * BucketQueue for searches in Dijkstra's order over small weights.
+ */
+template <typename Queue>
+class BasicSearchSpace {
+ public:
+  /**
+   * @brief Creates the labels for vertices 0..size-1, all unreached.
+   * @param queue_args Further arguments of the queue's constructor.
+   */
+  template <typename... QueueArgs>
+  explicit BasicSearchSpace(int size, QueueArgs... queue_args)
+      : distance_(size, kUnreached),
+        previous_(size, -1),
+        heap_(size, queue_args...) {}
+
+  /**
+   * @brief Forgets the last search and starts a new one at start.
+   */
+  void Start(int start) {
+    for (int v : touched_) {
+      distance_[v] = kUnreached;
+      previous_[v] = -1;
+    }
+    touched_.clear();
+    heap_.Clear();
+    Reach(start, 0, start);
+  }
+
+  /**
+   * @brief Records a shorter path to v through from and (re)queues v.
+   * @param distance The new distance; must be below DistanceTo(v).
+   * @param key The key v is queued with; the distance by default.
+   */
+  void Reach(int v, Distance distance, int from, Distance key) {
+    if (distance_[v] == kUnreached) touched_.push_back(v);
+    distance_[v] = distance;
+    previous_[v] = from;
+    heap_.Push(v, key);
+  }
+
+  /**
+   * @brief Records a shorter path to v through from and queues v by its
+   * distance.
+   */
+  void Reach(int v, Distance distance, int from) {
+    Reach(v, distance, from, distance);
+  }
+
+  /**
+   * @brief Gets the tentative distance to v, kUnreached if v was not
+   * reached.
+   */
+  Distance DistanceTo(int v) const { return distance_[v]; }
+
+  /**
+   * @brief Gets the vertex before v on its best path; the start is its own
+   * predecessor.
+   */
+  int Previous(int v) const { return previous_[v]; }
+
+  /**
+   * @brief Gets the reached but unsettled vertices.
+   */
+  Queue& Heap() { return heap_; }
+
+  /**
+   * @brief Gets the best path to v found so far.
+   * @return The vertices from the start to v, empty if v was not reached.
+   */
+  std::vector<int> PathTo(int v) const {
+    std::vector<int> path;
+    if (distance_[v] == kUnreached) return path;
+    for (; v != previous_[v]; v = previous_[v]) path.push_back(v);
+    path.push_back(v);
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+
+ private:
+  std::vector<Distance> distance_;  ///< Tentative distances.
+  std::vector<int> previous_;  ///< Predecessor on the best path, -1 if none.
+  std::vector<int> touched_;   ///< Vertices reached by the last search.
+  Queue heap_;                 ///< Reached but unsettled vertices.
+};
+
+/**
+ * @brief The labels of a search that queues vertices in an IndexedHeap.
+ */
+using SearchSpace = BasicSearchSpace<IndexedHeap>;
+
+/**
+ * @brief Dijkstra's algorithm with an indexed heap or a bucket queue.
+ *
+ * A search settles vertices in order of distance and stops as soon as the
+ * target is settled, so a query only explores the vertices closer than its
+ * target.
+ * @tparam Graph A sparse view (see VisitSparseView).
+ * @tparam Queue IndexedHeap, or BucketQueue (see VisitDijkstra).
+ */
+template <typename Graph, typename Queue = IndexedHeap>
+class Dijkstra {
+ public:
+  /**
+   * @brief Creates an engine for graph; the graph must outlive it.
+   * @param queue_args Further arguments of the queue's constructor: the
+   * heaviest weight for a BucketQueue.
+   */
+  template <typename... QueueArgs>
+  explicit Dijkstra(const Graph& graph, QueueArgs... queue_args)
+      : graph_(graph), space_(graph.Size(), queue_args...) {}
+
+  /**
+   * @brief Searches from start until finish is settled.
+   * @param finish The target, or -1 to settle every reachable vertex.
+   * @return The distance to finish; kUnreached if it cannot be reached or
+   * finish is -1.
+   */
+  Distance Run(int start, int finish = -1) {
+    return Search(start, [finish](int v) { return v == finish; });
+  }
+
+  /**
+   * @brief Searches from start until every target is settled.
+   * @param targets Flags by vertex, non-zero for targets.
+   * @param count The number of flagged vertices; at least 1.
+   */
+  void RunToAll(int start, const std::vector<char>& targets,
+                std::size_t count) {
+    Search(start, [&](int v) { return targets[v] && --count == 0; });
+  }
+
+  /**
+   * @brief Searches from start until every reachable vertex is settled,
+   * calling settle(v) for each one as it is settled, nearest first. The
+   * distance and predecessor of v are final by then.
+   */
+  template <typename Settle>
+  void RunSettling(int start, Settle&& settle) {
+    Search(start, [&](int v) {
+      settle(v);
+      return false;
+    });
+  }
+
+  /**
+   * @brief Gets the distance the last search found to v.
+   *
+   * Exact for settled vertices; after an early exit, vertices farther than
+   * the target may hold an upper bound or kUnreached.
+   */
+  Distance DistanceTo(int v) const { return space_.DistanceTo(v); }
+
+  /**
+   * @brief Gets the path the last search found to finish.
+   * @return The vertices from the start to finish, empty if finish was not
+   * reached.
+   */
+  std::vector<int> Path(int finish) const { return space_.PathTo(finish); }
+
+  /**
+   * @brief Gets the vertex before v on the path the last search found; the
+   * start is its own predecessor, -1 if v was not reached.
+   */
+  int Previous(int v) const { return space_.Previous(v); }
+
+  /**
+   * @brief Gets the number of vertices the last search settled.
+   */
+  std::size_t SettledCount() const { return settled_; }
+
+ private:
+  const Graph& graph_;              ///< The searched graph.
+  BasicSearchSpace<Queue> space_;  ///< Labels of the last search.
+  std::size_t settled_ = 0;  ///< Vertices settled by the last search.
+
+  /**
+   * @brief Settles vertices from start until stop(v) holds for a settled v.
+   * @return The distance to that vertex, kUnreached if there was none.
+   */
+  template <typename Stop>
+  Distance Search(int start, Stop&& stop) {
+    space_.Start(start);
+    settled_ = 0;
+    Queue& heap = space_.Heap();
+    while (!heap.Empty()) {
+      const auto [v, distance] = heap.Pop();
+      ++settled_;
+      if (stop(v)) return distance;
+      graph_.ForEachNeighbor(v, [&](int u, auto weight) {
+        Distance candidate = distance + static_cast<Distance>(weight);
+        if (candidate < space_.DistanceTo(u)) space_.Reach(u, candidate, v);
+      });
+    }
+    return kUnreached;
+  }
+};
+
+/**
+ * @brief Heaviest edge weight up to which VisitDijkstra picks a
+ * BucketQueue. Past it, allocating the ring and walking its empty buckets
+ * costs short queries more than the heap does (see the `dial` benchmark).
+ */
+inline constexpr int kBucketQueueMaxWeight = 1 << 16;
+
+/**
+ * @brief Calls visit with a Dijkstra engine for graph: one with a
+ * BucketQueue if every weight is at most kBucketQueueMaxWeight, one with
+ * an IndexedHeap otherwise.
+ * @param max_weight The heaviest edge weight (see GraphMetadata).
+ * @return What visit returns.
+ */
+template <typename Graph, typename Visitor>
+decltype(auto) VisitDijkstra(const Graph& graph, int max_weight,
+                             Visitor&& visit) {
+  if (max_weight <= kBucketQueueMaxWeight) {
+    Dijkstra<Graph, BucketQueue> engine(graph, max_weight);
+    return visit(engine);
+  }
+  Dijkstra<Graph> engine(graph);
+  return visit(engine);
+}
+
+}  // namespace s21_sp
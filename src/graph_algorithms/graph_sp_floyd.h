@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "../graph/graph_matrix.h"
+#include "../utils/parallel.h"
+
+namespace s21_sp {
+
+/**
+ * @brief The distance of unreachable pairs in a FloydWarshall matrix.
+ *
+ * Half the largest D, so the sum of two cells never overflows and the
+ * kernel needs no test for it: any sum with an unreachable term stays at or
+ * above kFloydInfinity<D>, while every real distance must stay below it.
+ */
+template <typename D>
+inline constexpr D kFloydInfinity = std::numeric_limits<D>::max() / 2;
+
+/**
+ * @brief Rows and columns per tile of FloydWarshall. Three tiles of int
+ * distances take 48 KiB, which stays in L2 (see the `apsp` benchmark).
+ */
+inline constexpr int kFloydTile = 64;
+static_assert(kFloydTile * sizeof(std::int64_t) % s21::kCacheLineSize == 0,
+              "tiles must be whole cache lines wide");
+
+/**
+ * @brief The min-plus kernel: row[j] = min(row[j], via + through[j]).
+ *
+ * Branch-free and cut into whole cache lines: each line is computed into a
+ * local array of fixed length, which compilers turn into vector min and add
+ * instructions even at -O2 and wherever the kernel is inlined. The rows
+ * must not overlap.
+ * @param count The number of cells, a multiple of a cache line.
+ */
+template <typename D>
+inline void RelaxRow(D* __restrict row, D via, const D* __restrict through,
+                     std::size_t count) {
+  constexpr std::size_t kLine = s21::kCacheLineSize / sizeof(D);
+  for (std::size_t line = 0; line < count; line += kLine) {
+    D best[kLine];
+    for (std::size_t j = 0; j < kLine; ++j) {
+      best[j] = std::min<D>(row[line + j], via + through[line + j]);
+    }
+    std::copy(best, best + kLine, row + line);
+  }
+}
+
+/**
+ * @brief Blocked Floyd-Warshall on a distance matrix, in place.
+ *
+ * The matrix is cut into kFloydTile x kFloydTile tiles. For every diagonal
+ * tile kb, which holds the k of one round:
+ * 1. the diagonal tile is closed over its own vertices;
+ * 2. the tiles of row kb and of column kb are relaxed through it;
+ * 3. every other tile (i, j) is relaxed through tiles (i, kb) and (kb, j).
+ * Tiles of one step only read tiles that step does not write, so steps 2
+ * and 3 run on up to s21::WorkerCount() threads, and each tile is reused
+ * from cache for all the k of the round instead of streaming the whole
+ * matrix once per k.
+ *
+ * Columns run up to the padded stride: the padding holds zeros, which
+ * relaxing leaves at zero, and the kernel never needs a scalar tail.
+ * @param distances Edge weights on input, 0 on the diagonal and
+ * kFloydInfinity<D> for missing edges; shortest distances on output.
+ * Distances must stay below kFloydInfinity<D>.
+ */
+template <typename D>
+void FloydWarshall(s21::DenseMatrix<D>& distances) {
+  const int size = distances.Size();
+  if (size == 0) return;
+  const std::size_t stride = distances.Stride();
+  D* const cells = distances.Data();
+  const int tiles = (size + kFloydTile - 1) / kFloydTile;
+  auto row = [cells, stride](int i) { return cells + i * stride; };
+  auto first = [](int tile) { return tile * kFloydTile; };
+  auto last = [size](int tile) {
+    return std::min(size, (tile + 1) * kFloydTile);
+  };
+  auto columns = [stride](int tile) {
+    std::size_t begin = static_cast<std::size_t>(tile) * kFloydTile;
+    return std::min<std::size_t>(kFloydTile, stride - begin);
+  };
+
+  // tile (ib, jb) through tile kb; rows i == k are skipped, they cannot
+  // improve (their distance to k is 0) and would alias row k
+  auto relax = [&](int ib, int jb, int kb) {
+    const std::size_t count = columns(jb);
+    for (int k = first(kb); k < last(kb); ++k) {
+      const D* through = row(k) + first(jb);
+      for (int i = first(ib); i < last(ib); ++i) {
+        const D via = row(i)[k];
+        if (i != k && via < kFloydInfinity<D>) {
+          RelaxRow(row(i) + first(jb), via, through, count);
+        }
+      }
+    }
+  };
+
+  for (int kb = 0; kb < tiles; ++kb) {
+    relax(kb, kb, kb);
+    const int others = tiles - 1;
+    s21::ParallelFor(2 * others, [&](std::size_t task) {
+      int tile = static_cast<int>(task) % others;
+      tile += tile >= kb;
+      if (static_cast<int>(task) < others) {
+        relax(kb, tile, kb);
+      } else {
+        relax(tile, kb, kb);
+      }
+    });
+    s21::ParallelFor(
+        static_cast<std::size_t>(others) * others, [&](std::size_t task) {
+          int ib = static_cast<int>(task / others);
+          int jb = static_cast<int>(task % others);
+          relax(ib + (ib >= kb), jb + (jb >= kb), kb);
+        });
+  }
+}
+
+}  // namespace s21_sp
@@ -0,0 +1,154 @@
+#include "graph_sp_landmarks.h"
+
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace s21_sp {
+
+namespace {
+
+const std::string kFormat = "landmark";
+
+/**
+ * @brief Stores a distance in a table cell: kNoDistance if there is no path,
+ * at most kMaxDistance otherwise.
+ */
+std::uint32_t Narrow(Distance distance) {
+  if (distance == kUnreached) return LandmarkIndex::kNoDistance;
+  return static_cast<std::uint32_t>(
+      std::min<Distance>(distance, LandmarkIndex::kMaxDistance));
+}
+
+}  // namespace
+
+LandmarkIndex LandmarkIndex::Build(const s21_graph& graph, int count) {
+  if (count < 1) {
+    throw std::invalid_argument("At least one landmark is needed!");
+  }
+  const int size = graph.Size();
+  count = std::min(count, size);
+  const bool symmetric = graph.GetMetadata().IsSymmetric();
+
+  LandmarkIndex index;
+  index.SetShape(size, count, symmetric);
+  index.edge_count_ = graph.GetMetadata().edge_count;
+  index.fingerprint_ = graph.GetFingerprint();
+  Arrays arrays;
+  arrays.table.assign(size * index.stride_, kNoDistance);
+
+  // distance from the nearest landmark so far, by storage id
+  std::vector<Distance> nearest(size, kUnreached);
+  auto farthest = [&nearest]() {
+    return static_cast<int>(std::max_element(nearest.begin(), nearest.end()) -
+                            nearest.begin());
+  };
+  // fills column k of the table with the distances found by engine
+  auto fill = [&](const auto& engine, std::size_t column, bool update) {
+    for (int v = 0; v < size; ++v) {
+      Distance distance = engine.DistanceTo(v);
+      arrays.table[graph.OriginalId(v) * index.stride_ + column] =
+          Narrow(distance);
+      if (update) nearest[v] = std::min(nearest[v], distance);
+    }
+  };
+
+  std::shared_ptr<const SparseGraphData> reverse;
+  if (!symmetric) reverse = graph.GetReverse();
+  VisitSparseView(graph, [&](const auto& view) {
+    Dijkstra forward(view);
+    // the first landmark is the vertex farthest from vertex 0
+    if (size > 0) forward.Run(0);
+    for (int v = 0; v < size; ++v) {
+      Distance distance = forward.DistanceTo(v);
+      nearest[v] = distance == kUnreached ? -1 : distance;
+    }
+    int landmark = farthest();
+    std::fill(nearest.begin(), nearest.end(), kUnreached);
+
+    for (int k = 0; k < count; ++k) {
+      forward.Run(landmark);
+      fill(forward, k, true);
+      if (reverse != nullptr) {
+        Dijkstra backward(*reverse);
+        backward.Run(landmark);
+        fill(backward, index.to_ + k, false);
+      }
+      arrays.landmarks.push_back(graph.OriginalId(landmark));
+      landmark = farthest();
+    }
+  });
+
+  auto owned = std::make_shared<const Arrays>(std::move(arrays));
+  index.landmarks_ = owned->landmarks;
+  index.table_ = owned->table;
+  index.arrays_ = std::move(owned);
+  return index;
+}
+
+LandmarkIndex LandmarkIndex::Load(const std::string& filename) {
+  auto file = std::make_shared<const s21::MappedFile>(filename);
+
+  auto header = s21::ReadBinaryHeader<LandmarkFileHeader>(*file, kFormat);
+  std::size_t count = header.landmark_count;
+  // ids are ints, and every landmark is a different vertex
+  if (header.vertex_count >=
+      static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+    s21::InvalidBinaryFile(kFormat, "too many vertices");
+  }
+  if (count > header.vertex_count) {
+    s21::InvalidBinaryFile(kFormat, "more landmarks than vertices");
+  }
+  if (header.stride != (header.symmetric ? count : 2 * count)) {
+    s21::InvalidBinaryFile(kFormat, "inconsistent table shape");
+  }
+
+  s21::BinarySectionReader reader(file->Data() + sizeof(header),
+                                  header.payload_bytes, kFormat);
+  LandmarkIndex index;
+  index.SetShape(header.vertex_count, static_cast<int>(count),
+                 header.symmetric != 0);
+  index.edge_count_ = header.edge_count;
+  index.fingerprint_ = header.fingerprint;
+  index.landmarks_ = reader.Next<int>(count, [&](int landmark) {
+    if (landmark < 0 ||
+        static_cast<std::uint64_t>(landmark) >= header.vertex_count) {
+      reader.Fail("landmark out of range");
+    }
+  });
+  index.table_ = reader.Next<std::uint32_t>(
+      reader.Multiply(header.vertex_count, header.stride));
+  reader.Finish(header);
+  index.owner_ = std::move(file);
+  return index;
+}
+
+void LandmarkIndex::Save(const std::string& filename) const {
+  // the table may still be borrowed from a mapping of this file
+  s21::ReplacingFile output(filename);
+  std::ofstream& file = output.Stream();
+
+  LandmarkFileHeader header;
+  header.landmark_count = static_cast<std::uint32_t>(landmarks_.size());
+  header.symmetric = symmetric_;
+  header.vertex_count = vertex_count_;
+  header.edge_count = edge_count_;
+  header.fingerprint = fingerprint_;
+  header.stride = stride_;
+  // the header is rewritten once the checksum is known
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  s21::BinarySectionWriter writer(file);
+  writer.Write(landmarks_);
+  writer.Write(table_);
+  writer.Finish(header, filename);
+  output.Commit();
+}
+
+bool LandmarkIndex::Matches(const s21_graph& graph) const {
+  return static_cast<std::size_t>(graph.Size()) == vertex_count_ &&
+         graph.GetMetadata().edge_count == edge_count_ &&
+         graph.GetFingerprint() == fingerprint_;
+}
+
+}  // namespace s21_sp
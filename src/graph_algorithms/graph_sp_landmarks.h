@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../graph/graph.h"
+#include "graph_sp_dijkstra.h"
+
+namespace s21_sp {
+
+/**
+ * @brief Current version of the landmark file format.
+ */
+inline constexpr std::uint32_t kLandmarkFormatVersion = 3;
+
+/**
+ * @brief Fixed-size header at the start of a landmark file.
+ *
+ * The header is followed by two sections, each zero-padded to
+ * s21::kBinaryAlignment bytes: the landmark_count landmarks (int32 original
+ * ids), then the table, vertex_count rows of stride uint32 distances (see
+ * LandmarkIndex).
+ */
+struct LandmarkFileHeader {
+  char magic[4] = {'S', '2', '1', 'L'};  ///< File signature.
+  std::uint32_t version = kLandmarkFormatVersion;      ///< Format version.
+  std::uint32_t byte_order = s21::kBinaryByteOrderMark;  ///< Byte order mark.
+  std::uint32_t landmark_count = 0;  ///< Number of landmarks.
+  std::uint32_t symmetric = 0;       ///< 1 if only distances from are kept.
+  std::uint32_t reserved = 0;        ///< Zero.
+  std::uint64_t vertex_count = 0;    ///< Vertices of the indexed graph.
+  std::uint64_t edge_count = 0;      ///< Stored edges of the indexed graph.
+  std::uint64_t stride = 0;          ///< Distances per vertex.
+  std::uint64_t payload_bytes = 0;   ///< Bytes following the header.
+  std::uint64_t checksum = 0;        ///< See s21::BinaryFileChecksum.
+  std::uint64_t fingerprint = 0;     ///< s21_graph::GetFingerprint().
+  std::uint64_t padding[7] = {};     ///< Zero.
+};
+
+static_assert(sizeof(LandmarkFileHeader) % s21::kBinaryAlignment == 0,
+              "the payload must start on an aligned offset");
+
+/**
+ * @brief Exact distances between a few landmarks and every vertex, for
+ * lower bounds on the distance between any two vertices (ALT).
+ *
+ * By the triangle inequality d(v, t) >= d(L, t) - d(L, v) and
+ * d(v, t) >= d(v, L) - d(t, L) for every landmark L. Landmarks on the far
+ * side of v or t give tight bounds, so they are chosen by farthest-point
+ * selection: each new landmark is the vertex farthest from all landmarks
+ * chosen so far, and vertices other landmarks cannot reach come first.
+ *
+ * The table has a row per vertex, by original id: the distances from every
+ * landmark, then, for directed graphs, the distances to every landmark. A
+ * bound needs the rows of two vertices, two cache lines with up to 8
+ * landmarks. Distances are uint32. Longer ones are stored as kMaxDistance,
+ * which can only lower the bounds, so they stay valid. kNoDistance marks
+ * unreachable pairs, which prove vertices cannot reach the target. The arrays
+ * are shared between copies and may be borrowed from a memory-mapped file
+ * (see Load).
+ *
+ * The bounds stay valid while edges are only added or made heavier, but
+ * Matches cannot tell such changes from others, so the index must be
+ * rebuilt after any change to the edges.
+ */
+class LandmarkIndex {
+ public:
+  static constexpr std::uint32_t kNoDistance = UINT32_MAX;  ///< No path.
+  static constexpr std::uint32_t kMaxDistance = UINT32_MAX - 1;  ///< Cap.
+  static constexpr int kDefaultCount = 16;  ///< Landmarks built by default.
+
+  /**
+   * @brief Creates an empty index.
+   */
+  LandmarkIndex() = default;
+
+  /**
+   * @brief Chooses landmarks and computes their distances.
+   *
+   * Runs a full Dijkstra search from every landmark, and over the reversed
+   * graph to every landmark if the graph is directed.
+   * @param count The number of landmarks; fewer if the graph is smaller.
+   * @throw std::invalid_argument if count is not positive.
+   */
+  static LandmarkIndex Build(const s21_graph& graph,
+                             int count = kDefaultCount);
+
+  /**
+   * @brief Maps an index saved by Save.
+   *
+   * The table is read from the mapping as needed, not copied; the checksum
+   * is verified once.
+   * @throw std::logic_error if the file cannot be mapped, is not a landmark
+   * file, has a different version or byte order, fails the checksum, or has
+   * a table shape or landmarks that do not fit the graph.
+   */
+  static LandmarkIndex Load(const std::string& filename);
+
+  /**
+   * @brief Saves the index in the landmark file format.
+   *
+   * The file is written next to the target and renamed over it, so indexes
+   * mapping the old file, this one included, stay valid.
+   * @throw std::runtime_error if the file cannot be written.
+   */
+  void Save(const std::string& filename) const;
+
+  /**
+   * @brief Checks whether the arrays are borrowed from a mapped file.
+   */
+  bool IsMemoryMapped() const { return owner_ != nullptr; }
+
+  /**
+   * @brief Gets the number of vertices of the indexed graph.
+   */
+  int Size() const { return static_cast<int>(vertex_count_); }
+
+  /**
+   * @brief Gets the number of landmarks.
+   */
+  int Count() const { return static_cast<int>(landmarks_.size()); }
+
+  /**
+   * @brief Gets the landmarks by original id.
+   */
+  std::span<const int> Landmarks() const { return landmarks_; }
+
+  /**
+   * @brief Checks whether the graph was symmetric, so that distances to a
+   * landmark equal distances from it and are not stored.
+   */
+  bool IsSymmetric() const { return symmetric_; }
+
+  /**
+   * @brief Gets the memory taken by the table in bytes.
+   */
+  std::size_t MemoryBytes() const {
+    return landmarks_.size_bytes() + table_.size_bytes();
+  }
+
+  /**
+   * @brief Checks whether the index was built for a graph with the same
+   * vertices and edges, by size, edge count and fingerprint (see
+   * s21_graph::GetFingerprint).
+   */
+  bool Matches(const s21_graph& graph) const;
+
+  /**
+   * @brief Gets the distance from landmark k to vertex v (original id).
+   * @return The distance (at most kMaxDistance), kUnreached if there is no
+   * path.
+   */
+  Distance From(int k, int v) const { return Widen(Row(v)[k]); }
+
+  /**
+   * @brief Gets the distance from vertex v (original id) to landmark k.
+   * @return The distance (at most kMaxDistance), kUnreached if there is no
+   * path.
+   */
+  Distance To(int k, int v) const { return Widen(Row(v)[to_ + k]); }
+
+  /**
+   * @brief Gets a lower bound on the distance from v to finish (original
+   * ids) from every landmark.
+   * @return The bound; kUnreached if a landmark proves there is no path: L
+   * reaches v but not finish, or finish reaches L but v does not.
+   */
+  Distance LowerBound(int v, int finish) const {
+    const std::uint32_t* row_v = Row(v);
+    const std::uint32_t* row_t = Row(finish);
+    const int count = Count();
+    Distance bound = 0;
+    for (int k = 0; k < count; ++k) {
+      // d(v, t) >= d(L, t) - d(L, v)
+      std::uint32_t from_v = row_v[k];
+      std::uint32_t from_t = row_t[k];
+      if (from_v < from_t) {
+        if (from_t == kNoDistance) return kUnreached;
+        bound = std::max<Distance>(bound, from_t - from_v);
+      }
+      // d(v, t) >= d(v, L) - d(t, L)
+      std::uint32_t to_v = row_v[to_ + k];
+      std::uint32_t to_t = row_t[to_ + k];
+      if (to_t < to_v) {
+        if (to_v == kNoDistance) return kUnreached;
+        bound = std::max<Distance>(bound, to_v - to_t);
+      }
+    }
+    return bound;
+  }
+
+ private:
+  /**
+   * @brief Owned arrays an index can be built from.
+   */
+  struct Arrays {
+    std::vector<int> landmarks;       ///< Landmarks by original id.
+    std::vector<std::uint32_t> table;  ///< Row-major distances.
+  };
+
+  std::span<const int> landmarks_;        ///< Landmarks by original id.
+  std::span<const std::uint32_t> table_;  ///< Row-major distances.
+  std::size_t vertex_count_ = 0;          ///< Vertices of the graph.
+  std::size_t edge_count_ = 0;            ///< Stored edges of the graph.
+  std::uint64_t fingerprint_ = 0;         ///< Fingerprint of the graph.
+  std::size_t stride_ = 0;                ///< Distances per row.
+  std::size_t to_ = 0;  ///< Offset of the distances to landmarks in a row.
+  bool symmetric_ = false;               ///< Distances to are not stored.
+  std::shared_ptr<const Arrays> arrays_;  ///< Owned arrays, if any.
+  std::shared_ptr<const void> owner_;     ///< Keeps a mapped file alive.
+
+  /**
+   * @brief Sets the shape of the table for count landmarks.
+   */
+  void SetShape(std::size_t vertex_count, int count, bool symmetric) {
+    vertex_count_ = vertex_count;
+    symmetric_ = symmetric;
+    stride_ = symmetric ? count : 2 * static_cast<std::size_t>(count);
+    to_ = symmetric ? 0 : count;
+  }
+
+  /**
+   * @brief Gets the distances stored for vertex v.
+   */
+  const std::uint32_t* Row(int v) const {
+    return table_.data() + static_cast<std::size_t>(v) * stride_;
+  }
+
+  /**
+   * @brief Converts a stored distance to a Distance.
+   */
+  static Distance Widen(std::uint32_t distance) {
+    return distance == kNoDistance ? kUnreached : distance;
+  }
+};
+
+/**
+ * @brief The ALT potential of one query: a lower bound on the distance from
+ * a vertex to the target.
+ *
+ * Works on storage ids and looks the rows up by original id, so an index
+ * stays valid when the graph is reordered.
+ */
+class LandmarkPotential {
+ public:
+  /**
+   * @brief Prepares the bound for a query to finish (storage id).
+   */
+  LandmarkPotential(const LandmarkIndex& index, const s21_graph& graph,
+                    int finish)
+      : index_(index), graph_(graph), finish_(graph.OriginalId(finish)) {}
+
+  /**
+   * @brief Gets the lower bound for vertex v (storage id).
+   */
+  Distance operator()(int v) const {
+    return index_.LowerBound(graph_.OriginalId(v), finish_);
+  }
+
+ private:
+  const LandmarkIndex& index_;  ///< The landmark distances.
+  const s21_graph& graph_;      ///< Translates storage ids.
+  int finish_;                  ///< Target by original id.
+};
+
+}  // namespace s21_sp
@@ -0,0 +1,117 @@
+#include "graph_sp_lazy.h"
+
+#include <stdexcept>
+
+#include "graph_sp_dijkstra.h"
+
+namespace s21_sp {
+
+LazyAllPairs::LazyAllPairs(const s21_graph& graph, std::size_t budget_bytes)
+    : graph_(graph), budget_bytes_(budget_bytes) {
+  cache_.version = graph.GetVersion();
+}
+
+LazyAllPairs::RowRef LazyAllPairs::operator[](int i) const {
+  if (i < 0 || i >= graph_.Size()) {
+    throw std::out_of_range("Vertex is out of range!");
+  }
+  std::unique_lock lock(cache_.mutex);
+  CheckVersion();
+  if (auto found = cache_.rows.find(i); found != cache_.rows.end()) {
+    Entry& entry = found->second;
+    cache_.recent.splice(cache_.recent.begin(), cache_.recent,
+                         entry.position);
+    return RowRef(entry.row);
+  }
+  if (auto found = cache_.pending.find(i); found != cache_.pending.end()) {
+    std::shared_future<Row> result = found->second;
+    lock.unlock();
+    return RowRef(result.get());  // rethrows what the search threw
+  }
+
+  // the first reader computes the row, later ones wait for it above
+  std::promise<Row> promise;
+  const std::uint64_t version = cache_.version;
+  cache_.pending[i] = promise.get_future().share();
+  ++cache_.computed;
+  lock.unlock();
+  Row row;
+  try {
+    row = Compute(i);
+  } catch (...) {
+    lock.lock();
+    if (cache_.version == version) cache_.pending.erase(i);
+    lock.unlock();
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+  lock.lock();
+  // a row of an older graph is handed to its readers but not kept
+  if (cache_.version == version) {
+    cache_.pending.erase(i);
+    Insert(i, row);
+  }
+  lock.unlock();
+  promise.set_value(row);
+  return RowRef(std::move(row));
+}
+
+std::size_t LazyAllPairs::CachedBytes() const {
+  std::lock_guard lock(cache_.mutex);
+  return cache_.bytes;
+}
+
+std::size_t LazyAllPairs::CachedRows() const {
+  std::lock_guard lock(cache_.mutex);
+  return cache_.rows.size();
+}
+
+std::size_t LazyAllPairs::ComputedRows() const {
+  std::lock_guard lock(cache_.mutex);
+  return cache_.computed;
+}
+
+LazyAllPairs::Row LazyAllPairs::Compute(int i) const {
+  const int size = graph_.Size();
+  auto row = std::make_shared<std::vector<int>>(size);
+  VisitSparseView(graph_, [&](const auto& view) {
+    VisitDijkstra(view, graph_.GetMetadata().max_weight, [&](auto& engine) {
+      engine.Run(graph_.StorageId(i));
+      for (int v = 0; v < size; ++v) {
+        Distance distance = engine.DistanceTo(v);
+        if (distance == kUnreached) continue;
+        (*row)[graph_.OriginalId(v)] = NarrowDistance(distance);
+      }
+    });
+  });
+  return row;
+}
+
+void LazyAllPairs::CheckVersion() const {
+  if (cache_.version == graph_.GetVersion()) return;
+  cache_.version = graph_.GetVersion();
+  cache_.recent.clear();
+  cache_.rows.clear();
+  cache_.pending.clear();
+  cache_.bytes = 0;
+}
+
+void LazyAllPairs::Insert(int i, const Row& row) const {
+  const std::size_t bytes = RowBytes(row->size());
+  if (bytes > budget_bytes_) return;
+  while (cache_.bytes + bytes > budget_bytes_) {
+    const int oldest = cache_.recent.back();
+    cache_.bytes -= RowBytes(cache_.rows.at(oldest).row->size());
+    cache_.rows.erase(oldest);
+    cache_.recent.pop_back();
+  }
+  cache_.recent.push_front(i);
+  cache_.rows[i] = {row, cache_.recent.begin()};
+  cache_.bytes += bytes;
+}
+
+std::size_t LazyAllPairs::RowBytes(std::size_t size) {
+  return size * sizeof(int) + sizeof(std::vector<int>);
+}
+
+}  // namespace s21_sp
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../graph/graph.h"
+
+namespace s21_sp {
+
+/**
+ * @brief All-pairs shortest distances computed a row at a time, when the
+ * row is first read.
+ *
+ * lazy[i][j] is what GetShortestPathsBetweenAllVertices(graph)[i][j] would
+ * be: the distance from i to j, 0 if there is none. The first read of row i
+ * runs one Dijkstra search from i; the rows are then kept, least recently
+ * used first out, while their total size stays within a byte budget. A
+ * full matrix of 100k vertices takes 40 GB, while reading a few thousand
+ * rows of it costs a few thousand searches and the rows the budget holds.
+ *
+ * Rows can be read from several threads. A row read by several at once is
+ * computed once: the others wait for it. A RowRef keeps its row alive after
+ * the row leaves the cache. When the graph changes (see
+ * s21_graph::GetVersion), the next read drops the cached rows. The graph
+ * must outlive the handle and must not change during a read.
+ */
+class LazyAllPairs {
+ public:
+  /**
+   * @brief A read-only row of distances, indexed like std::vector<int>.
+   */
+  class RowRef {
+   public:
+    int operator[](int j) const { return (*row_)[j]; }
+    std::size_t size() const { return row_->size(); }
+    std::vector<int>::const_iterator begin() const { return row_->begin(); }
+    std::vector<int>::const_iterator end() const { return row_->end(); }
+
+    /**
+     * @brief Gets the row as a vector.
+     */
+    const std::vector<int>& Vector() const { return *row_; }
+
+   private:
+    friend class LazyAllPairs;
+
+    explicit RowRef(std::shared_ptr<const std::vector<int>> row)
+        : row_(std::move(row)) {}
+
+    std::shared_ptr<const std::vector<int>> row_;  ///< Shared with the cache.
+  };
+
+  /**
+   * @brief Walks the rows in order; dereferencing reads the row as
+   * operator[] does.
+   */
+  class RowIterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = RowRef;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = RowRef;
+
+    RowIterator() = default;
+
+    reference operator*() const { return (*rows_)[row_]; }
+
+    RowIterator& operator++() {
+      ++row_;
+      return *this;
+    }
+    RowIterator operator++(int) {
+      RowIterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const RowIterator& other) const {
+      return row_ == other.row_;
+    }
+
+   private:
+    friend class LazyAllPairs;
+
+    RowIterator(const LazyAllPairs* rows, int row) : rows_(rows), row_(row) {}
+
+    const LazyAllPairs* rows_ = nullptr;  ///< Where the rows are read.
+    int row_ = 0;                         ///< The current row.
+  };
+
+  /**
+   * @brief Creates a handle for graph without computing anything.
+   * @param budget_bytes The most memory the cached rows may take. A row
+   * takes about 4 * V bytes; reads of rows larger than the budget work but
+   * are not cached.
+   */
+  LazyAllPairs(const s21_graph& graph, std::size_t budget_bytes);
+
+  /**
+   * @brief Gets the number of rows (and columns), as std::vector does.
+   */
+  std::size_t size() const { return graph_.Size(); }
+
+  /**
+   * @brief Gets row i, computing it if it is not cached.
+   * @throw std::out_of_range if vertex i does not exist.
+   * @throw std::overflow_error if a distance does not fit an int.
+   */
+  RowRef operator[](int i) const;
+
+  /**
+   * @brief Gets the first row, so that for (const auto& row : lazy) reads
+   * every row like the matrix does. Rows are computed as they are reached.
+   */
+  RowIterator begin() const { return RowIterator(this, 0); }
+
+  /**
+   * @brief Gets the iterator past the last row.
+   */
+  RowIterator end() const { return RowIterator(this, graph_.Size()); }
+
+  /**
+   * @brief Gets the most memory the cached rows may take.
+   */
+  std::size_t BudgetBytes() const { return budget_bytes_; }
+
+  /**
+   * @brief Gets the memory the cached rows take.
+   */
+  std::size_t CachedBytes() const;
+
+  /**
+   * @brief Gets the number of cached rows.
+   */
+  std::size_t CachedRows() const;
+
+  /**
+   * @brief Gets the number of rows computed so far, evicted ones included.
+   */
+  std::size_t ComputedRows() const;
+
+ private:
+  using Row = std::shared_ptr<const std::vector<int>>;
+
+  /**
+   * @brief A cached row and its place in the recency list.
+   */
+  struct Entry {
+    Row row;                            ///< The distances.
+    std::list<int>::iterator position;  ///< In Cache::recent.
+  };
+
+  /**
+   * @brief The mutable state behind the const reads.
+   */
+  struct Cache {
+    std::mutex mutex;                     ///< Guards the members.
+    std::uint64_t version = 0;            ///< Graph version of the rows.
+    std::list<int> recent;                ///< Cached rows, newest first.
+    std::unordered_map<int, Entry> rows;  ///< Cached rows by vertex.
+    /// Rows being computed, which readers of the same row wait for.
+    std::unordered_map<int, std::shared_future<Row>> pending;
+    std::size_t bytes = 0;     ///< Memory of the cached rows.
+    std::size_t computed = 0;  ///< Rows computed so far.
+  };
+
+  const s21_graph& graph_;          ///< The graph the rows are taken from.
+  const std::size_t budget_bytes_;  ///< Limit of Cache::bytes.
+  mutable Cache cache_;             ///< Rows read so far.
+
+  /**
+   * @brief Runs the search from vertex i.
+   */
+  Row Compute(int i) const;
+
+  /**
+   * @brief Drops the rows if the graph changed. Called with the lock held.
+   */
+  void CheckVersion() const;
+
+  /**
+   * @brief Caches row i as the newest and evicts the oldest rows until
+   * the budget holds. Called with the lock held.
+   */
+  void Insert(int i, const Row& row) const;
+
+  /**
+   * @brief Gets the memory of a row of size cells.
+   */
+  static std::size_t RowBytes(std::size_t size);
+};
+
+}  // namespace s21_sp
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace s21_sp {
+
+/**
+ * @brief Multi-source BFS: breadth-first searches from up to kBatch
+ * sources at once (MS-BFS).
+ *
+ * Every vertex keeps a mask with one bit per source: the sources that have
+ * reached it, and those that reached it in the last level. A level ORs the
+ * frontier mask of each vertex into its neighbours and keeps the bits they
+ * had not seen, so one pass over an edge advances every search that
+ * crosses it. Masks are a few words of fixed length, which the compiler
+ * turns into vector instructions; a batch walks the graph once per level
+ * instead of once per source. A level touches only the vertices on the
+ * frontier and their neighbours, so long, thin graphs such as paths and
+ * rings do not pay a pass over every vertex per level.
+ * @tparam Graph A sparse view (see VisitSparseView).
+ */
+template <typename Graph>
+class MultiSourceBfs {
+ public:
+  using Word = std::uint64_t;  ///< Unit the masks are made of.
+
+  static constexpr int kWords = 4;            ///< Words per mask.
+  static constexpr int kBatch = kWords * 64;  ///< Sources per run.
+
+  /**
+   * @brief Creates an engine for graph; the graph must outlive it.
+   */
+  explicit MultiSourceBfs(const Graph& graph)
+      : graph_(graph),
+        seen_(graph.Size()),
+        frontier_(graph.Size()),
+        next_(graph.Size()) {}
+
+  /**
+   * @brief Searches from sources[0..count-1] at once.
+   * @param count At most kBatch.
+   * @param reach Called as reach(i, v, hops) once for every vertex v that
+   * sources[i] reaches, with the fewest edges from sources[i] to v;
+   * reach(i, sources[i], 0) included.
+   */
+  template <typename Reach>
+  void Run(const int* sources, int count, Reach&& reach) {
+    std::fill(seen_.begin(), seen_.end(), Mask{});
+    frontier_list_.clear();
+    for (int i = 0; i < count; ++i) {
+      Word bit = Word{1} << (i % 64);
+      Mask& frontier = frontier_[sources[i]];
+      if (Empty(frontier)) frontier_list_.push_back(sources[i]);
+      seen_[sources[i]][i / 64] |= bit;
+      frontier[i / 64] |= bit;
+      reach(i, sources[i], 0);
+    }
+
+    // only the vertices on the lists have non-empty masks, so a level
+    // costs the edges out of the frontier rather than a pass over all of
+    // them; both mask arrays are all empty again when the run ends
+    for (int hops = 1; !frontier_list_.empty(); ++hops) {
+      next_list_.clear();
+      for (int v : frontier_list_) {
+        const Mask& frontier = frontier_[v];
+        graph_.ForEachNeighbor(v, [&](int u, auto) {
+          Mask& next = next_[u];
+          if (Empty(next)) next_list_.push_back(u);
+          for (int w = 0; w < kWords; ++w) next[w] |= frontier[w];
+        });
+      }
+      for (int v : frontier_list_) frontier_[v] = Mask{};
+
+      // drop the vertices whose sources had all been there before
+      std::size_t kept = 0;
+      for (int u : next_list_) {
+        Mask& next = next_[u];
+        Mask& seen = seen_[u];
+        for (int w = 0; w < kWords; ++w) {
+          next[w] &= ~seen[w];
+          seen[w] |= next[w];
+        }
+        if (Empty(next)) continue;
+        for (int w = 0; w < kWords; ++w) {
+          for (Word bits = next[w]; bits != 0; bits &= bits - 1) {
+            reach(w * 64 + std::countr_zero(bits), u, hops);
+          }
+        }
+        next_list_[kept++] = u;
+      }
+      next_list_.resize(kept);
+      frontier_.swap(next_);
+      frontier_list_.swap(next_list_);
+    }
+  }
+
+ private:
+  using Mask = std::array<Word, kWords>;  ///< One bit per source.
+
+  const Graph& graph_;          ///< The searched graph.
+  std::vector<Mask> seen_;      ///< Sources that reached each vertex.
+  std::vector<Mask> frontier_;  ///< Sources that reached it last level.
+  std::vector<Mask> next_;      ///< Sources reaching it this level.
+  std::vector<int> frontier_list_;  ///< Vertices with a frontier mask.
+  std::vector<int> next_list_;      ///< Vertices with a next mask.
+
+  static bool Empty(const Mask& mask) {
+    Word any = 0;
+    for (Word word : mask) any |= word;
+    return any == 0;
+  }
+};
+
+}  // namespace s21_sp
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+class s21_graph_algorithms;
+
+namespace s21_sp {
+
+/**
+ * @brief Selects what an AllPairsPaths keeps.
+ */
+enum class AllPairsStorage {
+  kDistances,  ///< Distances only, 4 bytes per pair.
+  kNextHops,   ///< Next hops only, 1, 2 or 4 bytes per pair.
+  kBoth        ///< Distances and next hops.
+};
+
+/**
+ * @brief Shortest paths between all pairs of vertices: distances, and the
+ * first step of a shortest path for every pair, from which any path is
+ * followed in O(length) without another search.
+ *
+ * Next hops are kept in the narrowest unsigned type that holds every vertex
+ * id and a "none" mark: uint8 up to 255 vertices, uint16 up to 65535,
+ * uint32 above, so a 10k-vertex graph takes 200 MB rather than 400 MB for
+ * next hops as int. Either matrix can be left out (see AllPairsStorage).
+ * Vertices are original ids. Built by
+ * s21_graph_algorithms::GetAllPairsPaths.
+ */
+class AllPairsPaths {
+ public:
+  /**
+   * @brief Walks a path one vertex at a time by following next hops.
+   */
+  class PathIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int*;
+    using reference = const int&;
+
+    PathIterator() = default;
+
+    reference operator*() const { return vertex_; }
+    pointer operator->() const { return &vertex_; }
+
+    PathIterator& operator++() {
+      vertex_ = vertex_ == target_ ? -1 : paths_->NextHop(vertex_, target_);
+      return *this;
+    }
+    PathIterator operator++(int) {
+      PathIterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const PathIterator& other) const {
+      return vertex_ == other.vertex_;
+    }
+
+   private:
+    friend class AllPairsPaths;
+
+    PathIterator(const AllPairsPaths* paths, int vertex, int target)
+        : paths_(paths), vertex_(vertex), target_(target) {}
+
+    const AllPairsPaths* paths_ = nullptr;  ///< Where the next hops are.
+    int vertex_ = -1;  ///< The current vertex, -1 past the target.
+    int target_ = -1;  ///< The last vertex of the path.
+  };
+
+  /**
+   * @brief The vertices of one path, from its start to its target.
+   */
+  struct Path {
+    PathIterator first;  ///< The start, or the end if there is no path.
+    PathIterator last;   ///< Past the target.
+
+    PathIterator begin() const { return first; }
+    PathIterator end() const { return last; }
+    bool empty() const { return first == last; }
+  };
+
+  /**
+   * @brief Creates an empty result.
+   */
+  AllPairsPaths() = default;
+
+  /**
+   * @brief Gets the number of vertices.
+   */
+  int Size() const { return size_; }
+
+  /**
+   * @brief Checks whether distances are kept.
+   */
+  bool HasDistances() const { return has_distances_; }
+
+  /**
+   * @brief Checks whether next hops are kept.
+   */
+  bool HasNextHops() const { return has_next_hops_; }
+
+  /**
+   * @brief Gets the bytes per next hop: 1, 2 or 4, 0 if they are not kept.
+   */
+  int NextHopBytes() const {
+    if (!has_next_hops_) return 0;
+    return std::visit(
+        [](const auto& hops) {
+          return static_cast<int>(sizeof(typename std::decay_t<
+                                         decltype(hops)>::value_type));
+        },
+        next_hops_);
+  }
+
+  /**
+   * @brief Gets the memory taken by the matrices in bytes.
+   */
+  std::size_t MemoryBytes() const {
+    return distances_.size() * sizeof(int) +
+           static_cast<std::size_t>(size_) * size_ * NextHopBytes();
+  }
+
+  /**
+   * @brief Gets the length of a shortest path from i to j.
+   * @return The distance, -1 if j cannot be reached from i.
+   * @throw std::logic_error if distances are not kept.
+   * @throw std::out_of_range if vertex i or j does not exist.
+   */
+  int Distance(int i, int j) const {
+    if (!has_distances_) {
+      throw std::logic_error("The distances were not kept!");
+    }
+    CheckVertices(i, j);
+    return distances_[Cell(i, j)];
+  }
+
+  /**
+   * @brief Gets the vertex after i on a shortest path from i to j.
+   * @return The vertex, -1 if i == j or j cannot be reached from i.
+   * @throw std::logic_error if next hops are not kept.
+   * @throw std::out_of_range if vertex i or j does not exist.
+   */
+  int NextHop(int i, int j) const {
+    if (!has_next_hops_) {
+      throw std::logic_error("The next hops were not kept!");
+    }
+    CheckVertices(i, j);
+    return std::visit(
+        [this, i, j](const auto& hops) {
+          using Hop = typename std::decay_t<decltype(hops)>::value_type;
+          Hop hop = hops[Cell(i, j)];
+          return hop == kNoHop<Hop> ? -1 : static_cast<int>(hop);
+        },
+        next_hops_);
+  }
+
+  /**
+   * @brief Gets a shortest path from i to j, i and j included.
+   *
+   * The path is followed lazily through the next hops, one step per
+   * increment; for (int v : paths.PathBetween(i, j)) visits its vertices.
+   * @return The path; empty if j cannot be reached from i, just i if
+   * i == j.
+   * @throw std::logic_error if next hops are not kept.
+   * @throw std::out_of_range if vertex i or j does not exist.
+   */
+  Path PathBetween(int i, int j) const {
+    if (!has_next_hops_) {
+      throw std::logic_error("The next hops were not kept!");
+    }
+    CheckVertices(i, j);
+    bool reachable = i == j || NextHop(i, j) != -1;
+    return {PathIterator(this, reachable ? i : -1, j),
+            PathIterator(this, -1, j)};
+  }
+
+ private:
+  friend class ::s21_graph_algorithms;
+
+  template <typename Hop>
+  static constexpr Hop kNoHop = static_cast<Hop>(-1);  ///< "None" mark.
+
+  int size_ = 0;                ///< Number of vertices.
+  std::vector<int> distances_;  ///< Row-major, -1 where there is no path.
+  std::variant<std::vector<std::uint8_t>, std::vector<std::uint16_t>,
+               std::vector<std::uint32_t>>
+      next_hops_;               ///< Row-major, kNoHop where there is none.
+  bool has_distances_ = false;  ///< Whether distances_ is filled.
+  bool has_next_hops_ = false;  ///< Whether next_hops_ is filled.
+
+  /**
+   * @brief Creates a result for size vertices with the matrices storage
+   * asks for, distances -1 and next hops kNoHop.
+   */
+  AllPairsPaths(int size, AllPairsStorage storage) : size_(size) {
+    const std::size_t cells = static_cast<std::size_t>(size) * size;
+    has_distances_ = storage != AllPairsStorage::kNextHops;
+    if (has_distances_) distances_.assign(cells, -1);
+    if (storage == AllPairsStorage::kDistances) return;
+    has_next_hops_ = true;
+    if (size <= kNoHop<std::uint8_t>) {
+      next_hops_ = std::vector<std::uint8_t>(cells, kNoHop<std::uint8_t>);
+    } else if (size <= kNoHop<std::uint16_t>) {
+      next_hops_ = std::vector<std::uint16_t>(cells, kNoHop<std::uint16_t>);
+    } else {
+      next_hops_ = std::vector<std::uint32_t>(cells, kNoHop<std::uint32_t>);
+    }
+  }
+
+  void CheckVertices(int i, int j) const {
+    if (i < 0 || i >= size_ || j < 0 || j >= size_) {
+      throw std::out_of_range("Vertex is out of range!");
+    }
+  }
+
+  std::size_t Cell(int i, int j) const {
+    return static_cast<std::size_t>(i) * size_ + j;
+  }
+};
+
+}  // namespace s21_sp
@@ -54,7 +54,7 @@ class AntColonyOptimizer {
    * provided.
    * @throw std::invalid_argument if the graph contains no cities (vertices).
    */
-  explicit AntColonyOptimizer(s21_graph& graph,
+  explicit AntColonyOptimizer(const s21_graph& graph,
                               const AcoParams& params = AcoParams())
       : graph_(graph),
         params_(params),
@@ -119,12 +119,12 @@ class AntColonyOptimizer {
   }
 
  private:
-  s21_graph& graph_;        ///< Reference to the graph.
+  const s21_graph& graph_;  ///< Reference to the graph.
   const AcoParams params_;  ///< ACO parameters.
   int num_cities_;          ///< Number of cities (vertices) in the graph.
-  std::vector<std::vector<double>>
+  s21::DenseMatrix<double>
       pheromones_;  ///< Matrix storing pheromone levels between cities.
-  std::vector<std::vector<double>>
+  s21::DenseMatrix<double>
       heuristic_info_;  ///< Matrix storing heuristic information (e.g.,
                         ///< 1/distance).
   std::mt19937 random_generator_;  ///< Random number generator for
@@ -138,30 +138,26 @@ class AntColonyOptimizer {
    * non-existent edges or self-loops.
    */
   void Initialize() {
-    pheromones_.assign(
-        num_cities_,
-        std::vector<double>(num_cities_, params_.initial_pheromone));
-    heuristic_info_.assign(num_cities_, std::vector<double>(num_cities_, 0.0));
+    pheromones_ =
+        s21::DenseMatrix<double>(num_cities_, params_.initial_pheromone);
+    heuristic_info_ = s21::DenseMatrix<double>(num_cities_, 0.0);
 
     for (int i = 0; i < num_cities_; ++i) {
+      double* pheromone = pheromones_.Row(i);
+      double* heuristic = heuristic_info_.Row(i);
+      // Handle non-existent edges or zero distance (problematic for TSP):
+      // a very small heuristic value avoids division by zero and gives low
+      // attractiveness, and there is no pheromone without a direct path
       for (int j = 0; j < num_cities_; ++j) {
-        if (i == j) {
-          pheromones_[i][j] = 0.0;  // No pheromone on self-loops
-          heuristic_info_[i][j] = 0.0;
-        } else {
-          double dist = graph_(i, j);
-          if (dist > 0 && !std::isinf(dist)) {
-            heuristic_info_[i][j] = 1.0 / dist;
-          } else {
-            // Handle non-existent edges or zero distance (problematic for TSP)
-            // Set a very small heuristic value or handle it in SelectNextCity
-            heuristic_info_[i][j] =
-                1e-9;  // Avoid division by zero, low attractiveness
-            pheromones_[i][j] =
-                0.0;  // Optionally zero pheromone if no direct path
-          }
-        }
+        heuristic[j] = 1e-9;
+        pheromone[j] = 0.0;
       }
+      graph_.ForEachNeighbor(i, [&](int j, int dist) {
+        heuristic[j] = 1.0 / dist;
+        pheromone[j] = params_.initial_pheromone;
+      });
+      pheromone[i] = 0.0;  // No pheromone on self-loops
+      heuristic[i] = 0.0;
     }
   }
 
@@ -221,8 +217,8 @@ class AntColonyOptimizer {
     for (int i = 0; i < num_cities_; ++i) {
       for (int j = i + 1; j < num_cities_;
            ++j) {  // Iterate only upper triangle for symmetric TSP
-        pheromones_[i][j] *= (1.0 - params_.evaporation_rate);
-        pheromones_[j][i] = pheromones_[i][j];
+        pheromones_(i, j) *= (1.0 - params_.evaporation_rate);
+        pheromones_(j, i) = pheromones_(i, j);
       }
     }
 
@@ -244,14 +240,14 @@ class AntColonyOptimizer {
       for (size_t i = 0; i < tour.size() - 1; ++i) {
         int city1 = tour[i];
         int city2 = tour[i + 1];
-        pheromones_[city1][city2] += pheromone_deposit;
-        pheromones_[city2][city1] = pheromones_[city1][city2];
+        pheromones_(city1, city2) += pheromone_deposit;
+        pheromones_(city2, city1) = pheromones_(city1, city2);
       }
       // Deposit on the return edge
       int last_city = tour.back();
       int first_city = tour.front();
-      pheromones_[last_city][first_city] += pheromone_deposit;
-      pheromones_[first_city][last_city] = pheromones_[last_city][first_city];
+      pheromones_(last_city, first_city) += pheromone_deposit;
+      pheromones_(first_city, last_city) = pheromones_(last_city, first_city);
     }
   }
 
@@ -309,10 +305,12 @@ class AntColonyOptimizer {
     probabilities.reserve(num_cities_);
     allowed_cities.reserve(num_cities_);
 
+    const double* pheromone = pheromones_.Row(current_city);
+    const double* heuristic = heuristic_info_.Row(current_city);
     for (int next_city = 0; next_city < num_cities_; ++next_city) {
       if (!visited[next_city]) {
-        double pheromone_level = pheromones_[current_city][next_city];
-        double heuristic_level = heuristic_info_[current_city][next_city];
+        double pheromone_level = pheromone[next_city];
+        double heuristic_level = heuristic[next_city];
 
         // Consider only reachable cities with some attractiveness
         if (pheromone_level > 1e-9 ||
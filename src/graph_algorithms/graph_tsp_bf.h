@@ -27,7 +27,7 @@ class BruteForceOptimizer {
    *              The graph should be complete and weighted for meaningful
    * results.
    */
-  explicit BruteForceOptimizer(s21_graph& graph) : graph_(graph) {}
+  explicit BruteForceOptimizer(const s21_graph& graph) : graph_(graph) {}
 
   /**
    * @brief Runs the Brute Force algorithm to find the optimal TSP tour.
@@ -89,7 +89,7 @@ class BruteForceOptimizer {
   }
 
  private:
-  s21_graph& graph_;  ///< A reference to the graph being processed.
+  const s21_graph& graph_;  ///< A reference to the graph being processed.
 
   /**
    * @brief Calculates the total distance of a given route (permutation of
@@ -27,7 +27,7 @@ class NearestNeighborSolver {
    *              The graph should be complete and weighted for meaningful
    * results.
    */
-  explicit NearestNeighborSolver(s21_graph& graph) : graph_(graph) {}
+  explicit NearestNeighborSolver(const s21_graph& graph) : graph_(graph) {}
 
   /**
    * @brief Runs the Nearest Neighbor algorithm to find a TSP tour.
@@ -92,7 +92,7 @@ class NearestNeighborSolver {
   }
 
  private:
-  s21_graph& graph_;  ///< A reference to the graph being processed.
+  const s21_graph& graph_;  ///< A reference to the graph being processed.
 
   /**
    * @brief Finds the nearest unvisited neighbor to the current city.
@@ -100,7 +100,8 @@ class NearestNeighborSolver {
    * @param current The index of the current city.
    * @param visited A boolean vector indicating which cities have already been
    * visited.
-   * @return The index of the nearest unvisited neighbor. Returns -1 if no
+   * @return The index of the nearest unvisited neighbor, the smallest one
+   * among neighbors at the same distance. Returns -1 if no
    * unvisited neighbor is found or if all reachable neighbors have been
    * visited.
    */
@@ -108,14 +109,14 @@ class NearestNeighborSolver {
     int nearest = -1;
     int min_distance = std::numeric_limits<int>::max();
 
-    for (int i = 0; i < graph_.Size(); ++i) {
-      if (!visited[i] && graph_(current, i) > 0) {
-        if (graph_(current, i) < min_distance) {
-          min_distance = graph_(current, i);
-          nearest = i;
-        }
+    graph_.ForEachNeighbor(current, [&](int i, int weight) {
+      // ties go to the smaller id, so the vertex order cannot change them
+      if (!visited[i] && (weight < min_distance ||
+                          (weight == min_distance && i < nearest))) {
+        min_distance = weight;
+        nearest = i;
       }
-    }
+    });
 
     return nearest;
   }
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @brief Gets the number of threads parallel algorithms use.
+ * @return The number of hardware threads, at least 1.
+ */
+inline unsigned WorkerCount() {
+  unsigned count = std::thread::hardware_concurrency();
+  return count > 0 ? count : 1;
+}
+
+/**
+ * @brief Calls task(i) for every i in [0, count) on up to WorkerCount()
+ * threads.
+ *
+ * Tasks are handed out one at a time, so uneven tasks balance across the
+ * workers. The calling thread is one of the workers, so a single task runs
+ * without starting any thread. If tasks throw, the remaining tasks still run
+ * and the exception of the task with the lowest index is rethrown. If a
+ * thread cannot be started, the loop runs on the threads it already has.
+ *
+ * @param count The number of tasks.
+ * @param task Callable taking the task index (std::size_t).
+ */
+template <typename Task>
+void ParallelFor(std::size_t count, Task&& task) {
+  std::atomic<std::size_t> next{0};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  std::size_t error_index = count;
+
+  auto worker = [&]() {
+    for (std::size_t i = next++; i < count; i = next++) {
+      try {
+        task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (i < error_index) {
+          error_index = i;
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::size_t threads = std::min<std::size_t>(WorkerCount(), count);
+  std::vector<std::jthread> pool;
+  for (std::size_t t = 1; t < threads; ++t) {
+    try {
+      pool.emplace_back(worker);
+    } catch (...) {
+      break;
+    }
+  }
+  worker();
+  pool.clear();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace s21